@@ -1,7 +1,11 @@
 #pragma once
 
+#include <array>
+
 #include "d3d11_include.h"
 
+#include "../dxvk/dxvk_buffer.h"
+
 namespace dxvk {
 
   /**
@@ -13,6 +17,7 @@ namespace dxvk {
   enum class D3D11CmdType {
     DrawIndirect,
     DrawIndirectIndexed,
+    UpdateBuffer,
   };
 
 
@@ -40,4 +45,23 @@ namespace dxvk {
     uint32_t            stride;
   };
 
-}
\ No newline at end of file
+
+
+  /**
+   * \brief Buffer update command data
+   * 
+   * Stores copies from the staging buffer to the
+   * same destination buffer, so that consecutive
+   * buffer updates can be merged into one copy.
+   */
+  struct D3D11CmdUpdateBufferData : public D3D11CmdData {
+    constexpr static uint32_t MaxRegions = 16;
+
+    Rc<DxvkBuffer>      dstBuffer;
+    Rc<DxvkBuffer>      srcBuffer;
+    uint32_t            count;
+
+    std::array<VkBufferCopy, MaxRegions> regions;
+  };
+
+}
@@ -50,60 +50,79 @@ namespace dxvk {
 
 
   uint64_t D3D11CommandList::AddChunk(DxvkCsChunkRef&& Chunk) {
-    m_chunks.push_back(std::move(Chunk));
-    return m_chunks.size() - 1;
+    ChunkEntry entry;
+    entry.chunk = std::move(Chunk);
+
+    m_chunks.push_back(std::move(entry));
+    return m_chunkCount++;
   }
   
   
   uint64_t D3D11CommandList::AddCommandList(
           D3D11CommandList*   pCommandList) {
-    // This will be the chunk ID of the first chunk
-    // added, for the purpose of resource tracking.
-    uint64_t baseChunkId = m_chunks.size();
-    
-    for (const auto& chunk : pCommandList->m_chunks)
-      m_chunks.push_back(chunk);
-
-    for (const auto& query : pCommandList->m_queries)
-      m_queries.push_back(query);
+    // Reference the command list as a whole rather than
+    // copying its chunks, queries and tracked resources.
+    // Command lists are immutable once they are finished.
+    ChunkEntry entry;
+    entry.commandList = pCommandList;
 
-    for (const auto& resource : pCommandList->m_resources) {
-      TrackedResource entry = resource;
-      entry.chunkId += baseChunkId;
-
-      m_resources.push_back(std::move(entry));
-    }
+    m_chunks.push_back(std::move(entry));
+    m_chunkCount += pCommandList->m_chunkCount;
 
     pCommandList->MarkSubmitted();
 
     // Return ID of the last chunk added. The command list
     // added can never be empty, so do not handle zero.
-    return m_chunks.size() - 1;
+    return m_chunkCount - 1;
   }
 
 
   void D3D11CommandList::EmitToCsThread(
     const D3D11ChunkDispatchProc& DispatchProc) {
-    for (const auto& query : m_queries)
-      query->DoDeferredEnd();
+    EndQueries();
+    EmitChunks(DispatchProc);
 
-    for (size_t i = 0, j = 0; i < m_chunks.size(); i++) {
-      // If there are resources to track for the current chunk,
-      // use a strong flush hint to dispatch GPU work quickly.
-      GpuFlushType flushType = GpuFlushType::ImplicitWeakHint;
+    MarkSubmitted();
+  }
 
-      if (j < m_resources.size() && m_resources[j].chunkId == i)
-        flushType = GpuFlushType::ImplicitStrongHint;
 
-      // Dispatch the chunk and capture its sequence number
-      uint64_t seq = DispatchProc(DxvkCsChunkRef(m_chunks[i]), flushType);
+  bool D3D11CommandList::EmitBatchToCsThread(
+    const D3D11BatchDispatchProc& DispatchProc) {
+    const D3D11Options* options = m_parent->GetOptions();
 
-      // Track resource sequence numbers for the added chunk
-      while (j < m_resources.size() && m_resources[j].chunkId == i)
-        TrackResourceSequenceNumber(m_resources[j++].ref, seq);
+    if (options->dcSingleUseMode || !options->dcBatchCommandLists)
+      return false;
+
+    // Dispatch the command list chunk by chunk on first use,
+    // most command lists are only ever submitted once.
+    if (!m_submitted.load())
+      return false;
+
+    if (m_batch == nullptr) {
+      if (!IsBatchable())
+        return false;
+
+      m_batch = new D3D11CommandListBatch();
+      AddBatchChunks(m_batch.ptr());
     }
 
-    MarkSubmitted();
+    EndQueries();
+
+    // All tracked resources use the sequence number of the chunk
+    // that contains the batch command. This is conservative.
+    const auto& resources = m_batch->getResources();
+
+    GpuFlushType flushType = !resources.empty()
+      ? GpuFlushType::ImplicitStrongHint
+      : GpuFlushType::ImplicitWeakHint;
+
+    uint64_t seq = DispatchProc(Rc<D3D11CommandListBatch>(m_batch), flushType);
+
+    for (const auto& resource : resources)
+      TrackResourceSequenceNumber(resource, seq);
+
+    m_parent->GetDXVKDevice()->addStatCtr(DxvkStatCounter::CsCmdListBatchCount, 1);
+    return true;
   }
   
   
@@ -120,6 +139,72 @@ namespace dxvk {
   }
 
 
+  void D3D11CommandList::EndQueries() {
+    for (const auto& query : m_queries)
+      query->DoDeferredEnd();
+
+    for (const auto& entry : m_chunks) {
+      if (entry.commandList != nullptr)
+        entry.commandList->EndQueries();
+    }
+  }
+
+
+  uint64_t D3D11CommandList::EmitChunks(
+    const D3D11ChunkDispatchProc& DispatchProc) {
+    uint64_t chunkId = 0;
+    uint64_t seq = 0;
+
+    size_t j = 0;
+
+    for (const auto& entry : m_chunks) {
+      if (entry.commandList == nullptr) {
+        // If there are resources to track for the current chunk,
+        // use a strong flush hint to dispatch GPU work quickly.
+        GpuFlushType flushType = GpuFlushType::ImplicitWeakHint;
+
+        if (j < m_resources.size() && m_resources[j].chunkId == chunkId)
+          flushType = GpuFlushType::ImplicitStrongHint;
+
+        // Dispatch the chunk and capture its sequence number
+        seq = DispatchProc(DxvkCsChunkRef(entry.chunk), flushType);
+        chunkId += 1;
+      } else {
+        // Nested command lists track their own resources. Any
+        // resources of this list that refer to chunks within the
+        // nested list use the sequence number of its last chunk.
+        seq = entry.commandList->EmitChunks(DispatchProc);
+        chunkId += entry.commandList->m_chunkCount;
+      }
+
+      // Track resource sequence numbers for the added chunks
+      while (j < m_resources.size() && m_resources[j].chunkId < chunkId)
+        TrackResourceSequenceNumber(m_resources[j++].ref, seq);
+    }
+
+    return seq;
+  }
+
+
+  bool D3D11CommandList::IsBatchable() const {
+    return m_chunkCount <= MaxBatchChunks;
+  }
+
+
+  void D3D11CommandList::AddBatchChunks(
+          D3D11CommandListBatch* pBatch) const {
+    for (const auto& entry : m_chunks) {
+      if (entry.commandList == nullptr)
+        pBatch->addChunk(entry.chunk);
+      else
+        entry.commandList->AddBatchChunks(pBatch);
+    }
+
+    for (const auto& resource : m_resources)
+      pBatch->addResource(resource.ref);
+  }
+
+
   void D3D11CommandList::TrackResourceSequenceNumber(
     const D3D11ResourceRef&   Resource,
           uint64_t            Seq) {
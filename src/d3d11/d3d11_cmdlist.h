@@ -6,7 +6,53 @@
 
 namespace dxvk {
   
+  class D3D11CommandListBatch;
+
   using D3D11ChunkDispatchProc = std::function<uint64_t (DxvkCsChunkRef&&, GpuFlushType)>;
+  using D3D11BatchDispatchProc = std::function<uint64_t (Rc<D3D11CommandListBatch>&&, GpuFlushType)>;
+
+  /**
+   * \brief Command list batch
+   *
+   * Flattened list of all CS chunks and tracked resources of
+   * a command list, including those of nested command lists.
+   * Used to wrap the execution of a command list that gets
+   * submitted again into a single CS command.
+   *
+   * This only saves dispatch work on the submitting thread.
+   * Nothing is cached on the CS thread, which still executes
+   * every recorded command each time the batch runs. Since
+   * command lists cannot be modified once they are finished,
+   * the batch never needs to be rebuilt.
+   */
+  class D3D11CommandListBatch : public RcObject {
+
+  public:
+
+    void addChunk(const DxvkCsChunkRef& chunk) {
+      m_chunks.push_back(chunk);
+    }
+
+    void addResource(const D3D11ResourceRef& resource) {
+      m_resources.push_back(resource);
+    }
+
+    const std::vector<D3D11ResourceRef>& getResources() const {
+      return m_resources;
+    }
+
+    void execute(DxvkContext* ctx) const {
+      for (const auto& chunk : m_chunks)
+        chunk->executeAll(ctx);
+    }
+
+  private:
+
+    std::vector<DxvkCsChunkRef>   m_chunks;
+    std::vector<D3D11ResourceRef> m_resources;
+
+  };
+
 
   class D3D11CommandList : public D3D11DeviceChild<ID3D11CommandList> {
     
@@ -36,6 +82,20 @@ namespace dxvk {
     void EmitToCsThread(
       const D3D11ChunkDispatchProc& DispatchProc);
 
+    /**
+     * \brief Dispatches the command list as a single CS command
+     *
+     * Only succeeds for command lists that are not single-use,
+     * have already been submitted before, and are small enough
+     * to not benefit from flushing in between chunks. Chunks
+     * and tracked resources are only gathered once, but all
+     * commands are still executed again on the CS thread.
+     * \param [in] DispatchProc Batch dispatch function
+     * \returns \c true if the command list was dispatched
+     */
+    bool EmitBatchToCsThread(
+      const D3D11BatchDispatchProc& DispatchProc);
+
     void TrackResourceUsage(
             ID3D11Resource*     pResource,
             D3D11_RESOURCE_DIMENSION ResourceType,
@@ -44,20 +104,51 @@ namespace dxvk {
 
   private:
 
+    /// Maximum number of chunks in a batched command list. This is a
+    /// size limit only, larger lists are dispatched chunk by chunk
+    /// so that the immediate context can flush in between.
+    constexpr static uint64_t MaxBatchChunks = 64;
+
     struct TrackedResource {
       D3D11ResourceRef  ref;
       uint64_t          chunkId;
     };
 
+    /**
+     * \brief Chunk list entry
+     *
+     * Either a single CS chunk, or a nested command list
+     * which is only flattened when submitting the list.
+     * Chunk IDs count every chunk of nested command lists.
+     */
+    struct ChunkEntry {
+      DxvkCsChunkRef                  chunk;
+      Com<D3D11CommandList, false>    commandList;
+    };
+
     UINT m_contextFlags;
     
-    std::vector<DxvkCsChunkRef>         m_chunks;
+    std::vector<ChunkEntry>             m_chunks;
     std::vector<Com<D3D11Query, false>> m_queries;
     std::vector<TrackedResource>        m_resources;
 
+    uint64_t m_chunkCount = 0;
+
+    Rc<D3D11CommandListBatch> m_batch;
+
     std::atomic<bool> m_submitted = { false };
     std::atomic<bool> m_warned    = { false };
 
+    void EndQueries();
+
+    uint64_t EmitChunks(
+      const D3D11ChunkDispatchProc& DispatchProc);
+
+    bool IsBatchable() const;
+
+    void AddBatchChunks(
+            D3D11CommandListBatch* pBatch) const;
+
     void TrackResourceSequenceNumber(
       const D3D11ResourceRef&   Resource,
             uint64_t            Seq);
@@ -945,6 +945,7 @@ namespace dxvk {
   template<typename ContextType>
   void STDMETHODCALLTYPE D3D11CommonContext<ContextType>::DrawAuto() {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyState();
 
     D3D11Buffer* buffer = m_state.ia.vertexBuffers[0].buffer.ptr();
 
@@ -970,6 +971,7 @@ namespace dxvk {
           UINT            VertexCount,
           UINT            StartVertexLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyState();
 
     EmitCs([=] (DxvkContext* ctx) {
       ctx->draw(
@@ -985,6 +987,7 @@ namespace dxvk {
           UINT            StartIndexLocation,
           INT             BaseVertexLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyState();
 
     EmitCs([=] (DxvkContext* ctx) {
       ctx->drawIndexed(
@@ -1002,6 +1005,7 @@ namespace dxvk {
           UINT            StartVertexLocation,
           UINT            StartInstanceLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyState();
 
     EmitCs([=] (DxvkContext* ctx) {
       ctx->draw(
@@ -1021,6 +1025,7 @@ namespace dxvk {
           INT             BaseVertexLocation,
           UINT            StartInstanceLocation) {
     D3D10DeviceLock lock = LockContext();
+    ApplyDirtyState();
 
     EmitCs([=] (DxvkContext* ctx) {
       ctx->drawIndexed(
@@ -1043,6 +1048,8 @@ namespace dxvk {
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDrawIndexedIndirectCommand)))
       return;
 
+    ApplyDirtyState();
+
     // If possible, batch up multiple indirect draw calls of
     // the same type into one single multiDrawIndirect call
     auto cmdData = static_cast<D3D11CmdDrawIndirectData*>(m_cmdData);
@@ -1078,6 +1085,8 @@ namespace dxvk {
     if (!ValidateDrawBufferSize(pBufferForArgs, AlignedByteOffsetForArgs, sizeof(VkDrawIndirectCommand)))
       return;
 
+    ApplyDirtyState();
+
     // If possible, batch up multiple indirect draw calls of
     // the same type into one single multiDrawIndirect call
     auto cmdData = static_cast<D3D11CmdDrawIndirectData*>(m_cmdData);
@@ -2236,20 +2245,27 @@ namespace dxvk {
 
     auto blendState = static_cast<D3D11BlendState*>(pBlendState);
 
+    m_stateCalls.blend += 1;
+
     if (m_state.om.cbState    != blendState
      || m_state.om.sampleMask != SampleMask) {
       m_state.om.cbState    = blendState;
       m_state.om.sampleMask = SampleMask;
 
-      ApplyBlendState();
+      m_dirtyState.set(D3D11DirtyState::BlendState);
     }
 
     if (BlendFactor != nullptr) {
-      for (uint32_t i = 0; i < 4; i++)
-        m_state.om.blendFactor[i] = BlendFactor[i];
+      if (std::memcmp(m_state.om.blendFactor, BlendFactor, sizeof(FLOAT) * 4)) {
+        for (uint32_t i = 0; i < 4; i++)
+          m_state.om.blendFactor[i] = BlendFactor[i];
 
-      ApplyBlendFactor();
+        m_dirtyState.set(D3D11DirtyState::BlendFactor);
+      }
     }
+
+    if (unlikely(!m_parent->GetOptions()->deferRenderState))
+      ApplyDirtyState();
   }
 
 
@@ -2261,9 +2277,11 @@ namespace dxvk {
 
     auto depthStencilState = static_cast<D3D11DepthStencilState*>(pDepthStencilState);
 
+    m_stateCalls.depthStencil += 1;
+
     if (m_state.om.dsState != depthStencilState) {
       m_state.om.dsState = depthStencilState;
-      ApplyDepthStencilState();
+      m_dirtyState.set(D3D11DirtyState::DepthStencilState);
     }
 
     // The D3D11 runtime only appears to store the low 8 bits,
@@ -2272,8 +2290,11 @@ namespace dxvk {
 
     if (m_state.om.stencilRef != StencilRef) {
       m_state.om.stencilRef = StencilRef;
-      ApplyStencilRef();
+      m_dirtyState.set(D3D11DirtyState::StencilRef);
     }
+
+    if (unlikely(!m_parent->GetOptions()->deferRenderState))
+      ApplyDirtyState();
   }
 
 
@@ -2358,9 +2379,11 @@ namespace dxvk {
     auto currRasterizerState = m_state.rs.state;
     auto nextRasterizerState = static_cast<D3D11RasterizerState*>(pRasterizerState);
 
+    m_stateCalls.rasterizer += 1;
+
     if (m_state.rs.state != nextRasterizerState) {
       m_state.rs.state = nextRasterizerState;
-      ApplyRasterizerState();
+      m_dirtyState.set(D3D11DirtyState::RasterizerState);
 
       // If necessary, update the rasterizer sample count push constant
       uint32_t currSampleCount = currRasterizerState != nullptr ? currRasterizerState->Desc()->ForcedSampleCount : 0;
@@ -2377,6 +2400,9 @@ namespace dxvk {
       if (currScissorEnable != nextScissorEnable)
         ApplyViewportState();
     }
+
+    if (unlikely(!m_parent->GetOptions()->deferRenderState))
+      ApplyDirtyState();
   }
 
 
@@ -3068,7 +3094,7 @@ namespace dxvk {
 
   template<typename ContextType>
   DxvkCsChunkRef D3D11CommonContext<ContextType>::AllocCsChunk() {
-    return m_parent->AllocCsChunk(m_csFlags);
+    return m_parent->AllocCsChunk(m_csFlags, m_csChunkSize);
   }
 
 
@@ -3156,6 +3182,10 @@ namespace dxvk {
 
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::ApplyBlendState() {
+    m_shadow.cbState    = m_state.om.cbState;
+    m_shadow.sampleMask = m_state.om.sampleMask;
+    m_dirtyState.clr(D3D11DirtyState::BlendState);
+
     if (m_state.om.cbState != nullptr) {
       EmitCs([
         cBlendState = m_state.om.cbState,
@@ -3184,6 +3214,11 @@ namespace dxvk {
 
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::ApplyBlendFactor() {
+    for (uint32_t i = 0; i < 4; i++)
+      m_shadow.blendFactor[i] = m_state.om.blendFactor[i];
+
+    m_dirtyState.clr(D3D11DirtyState::BlendFactor);
+
     EmitCs([
       cBlendConstants = DxvkBlendConstants {
         m_state.om.blendFactor[0], m_state.om.blendFactor[1],
@@ -3196,6 +3231,9 @@ namespace dxvk {
 
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::ApplyDepthStencilState() {
+    m_shadow.dsState = m_state.om.dsState;
+    m_dirtyState.clr(D3D11DirtyState::DepthStencilState);
+
     if (m_state.om.dsState != nullptr) {
       EmitCs([
         cDepthStencilState = m_state.om.dsState
@@ -3215,6 +3253,9 @@ namespace dxvk {
   
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::ApplyStencilRef() {
+    m_shadow.stencilRef = m_state.om.stencilRef;
+    m_dirtyState.clr(D3D11DirtyState::StencilRef);
+
     EmitCs([
       cStencilRef = m_state.om.stencilRef
     ] (DxvkContext* ctx) {
@@ -3225,6 +3266,9 @@ namespace dxvk {
   
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::ApplyRasterizerState() {
+    m_shadow.rsState = m_state.rs.state;
+    m_dirtyState.clr(D3D11DirtyState::RasterizerState);
+
     if (m_state.rs.state != nullptr) {
       EmitCs([
         cRasterizerState = m_state.rs.state
@@ -3357,6 +3401,92 @@ namespace dxvk {
   }
 
 
+  template<typename ContextType>
+  void D3D11CommonContext<ContextType>::ApplyDirtyState() {
+    if (likely(m_dirtyState.isClear() && !m_stateCalls.any()))
+      return;
+
+    // Only emit state that actually differs from what was last
+    // applied, apps commonly change state and restore it again
+    // without any draws in between.
+    uint32_t blendApplied = 0;
+    uint32_t depthStencilApplied = 0;
+    uint32_t rasterizerApplied = 0;
+
+    if (m_dirtyState.test(D3D11DirtyState::BlendState)) {
+      if (m_shadow.cbState    != m_state.om.cbState
+       || m_shadow.sampleMask != m_state.om.sampleMask) {
+        ApplyBlendState();
+        blendApplied = 1;
+      }
+    }
+
+    if (m_dirtyState.test(D3D11DirtyState::BlendFactor)) {
+      if (std::memcmp(m_shadow.blendFactor, m_state.om.blendFactor, sizeof(FLOAT) * 4)) {
+        ApplyBlendFactor();
+        blendApplied = 1;
+      }
+    }
+
+    if (m_dirtyState.test(D3D11DirtyState::DepthStencilState)) {
+      if (m_shadow.dsState != m_state.om.dsState) {
+        ApplyDepthStencilState();
+        depthStencilApplied = 1;
+      }
+    }
+
+    if (m_dirtyState.test(D3D11DirtyState::StencilRef)) {
+      if (m_shadow.stencilRef != m_state.om.stencilRef) {
+        ApplyStencilRef();
+        depthStencilApplied = 1;
+      }
+    }
+
+    if (m_dirtyState.test(D3D11DirtyState::RasterizerState)) {
+      if (m_shadow.rsState != m_state.rs.state) {
+        ApplyRasterizerState();
+        rasterizerApplied = 1;
+      }
+    }
+
+    m_dirtyState.clrAll();
+
+    // Every state call since the last draw that did not result
+    // in a state update on the DXVK context counts as elided.
+    if (m_stateCalls.any()) {
+      CountElidedState(DxvkStatCounter::StateBlendElided,
+        m_stateCalls.blend - std::min(m_stateCalls.blend, blendApplied));
+      CountElidedState(DxvkStatCounter::StateDepthStencilElided,
+        m_stateCalls.depthStencil - std::min(m_stateCalls.depthStencil, depthStencilApplied));
+      CountElidedState(DxvkStatCounter::StateRasterizerElided,
+        m_stateCalls.rasterizer - std::min(m_stateCalls.rasterizer, rasterizerApplied));
+
+      m_stateCalls = D3D11StateCallCounts();
+    }
+  }
+
+
+  template<typename ContextType>
+  void D3D11CommonContext<ContextType>::CountElidedState(
+          DxvkStatCounter                   Counter,
+          uint32_t                          Count) {
+    m_stateStats.addCtr(Counter, Count);
+
+    // Avoid locking the device's stat counters for every
+    // single redundant state change, they are only read
+    // by the HUD a few times per second anyway.
+    if (unlikely((m_stateStatCount += Count) >= 256)) {
+      for (auto ctr : { DxvkStatCounter::StateBlendElided,
+                        DxvkStatCounter::StateDepthStencilElided,
+                        DxvkStatCounter::StateRasterizerElided })
+        m_device->addStatCtr(ctr, m_stateStats.getCtr(ctr));
+
+      m_stateStats.reset();
+      m_stateStatCount = 0;
+    }
+  }
+
+
   template<typename ContextType>
   template<DxbcProgramType ShaderStage>
   void D3D11CommonContext<ContextType>::BindShader(
@@ -4344,6 +4474,10 @@ namespace dxvk {
 
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::ResetCommandListState() {
+    // The DXVK context will use default render state
+    m_shadow.reset();
+    m_dirtyState.clrAll();
+
     EmitCs([
       cUsedBindings = GetMaxUsedBindings()
     ] (DxvkContext* ctx) {
@@ -5067,6 +5201,31 @@ namespace dxvk {
   }
 
 
+  template<typename ContextType>
+  bool D3D11CommonContext<ContextType>::CanMergeBufferUpdate(
+    const D3D11CmdUpdateBufferData*         pCmdData,
+    const Rc<DxvkBuffer>&                   DstBuffer,
+    const Rc<DxvkBuffer>&                   SrcBuffer,
+    const VkBufferCopy&                     Region) {
+    if (pCmdData->count >= D3D11CmdUpdateBufferData::MaxRegions
+     || pCmdData->dstBuffer != DstBuffer
+     || pCmdData->srcBuffer != SrcBuffer)
+      return false;
+
+    // Regions of a single copy are not ordered, so
+    // the destination ranges must not overlap
+    for (uint32_t i = 0; i < pCmdData->count; i++) {
+      const VkBufferCopy& other = pCmdData->regions[i];
+
+      if (Region.dstOffset < other.dstOffset + other.size
+       && other.dstOffset < Region.dstOffset + Region.size)
+        return false;
+    }
+
+    return true;
+  }
+
+
   template<typename ContextType>
   void D3D11CommonContext<ContextType>::UpdateBuffer(
           D3D11Buffer*                      pDstBuffer,
@@ -5097,17 +5256,31 @@ namespace dxvk {
       DxvkBufferSlice stagingSlice = AllocStagingBuffer(Length);
       std::memcpy(stagingSlice.mapPtr(0), pSrcData, Length);
 
-      EmitCs([
-        cStagingSlice = std::move(stagingSlice),
-        cBufferSlice  = std::move(bufferSlice)
-      ] (DxvkContext* ctx) {
-        ctx->copyBuffer(
-          cBufferSlice.buffer(),
-          cBufferSlice.offset(),
-          cStagingSlice.buffer(),
-          cStagingSlice.offset(),
-          cBufferSlice.length());
-      });
+      VkBufferCopy region;
+      region.srcOffset = stagingSlice.offset();
+      region.dstOffset = bufferSlice.offset();
+      region.size      = bufferSlice.length();
+
+      // If possible, merge consecutive updates to the
+      // same buffer into one single multi-region copy
+      auto cmdData = static_cast<D3D11CmdUpdateBufferData*>(m_cmdData);
+
+      if (cmdData && cmdData->type == D3D11CmdType::UpdateBuffer
+       && CanMergeBufferUpdate(cmdData, bufferSlice.buffer(), stagingSlice.buffer(), region)) {
+        cmdData->regions[cmdData->count++] = region;
+      } else {
+        cmdData = EmitCsCmd<D3D11CmdUpdateBufferData>(
+          [] (DxvkContext* ctx, const D3D11CmdUpdateBufferData* data) {
+            ctx->copyBufferRegions(data->dstBuffer, data->srcBuffer,
+              data->count, data->regions.data());
+          });
+
+        cmdData->type       = D3D11CmdType::UpdateBuffer;
+        cmdData->dstBuffer  = bufferSlice.buffer();
+        cmdData->srcBuffer  = stagingSlice.buffer();
+        cmdData->count      = 1;
+        cmdData->regions[0] = region;
+      }
     }
 
     if (pDstBuffer->HasSequenceNumber())
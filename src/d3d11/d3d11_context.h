@@ -772,9 +772,17 @@ namespace dxvk {
     Rc<DxvkDataBuffer>          m_updateBuffer;
 
     DxvkCsChunkFlags            m_csFlags;
+    size_t                      m_csChunkSize = DxvkCsChunk::MinBlockSize;
     DxvkCsChunkRef              m_csChunk;
     D3D11CmdData*               m_cmdData;
 
+    D3D11ContextStateShadow     m_shadow;
+    D3D11DirtyStateFlags        m_dirtyState;
+
+    D3D11StateCallCounts        m_stateCalls;
+    DxvkStatCounters            m_stateStats;
+    uint32_t                    m_stateStatCount = 0;
+
     DxvkCsChunkRef AllocCsChunk();
     
     DxvkDataSlice AllocUpdateBufferSlice(size_t Size);
@@ -800,6 +808,12 @@ namespace dxvk {
 
     void ApplyViewportState();
 
+    void ApplyDirtyState();
+
+    void CountElidedState(
+            DxvkStatCounter                   Counter,
+            uint32_t                          Count);
+
     template<DxbcProgramType ShaderStage>
     void BindShader(
       const D3D11CommonShader*                pShaderModule);
@@ -1016,6 +1030,12 @@ namespace dxvk {
     void TrackResourceSequenceNumber(
             ID3D11Resource*                   pResource);
 
+    static bool CanMergeBufferUpdate(
+      const D3D11CmdUpdateBufferData*         pCmdData,
+      const Rc<DxvkBuffer>&                   DstBuffer,
+      const Rc<DxvkBuffer>&                   SrcBuffer,
+      const VkBufferCopy&                     Region);
+
     void UpdateBuffer(
             D3D11Buffer*                      pDstBuffer,
             UINT                              Offset,
@@ -189,7 +189,7 @@ namespace dxvk {
     else
       ResetContextState();
     
-    m_mappedResources.clear();
+    ClearMapEntries();
     ResetStagingBuffer();
     return S_OK;
   }
@@ -421,32 +421,100 @@ namespace dxvk {
   D3D11DeferredContextMapEntry* D3D11DeferredContext::FindMapEntry(
           ID3D11Resource*               pResource,
           UINT                          Subresource) {
-    // Recently mapped resources as well as entries with
-    // up-to-date map infos will be located at the end
-    // of the resource array, so scan in reverse order.
-    size_t size = m_mappedResources.size();
-
-    for (size_t i = 1; i <= size; i++) {
-      auto entry = &m_mappedResources[size - i];
+    if (m_mappedResources.empty())
+      return nullptr;
 
-      if (entry->Resource.Get()            == pResource
-       && entry->Resource.GetSubresource() == Subresource)
-        return entry;
-    }
+    uint32_t index = *FindMapSlot(pResource, Subresource);
 
-    return nullptr;
+    return index
+      ? &m_mappedResources[index - 1]
+      : nullptr;
   }
 
+
   void D3D11DeferredContext::AddMapEntry(
           ID3D11Resource*               pResource,
           UINT                          Subresource,
           D3D11_RESOURCE_DIMENSION      ResourceType,
     const D3D11_MAPPED_SUBRESOURCE&     MapInfo) {
+    // Keep the load factor below one half
+    if (2 * (m_mappedResources.size() + 1) > m_mappedResourceIndex.size())
+      GrowMapIndex();
+
+    uint32_t* slot = FindMapSlot(pResource, Subresource);
+
+    // Remapping a subresource only changes the map info,
+    // the resource itself is already being kept alive.
+    if (*slot) {
+      m_mappedResources[*slot - 1].MapInfo = MapInfo;
+      return;
+    }
+
     m_mappedResources.emplace_back(pResource,
       Subresource, ResourceType, MapInfo);
+
+    *slot = uint32_t(m_mappedResources.size());
+  }
+
+
+  void D3D11DeferredContext::ClearMapEntries() {
+    if (m_mappedResources.empty())
+      return;
+
+    std::fill(m_mappedResourceIndex.begin(), m_mappedResourceIndex.end(), 0u);
+    m_mappedResources.clear();
+  }
+
+
+  uint32_t* D3D11DeferredContext::FindMapSlot(
+          ID3D11Resource*               pResource,
+          UINT                          Subresource) {
+    size_t mask = m_mappedResourceIndex.size() - 1;
+    size_t slot = HashMapEntry(pResource, Subresource) & mask;
+
+    while (true) {
+      uint32_t& index = m_mappedResourceIndex[slot];
+
+      if (!index)
+        return &index;
+
+      const auto& entry = m_mappedResources[index - 1];
+
+      if (entry.Resource.Get()            == pResource
+       && entry.Resource.GetSubresource() == Subresource)
+        return &index;
+
+      slot = (slot + 1) & mask;
+    }
   }
 
 
+  void D3D11DeferredContext::GrowMapIndex() {
+    size_t size = std::max<size_t>(m_mappedResourceIndex.size() * 2, 64);
+
+    m_mappedResourceIndex.clear();
+    m_mappedResourceIndex.resize(size, 0u);
+
+    for (uint32_t i = 0; i < m_mappedResources.size(); i++) {
+      const auto& entry = m_mappedResources[i];
+
+      *FindMapSlot(entry.Resource.Get(),
+        entry.Resource.GetSubresource()) = i + 1;
+    }
+  }
+
+
+  size_t D3D11DeferredContext::HashMapEntry(
+          ID3D11Resource*               pResource,
+          UINT                          Subresource) {
+    // Resources are heap-allocated, so the low bits of
+    // the pointer carry little information on their own
+    uint64_t hash = reinterpret_cast<uintptr_t>(pResource) >> 4;
+    hash ^= uint64_t(Subresource) << 32;
+    hash *= 0x9e3779b97f4a7c15ull;
+    return size_t(hash >> 32);
+  }
+
   DxvkCsChunkFlags D3D11DeferredContext::GetCsChunkFlags(
           D3D11Device*                  pDevice) {
     return pDevice->GetOptions()->dcSingleUseMode
@@ -88,10 +88,12 @@ namespace dxvk {
     // Command list that we're recording
     Com<D3D11CommandList> m_commandList;
     
-    // Info about currently mapped (sub)resources. Using a vector
-    // here is reasonable since there will usually only be a small
-    // number of mapped resources per command list.
+    // Info about currently mapped (sub)resources, with at most one
+    // entry per subresource. Entries are looked up through an open
+    // addressing hash table that stores entry indices plus one, so
+    // that zero can be used to mark empty slots.
     std::vector<D3D11DeferredContextMapEntry> m_mappedResources;
+    std::vector<uint32_t>                     m_mappedResourceIndex;
     
     // Begun and ended queries, will also be stored in command list
     std::vector<Com<D3D11Query, false>> m_queriesBegun;
@@ -140,6 +142,18 @@ namespace dxvk {
             D3D11_RESOURCE_DIMENSION      ResourceType,
       const D3D11_MAPPED_SUBRESOURCE&     MapInfo);
 
+    void ClearMapEntries();
+
+    uint32_t* FindMapSlot(
+            ID3D11Resource*               pResource,
+            UINT                          Subresource);
+
+    void GrowMapIndex();
+
+    static size_t HashMapEntry(
+            ID3D11Resource*               pResource,
+            UINT                          Subresource);
+
     static DxvkCsChunkFlags GetCsChunkFlags(
             D3D11Device*                  pDevice);
     
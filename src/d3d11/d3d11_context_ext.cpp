@@ -47,6 +47,7 @@ namespace dxvk {
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
     m_ctx->SetDrawBuffers(pBufferForArgs, nullptr);
+    m_ctx->ApplyDirtyState();
     
     m_ctx->EmitCs([
       cCount  = DrawCount,
@@ -66,6 +67,7 @@ namespace dxvk {
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
     m_ctx->SetDrawBuffers(pBufferForArgs, nullptr);
+    m_ctx->ApplyDirtyState();
     
     m_ctx->EmitCs([
       cCount  = DrawCount,
@@ -87,6 +89,7 @@ namespace dxvk {
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
     m_ctx->SetDrawBuffers(pBufferForArgs, pBufferForCount);
+    m_ctx->ApplyDirtyState();
 
     m_ctx->EmitCs([
       cMaxCount  = MaxDrawCount,
@@ -109,6 +112,7 @@ namespace dxvk {
           UINT                    ByteStrideForArgs) {
     D3D10DeviceLock lock = m_ctx->LockContext();
     m_ctx->SetDrawBuffers(pBufferForArgs, pBufferForCount);
+    m_ctx->ApplyDirtyState();
 
     m_ctx->EmitCs([
       cMaxCount  = MaxDrawCount,
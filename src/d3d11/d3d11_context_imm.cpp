@@ -158,6 +158,7 @@ namespace dxvk {
 
 
   void STDMETHODCALLTYPE D3D11ImmediateContext::Flush() {
+    DXVK_PROFILE_ZONE("api", "ID3D11DeviceContext::Flush");
     D3D10DeviceLock lock = LockContext();
 
     ExecuteFlush(GpuFlushType::ExplicitFlush, nullptr, true);
@@ -219,6 +220,7 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11ImmediateContext::ExecuteCommandList(
           ID3D11CommandList*  pCommandList,
           BOOL                RestoreContextState) {
+    DXVK_PROFILE_ZONE("api", "ID3D11DeviceContext::ExecuteCommandList");
     D3D10DeviceLock lock = LockContext();
 
     auto commandList = static_cast<D3D11CommandList*>(pCommandList);
@@ -237,20 +239,37 @@ namespace dxvk {
     // number of pending draw calls is high enough.
     ConsiderFlush(GpuFlushType::ImplicitWeakHint);
 
-    // Dispatch command list to the CS thread
-    commandList->EmitToCsThread([this] (DxvkCsChunkRef&& chunk, GpuFlushType flushType) {
-      EmitCsChunk(std::move(chunk));
+    // Wrap command lists that were submitted before into a single
+    // CS command, otherwise dispatch the list chunk by chunk
+    bool batched = commandList->EmitBatchToCsThread([this] (Rc<D3D11CommandListBatch>&& batch, GpuFlushType flushType) {
+      EmitCs([
+        cBatch = std::move(batch)
+      ] (DxvkContext* ctx) {
+        cBatch->execute(ctx);
+      });
 
-      // Return the sequence number from before the flush since
-      // that is actually going to be needed for resource tracking
-      uint64_t csSeqNum = m_csSeqNum;
+      FlushCsChunk();
 
-      // Consider a flush after every chunk in case the app
-      // submits a very large command list or the GPU is idle
+      uint64_t csSeqNum = m_csSeqNum;
       ConsiderFlush(flushType);
       return csSeqNum;
     });
 
+    if (!batched) {
+      commandList->EmitToCsThread([this] (DxvkCsChunkRef&& chunk, GpuFlushType flushType) {
+        EmitCsChunk(std::move(chunk));
+
+        // Return the sequence number from before the flush since
+        // that is actually going to be needed for resource tracking
+        uint64_t csSeqNum = m_csSeqNum;
+
+        // Consider a flush after every chunk in case the app
+        // submits a very large command list or the GPU is idle
+        ConsiderFlush(flushType);
+        return csSeqNum;
+      });
+    }
+
     // Restore the immediate context's state
     if (RestoreContextState)
       RestoreCommandListState();
@@ -275,6 +294,7 @@ namespace dxvk {
           D3D11_MAP                   MapType,
           UINT                        MapFlags,
           D3D11_MAPPED_SUBRESOURCE*   pMappedResource) {
+    DXVK_PROFILE_ZONE("api", "ID3D11DeviceContext::Map");
     D3D10DeviceLock lock = LockContext();
 
     if (unlikely(!pResource))
@@ -892,6 +912,9 @@ namespace dxvk {
   
   void D3D11ImmediateContext::EmitCsChunk(DxvkCsChunkRef&& chunk) {
     m_csSeqNum = m_csThread.dispatchChunk(std::move(chunk));
+
+    // Adapt size of subsequent chunks to the CS thread load
+    m_csChunkSize = m_csThread.preferredChunkSize();
   }
 
 
@@ -327,6 +327,71 @@ namespace dxvk {
     D3D11SamplerBindings samplers;
   };
 
+  /**
+   * \brief Lazily applied render state
+   *
+   * Render state that is only applied to
+   * the DXVK context before the next draw.
+   */
+  enum class D3D11DirtyState : uint32_t {
+    BlendState,
+    BlendFactor,
+    DepthStencilState,
+    StencilRef,
+    RasterizerState,
+  };
+
+  using D3D11DirtyStateFlags = Flags<D3D11DirtyState>;
+
+  /**
+   * \brief Render state applied to the DXVK context
+   *
+   * Stores the render state values that were last emitted
+   * to the CS thread. Dirty render state is only applied
+   * if it differs from these values, so that state which
+   * the app changes and then restores before the next draw
+   * does not generate any CS commands.
+   */
+  struct D3D11ContextStateShadow {
+    D3D11BlendState*        cbState = nullptr;
+    D3D11DepthStencilState* dsState = nullptr;
+    D3D11RasterizerState*   rsState = nullptr;
+
+    FLOAT blendFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    UINT  sampleMask     = D3D11_DEFAULT_SAMPLE_MASK;
+    UINT  stencilRef     = D3D11_DEFAULT_STENCIL_REFERENCE;
+
+    void reset() {
+      cbState = nullptr;
+      dsState = nullptr;
+      rsState = nullptr;
+
+      for (uint32_t i = 0; i < 4; i++)
+        blendFactor[i] = 1.0f;
+
+      sampleMask = D3D11_DEFAULT_SAMPLE_MASK;
+      stencilRef = D3D11_DEFAULT_STENCIL_REFERENCE;
+    }
+  };
+
+  /**
+   * \brief Render state calls since the last draw
+   *
+   * Number of calls to set blend, depth-stencil and
+   * rasterizer state since state was last applied.
+   * Used to count redundant state changes.
+   */
+  struct D3D11StateCallCounts {
+    uint32_t blend        = 0;
+    uint32_t depthStencil = 0;
+    uint32_t rasterizer   = 0;
+
+    bool any() const {
+      return (blend | depthStencil | rasterizer) != 0;
+    }
+  };
+
   /**
    * \brief Maximum used binding numbers in a shader stage
    */
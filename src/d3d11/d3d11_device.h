@@ -409,8 +409,8 @@ namespace dxvk {
             DXGI_FORMAT           Format,
             DXGI_VK_FORMAT_MODE   Mode) const;
     
-    DxvkCsChunkRef AllocCsChunk(DxvkCsChunkFlags flags) {
-      DxvkCsChunk* chunk = m_csChunkPool.allocChunk(flags);
+    DxvkCsChunkRef AllocCsChunk(DxvkCsChunkFlags flags, size_t blockSize) {
+      DxvkCsChunk* chunk = m_csChunkPool.allocChunk(flags, blockSize);
       return DxvkCsChunkRef(chunk, &m_csChunkPool);
     }
     
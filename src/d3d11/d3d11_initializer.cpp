@@ -8,10 +8,8 @@ namespace dxvk {
   D3D11Initializer::D3D11Initializer(
           D3D11Device*                pParent)
   : m_parent(pParent),
-    m_device(pParent->GetDXVKDevice()),
-    m_context(m_device->createContext(DxvkContextType::Supplementary)) {
-    m_context->beginRecording(
-      m_device->createCommandList());
+    m_device(pParent->GetDXVKDevice()) {
+    m_maxContexts = std::clamp(dxvk::thread::hardware_concurrency() / 2u, 1u, MaxContexts);
   }
 
   
@@ -21,10 +19,14 @@ namespace dxvk {
 
 
   void D3D11Initializer::Flush() {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    uint32_t count = m_contextCount.load(std::memory_order_acquire);
 
-    if (m_transferCommands != 0)
-      FlushInternal();
+    for (uint32_t i = 0; i < count; i++) {
+      std::lock_guard<dxvk::mutex> lock(m_contexts[i].mutex);
+
+      if (m_contexts[i].transferCommands != 0)
+        FlushInternal(&m_contexts[i]);
+    }
   }
 
   void D3D11Initializer::InitBuffer(
@@ -43,14 +45,21 @@ namespace dxvk {
   void D3D11Initializer::InitTexture(
           D3D11CommonTexture*         pTexture,
     const D3D11_SUBRESOURCE_DATA*     pInitialData) {
+    auto t0 = dxvk::high_resolution_clock::now();
+
     if (pTexture->Desc()->MiscFlags & D3D11_RESOURCE_MISC_TILED)
       InitTiledTexture(pTexture);
     else if (pTexture->GetMapMode() == D3D11_COMMON_TEXTURE_MAP_MODE_DIRECT)
       InitHostVisibleTexture(pTexture, pInitialData);
-    else
+    else if (!InitHostCopyTexture(pTexture, pInitialData))
       InitDeviceLocalTexture(pTexture, pInitialData);
 
     SyncKeyedMutex(pTexture->GetInterface());
+
+    auto t1 = dxvk::high_resolution_clock::now();
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0);
+
+    m_device->addStatCtr(DxvkStatCounter::InitTextureTicks, us.count());
   }
 
 
@@ -63,41 +72,45 @@ namespace dxvk {
 
     auto counterSlice = counterView->slice();
 
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
-    m_transferCommands += 1;
+    D3D11InitContext* ctx = LockContext();
+    std::lock_guard<dxvk::mutex> lock(ctx->mutex, std::adopt_lock);
+    ctx->transferCommands += 1;
 
     const uint32_t zero = 0;
-    m_context->updateBuffer(
+    ctx->context->updateBuffer(
       counterSlice.buffer(),
       counterSlice.offset(),
       sizeof(zero), &zero);
 
-    FlushImplicit();
+    FlushImplicit(ctx);
   }
 
 
   void D3D11Initializer::InitDeviceLocalBuffer(
           D3D11Buffer*                pBuffer,
     const D3D11_SUBRESOURCE_DATA*     pInitialData) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    D3D11InitContext* ctx = LockContext();
+    std::lock_guard<dxvk::mutex> lock(ctx->mutex, std::adopt_lock);
 
     DxvkBufferSlice bufferSlice = pBuffer->GetBufferSlice();
 
     if (pInitialData != nullptr && pInitialData->pSysMem != nullptr) {
-      m_transferMemory   += bufferSlice.length();
-      m_transferCommands += 1;
+      ctx->transferMemory   += bufferSlice.length();
+      ctx->transferCommands += 1;
+
+      m_device->addStatCtr(DxvkStatCounter::InitUploadBytes, bufferSlice.length());
       
-      m_context->uploadBuffer(
+      ctx->context->uploadBuffer(
         bufferSlice.buffer(),
         pInitialData->pSysMem);
     } else {
-      m_transferCommands += 1;
+      ctx->transferCommands += 1;
 
-      m_context->initBuffer(
+      ctx->context->initBuffer(
         bufferSlice.buffer());
     }
 
-    FlushImplicit();
+    FlushImplicit(ctx);
   }
 
 
@@ -125,7 +138,8 @@ namespace dxvk {
   void D3D11Initializer::InitDeviceLocalTexture(
           D3D11CommonTexture*         pTexture,
     const D3D11_SUBRESOURCE_DATA*     pInitialData) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    D3D11InitContext* ctx = LockContext();
+    std::lock_guard<dxvk::mutex> lock(ctx->mutex, std::adopt_lock);
     
     Rc<DxvkImage> image = pTexture->GetImage();
 
@@ -148,8 +162,12 @@ namespace dxvk {
           VkExtent3D mipLevelExtent = pTexture->MipLevelExtent(level);
 
           if (mapMode != D3D11_COMMON_TEXTURE_MAP_MODE_STAGING) {
-            m_transferCommands += 1;
-            m_transferMemory   += pTexture->GetSubresourceLayout(formatInfo->aspectMask, id).Size;
+            VkDeviceSize dataSize = pTexture->GetSubresourceLayout(formatInfo->aspectMask, id).Size;
+
+            ctx->transferCommands += 1;
+            ctx->transferMemory   += dataSize;
+
+            m_device->addStatCtr(DxvkStatCounter::InitUploadBytes, dataSize);
             
             VkImageSubresourceLayers subresourceLayers;
             subresourceLayers.aspectMask     = formatInfo->aspectMask;
@@ -158,13 +176,13 @@ namespace dxvk {
             subresourceLayers.layerCount     = 1;
             
             if (formatInfo->aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
-              m_context->uploadImage(
+              ctx->context->uploadImage(
                 image, subresourceLayers,
                 pInitialData[id].pSysMem,
                 pInitialData[id].SysMemPitch,
                 pInitialData[id].SysMemSlicePitch);
             } else {
-              m_context->updateDepthStencilImage(
+              ctx->context->updateDepthStencilImage(
                 image, subresourceLayers,
                 VkOffset2D { mipLevelOffset.x,     mipLevelOffset.y      },
                 VkExtent2D { mipLevelExtent.width, mipLevelExtent.height },
@@ -184,7 +202,7 @@ namespace dxvk {
       }
     } else {
       if (mapMode != D3D11_COMMON_TEXTURE_MAP_MODE_STAGING) {
-        m_transferCommands += 1;
+        ctx->transferCommands += 1;
         
         // While the Microsoft docs state that resource contents are
         // undefined if no initial data is provided, some applications
@@ -196,7 +214,7 @@ namespace dxvk {
         subresources.baseArrayLayer = 0;
         subresources.layerCount     = desc->ArraySize;
 
-        m_context->initImage(image, subresources, VK_IMAGE_LAYOUT_UNDEFINED);
+        ctx->context->initImage(image, subresources, VK_IMAGE_LAYOUT_UNDEFINED);
       }
 
       if (mapMode != D3D11_COMMON_TEXTURE_MAP_MODE_NONE) {
@@ -207,7 +225,83 @@ namespace dxvk {
       }
     }
 
-    FlushImplicit();
+    FlushImplicit(ctx);
+  }
+
+
+  bool D3D11Initializer::InitHostCopyTexture(
+          D3D11CommonTexture*         pTexture,
+    const D3D11_SUBRESOURCE_DATA*     pInitialData) {
+    if (pInitialData == nullptr || pInitialData->pSysMem == nullptr)
+      return false;
+
+    Rc<DxvkImage> image = pTexture->GetImage();
+
+    if (image == nullptr || !(image->info().usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT))
+      return false;
+
+    // Write to the image in its default layout if possible, otherwise
+    // use the general layout and transition the image on the GPU.
+    VkImageLayout layout = image->info().layout;
+
+    if (!image->canHostCopy(layout)) {
+      layout = VK_IMAGE_LAYOUT_GENERAL;
+
+      if (!image->canHostCopy(layout))
+        return false;
+    }
+
+    // Host copies take the data layout in texels, fall back to
+    // the staging path if the pitches can't be represented.
+    auto formatInfo = image->formatInfo();
+    bool is3D = image->info().type == VK_IMAGE_TYPE_3D;
+
+    for (uint32_t i = 0; i < pTexture->CountSubresources(); i++) {
+      UINT rowPitch = pInitialData[i].SysMemPitch;
+      UINT slicePitch = is3D ? pInitialData[i].SysMemSlicePitch : 0u;
+
+      if ((rowPitch % formatInfo->elementSize)
+       || (rowPitch && slicePitch % rowPitch))
+        return false;
+    }
+
+    VkImageSubresourceRange subresources = image->getAvailableSubresources();
+    image->transitionLayoutOnHost(subresources, VK_IMAGE_LAYOUT_UNDEFINED, layout);
+
+    VkDeviceSize dataSize = 0;
+
+    for (uint32_t layer = 0; layer < image->info().numLayers; layer++) {
+      for (uint32_t level = 0; level < image->info().mipLevels; level++) {
+        const D3D11_SUBRESOURCE_DATA& data = pInitialData[D3D11CalcSubresource(level, layer, image->info().mipLevels)];
+
+        VkImageSubresourceLayers subresource;
+        subresource.aspectMask     = formatInfo->aspectMask;
+        subresource.mipLevel       = level;
+        subresource.baseArrayLayer = layer;
+        subresource.layerCount     = 1;
+
+        image->copyMemoryToImage(subresource,
+          VkOffset3D { 0, 0, 0 }, image->mipLevelExtent(level), layout,
+          data.pSysMem, data.SysMemPitch, is3D ? data.SysMemSlicePitch : 0u);
+
+        VkExtent3D blockCount = util::computeBlockCount(
+          image->mipLevelExtent(level), formatInfo->blockSize);
+        dataSize += util::flattenImageExtent(blockCount) * formatInfo->elementSize;
+      }
+    }
+
+    m_device->addStatCtr(DxvkStatCounter::ImageHostCopyBytes, dataSize);
+
+    if (layout != image->info().layout) {
+      D3D11InitContext* ctx = LockContext();
+      std::lock_guard<dxvk::mutex> lock(ctx->mutex, std::adopt_lock);
+      ctx->context->initImage(image, subresources, layout);
+
+      ctx->transferCommands += 1;
+      FlushImplicit(ctx);
+    }
+
+    return true;
   }
 
 
@@ -252,38 +346,80 @@ namespace dxvk {
     }
 
     // Initialize the image on the GPU
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    D3D11InitContext* ctx = LockContext();
+    std::lock_guard<dxvk::mutex> lock(ctx->mutex, std::adopt_lock);
 
     VkImageSubresourceRange subresources = image->getAvailableSubresources();
     
-    m_context->initImage(image, subresources, VK_IMAGE_LAYOUT_PREINITIALIZED);
+    ctx->context->initImage(image, subresources, VK_IMAGE_LAYOUT_PREINITIALIZED);
 
-    m_transferCommands += 1;
-    FlushImplicit();
+    ctx->transferCommands += 1;
+    FlushImplicit(ctx);
   }
 
 
   void D3D11Initializer::InitTiledTexture(
           D3D11CommonTexture*         pTexture) {
-    m_context->initSparseImage(pTexture->GetImage());
+    D3D11InitContext* ctx = LockContext();
+    std::lock_guard<dxvk::mutex> lock(ctx->mutex, std::adopt_lock);
+
+    ctx->context->initSparseImage(pTexture->GetImage());
+
+    ctx->transferCommands += 1;
+    FlushImplicit(ctx);
+  }
+
+
+  D3D11InitContext* D3D11Initializer::LockContext() {
+    D3D11InitContext* ctx = nullptr;
+
+    // Use any context that is not currently being recorded
+    // into by another thread. This is the common case.
+    uint32_t count = m_contextCount.load(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < count && !ctx; i++) {
+      if (m_contexts[i].mutex.try_lock())
+        ctx = &m_contexts[i];
+    }
+
+    // If all contexts are busy, add a new one if possible,
+    // otherwise wait for one of the existing contexts.
+    while (!ctx && count < m_maxContexts) {
+      if (m_contextCount.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel)) {
+        ctx = &m_contexts[count];
+        ctx->mutex.lock();
+      }
+    }
+
+    if (!ctx) {
+      ctx = &m_contexts[m_contextIndex.fetch_add(1) % count];
+      ctx->mutex.lock();
+    }
+
+    // Contexts are created lazily since they may never be needed
+    if (unlikely(ctx->context == nullptr)) {
+      ctx->context = m_device->createContext(DxvkContextType::Supplementary);
+      ctx->context->beginRecording(m_device->createCommandList());
+    }
 
-    m_transferCommands += 1;
-    FlushImplicit();
+    return ctx;
   }
 
 
-  void D3D11Initializer::FlushImplicit() {
-    if (m_transferCommands > MaxTransferCommands
-     || m_transferMemory   > MaxTransferMemory)
-      FlushInternal();
+  void D3D11Initializer::FlushImplicit(
+          D3D11InitContext*           pContext) {
+    if (pContext->transferCommands > MaxTransferCommands
+     || pContext->transferMemory   > MaxTransferMemory)
+      FlushInternal(pContext);
   }
 
 
-  void D3D11Initializer::FlushInternal() {
-    m_context->flushCommandList(nullptr);
+  void D3D11Initializer::FlushInternal(
+          D3D11InitContext*           pContext) {
+    pContext->context->flushCommandList(nullptr);
     
-    m_transferCommands = 0;
-    m_transferMemory   = 0;
+    pContext->transferCommands = 0;
+    pContext->transferMemory   = 0;
   }
 
 
@@ -7,17 +7,35 @@ namespace dxvk {
 
   class D3D11Device;
 
+  /**
+   * \brief Initialization context
+   *
+   * Stores a context along with the amount of work
+   * that was recorded since the last submission.
+   */
+  struct D3D11InitContext {
+    dxvk::mutex       mutex;
+    Rc<DxvkContext>   context;
+    size_t            transferCommands  = 0;
+    size_t            transferMemory    = 0;
+  };
+
   /**
    * \brief Resource initialization context
    * 
-   * Manages a context which is used for resource
+   * Manages contexts which are used for resource
    * initialization. This includes initialization
    * with application-defined data, as well as
    * zero-initialization for buffers and images.
+   *
+   * Additional contexts are created on demand if
+   * multiple threads create resources at the same
+   * time, so that uploads do not serialize.
    */
   class D3D11Initializer {
     constexpr static size_t MaxTransferMemory    = 32 * 1024 * 1024;
     constexpr static size_t MaxTransferCommands  = 512;
+    constexpr static uint32_t MaxContexts        = 4;
   public:
 
     D3D11Initializer(
@@ -40,14 +58,13 @@ namespace dxvk {
     
   private:
 
-    dxvk::mutex       m_mutex;
-
     D3D11Device*      m_parent;
     Rc<DxvkDevice>    m_device;
-    Rc<DxvkContext>   m_context;
 
-    size_t            m_transferCommands  = 0;
-    size_t            m_transferMemory    = 0;
+    uint32_t                                  m_maxContexts = 1;
+    std::atomic<uint32_t>                     m_contextCount = { 0u };
+    std::atomic<uint32_t>                     m_contextIndex = { 0u };
+    std::array<D3D11InitContext, MaxContexts> m_contexts;
 
     void InitDeviceLocalBuffer(
             D3D11Buffer*                pBuffer,
@@ -61,6 +78,10 @@ namespace dxvk {
             D3D11CommonTexture*         pTexture,
       const D3D11_SUBRESOURCE_DATA*     pInitialData);
 
+    bool InitHostCopyTexture(
+            D3D11CommonTexture*         pTexture,
+      const D3D11_SUBRESOURCE_DATA*     pInitialData);
+
     void InitHostVisibleTexture(
             D3D11CommonTexture*         pTexture,
       const D3D11_SUBRESOURCE_DATA*     pInitialData);
@@ -68,8 +89,13 @@ namespace dxvk {
     void InitTiledTexture(
             D3D11CommonTexture*         pTexture);
 
-    void FlushImplicit();
-    void FlushInternal();
+    D3D11InitContext* LockContext();
+
+    void FlushImplicit(
+            D3D11InitContext*           pContext);
+
+    void FlushInternal(
+            D3D11InitContext*           pContext);
 
     void SyncKeyedMutex(ID3D11Resource *pResource);
 
@@ -20,6 +20,14 @@ namespace dxvk {
     /// than once.
     bool dcSingleUseMode;
 
+    /// Dispatches resubmitted command lists as a single CS command
+    ///
+    /// Only has an effect if single-use mode is disabled. Dispatches
+    /// small command lists as a single command to the CS thread when
+    /// they get submitted again, rather than chunk by chunk. This
+    /// does not reduce the work done on the CS thread itself.
+    bool dcBatchCommandLists;
+
     /// Zero-initialize workgroup memory
     ///
     /// Workargound for games that don't initialize
@@ -117,6 +125,11 @@ namespace dxvk {
     /// race conditions.
     bool enableContextLock;
 
+    /// Defer blend, depth-stencil and rasterizer state changes
+    /// until the next draw, so that changes which are undone
+    /// before drawing are never emitted to the CS thread.
+    bool deferRenderState;
+
     /// Shader dump path
     std::string shaderDumpPath;
   };
@@ -254,6 +254,7 @@ namespace dxvk {
           UINT                      SyncInterval,
           UINT                      PresentFlags,
     const DXGI_PRESENT_PARAMETERS*  pPresentParameters) {
+    DXVK_PROFILE_ZONE("api", "IDXGISwapChain::Present");
     auto options = m_parent->GetOptions();
 
     if (options->syncInterval >= 0)
@@ -293,11 +294,15 @@ namespace dxvk {
       hr = E_FAIL;
     }
 
+    m_presenter->latencySleep(m_frameId);
+
     // Ensure to synchronize and release the frame latency semaphore
     // even if presentation failed with STATUS_OCCLUDED, or otherwise
     // applications using the semaphore may deadlock. This works because
     // we do not increment the frame ID in those situations.
     SyncFrameLatency();
+
+    m_presenter->beginFrame(m_frameId + 1);
     return hr;
   }
 
@@ -216,6 +216,9 @@ namespace dxvk {
     // should in no way affect the default image layout
     imageInfo.usage |= EnableMetaCopyUsage(imageInfo.format, imageInfo.tiling);
     imageInfo.usage |= EnableMetaPackUsage(imageInfo.format, m_desc.CPUAccessFlags);
+
+    // Allow initial data to be written directly by the CPU
+    imageInfo.usage |= EnableHostCopyUsage(&imageInfo);
     
     // Check if we can actually create the image
     if (!CheckImageSupport(&imageInfo, imageInfo.tiling)) {
@@ -631,6 +634,70 @@ namespace dxvk {
   }
 
   
+  VkImageUsageFlags D3D11CommonTexture::EnableHostCopyUsage(
+    const DxvkImageCreateInfo*  pImageInfo) const {
+    // Only enable host copies for read-only textures, since the
+    // host transfer usage may disable framebuffer compression
+    // on some implementations, and since the image must be idle
+    // for the copy, which is only guaranteed on creation.
+    if (m_desc.Usage != D3D11_USAGE_IMMUTABLE && m_desc.Usage != D3D11_USAGE_DEFAULT)
+      return 0;
+
+    if (m_desc.BindFlags & ~D3D11_BIND_SHADER_RESOURCE)
+      return 0;
+
+    if (m_mapMode != D3D11_COMMON_TEXTURE_MAP_MODE_NONE
+     || (m_desc.MiscFlags & D3D11_RESOURCE_MISC_TILED)
+     || (m_11on12.Resource != nullptr)
+     || (pImageInfo->shared)
+     || (pImageInfo->tiling != VK_IMAGE_TILING_OPTIMAL)
+     || (pImageInfo->sampleCount != VK_SAMPLE_COUNT_1_BIT))
+      return 0;
+
+    // Packed depth-stencil data and multi-plane formats need
+    // to be converted, so they need to use the staging path
+    auto formatInfo = lookupFormatInfo(pImageInfo->format);
+
+    if (formatInfo->aspectMask != VK_IMAGE_ASPECT_COLOR_BIT
+     && formatInfo->aspectMask != VK_IMAGE_ASPECT_DEPTH_BIT)
+      return 0;
+
+    Rc<DxvkDevice> device = m_device->GetDXVKDevice();
+
+    if (!device->canUseHostImageCopy(pImageInfo->layout)
+     && !device->canUseHostImageCopy(VK_IMAGE_LAYOUT_GENERAL))
+      return 0;
+
+    DxvkFormatFeatures support = device->getFormatFeatures(pImageInfo->format);
+
+    if (!(support.optimal & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT))
+      return 0;
+
+    DxvkImageCreateInfo imageInfo = *pImageInfo;
+    imageInfo.usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+
+    if (!CheckImageSupport(&imageInfo, imageInfo.tiling))
+      return 0;
+
+    // Skip images where the host transfer usage would make device
+    // access slower, since those are sampled a lot more often than
+    // they are uploaded to.
+    DxvkFormatQuery formatQuery = { };
+    formatQuery.format = imageInfo.format;
+    formatQuery.type = imageInfo.type;
+    formatQuery.tiling = imageInfo.tiling;
+    formatQuery.usage = imageInfo.usage;
+    formatQuery.flags = imageInfo.flags;
+
+    auto limits = device->getFormatLimits(formatQuery);
+
+    if (!limits || !limits->optimalDeviceAccess)
+      return 0;
+
+    return VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+  }
+
+
   VkMemoryPropertyFlags D3D11CommonTexture::GetMemoryFlags() const {
     VkMemoryPropertyFlags memoryFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
                                       | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
@@ -516,6 +516,9 @@ namespace dxvk {
             VkFormat              Format,
             UINT                  CpuAccess) const;
     
+    VkImageUsageFlags EnableHostCopyUsage(
+      const DxvkImageCreateInfo*  pImageInfo) const;
+    
     VkMemoryPropertyFlags GetMemoryFlags() const;
     
     D3D11_COMMON_TEXTURE_MAP_MODE DetermineMapMode(
@@ -364,6 +364,9 @@ namespace dxvk {
     // in no way affect the default image layout
     imageInfo.usage |= EnableMetaCopyUsage(imageInfo.format, imageInfo.tiling);
 
+    // Allow texture uploads to write directly to idle images
+    imageInfo.usage |= EnableHostCopyUsage(&imageInfo);
+
     // Check if we can actually create the image
     if (!CheckImageSupport(&imageInfo, imageInfo.tiling)) {
       throw DxvkError(str::format(
@@ -437,6 +440,60 @@ namespace dxvk {
   }
 
 
+  VkImageUsageFlags D3D9CommonTexture::EnableHostCopyUsage(
+    const DxvkImageCreateInfo*  pImageInfo) const {
+    // Render targets are never uploaded to from the host, and
+    // the host transfer usage may disable compression for them
+    if (m_desc.Usage & (D3DUSAGE_RENDERTARGET | D3DUSAGE_DEPTHSTENCIL | D3DUSAGE_AUTOGENMIPMAP))
+      return 0;
+
+    if (pImageInfo->shared
+     || (pImageInfo->tiling != VK_IMAGE_TILING_OPTIMAL)
+     || (pImageInfo->sampleCount != VK_SAMPLE_COUNT_1_BIT)
+     || (m_mapping.ConversionFormatInfo.FormatType != D3D9ConversionFormat_None))
+      return 0;
+
+    auto formatInfo = lookupFormatInfo(pImageInfo->format);
+
+    if (formatInfo->aspectMask != VK_IMAGE_ASPECT_COLOR_BIT
+     && formatInfo->aspectMask != VK_IMAGE_ASPECT_DEPTH_BIT)
+      return 0;
+
+    Rc<DxvkDevice> device = m_device->GetDXVKDevice();
+
+    if (!device->canUseHostImageCopy(pImageInfo->layout))
+      return 0;
+
+    DxvkFormatFeatures support = device->getFormatFeatures(pImageInfo->format);
+
+    if (!(support.optimal & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT))
+      return 0;
+
+    DxvkImageCreateInfo imageInfo = *pImageInfo;
+    imageInfo.usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+
+    if (!CheckImageSupport(&imageInfo, imageInfo.tiling))
+      return 0;
+
+    // Skip images where the host transfer usage would make device
+    // access slower, since those are sampled a lot more often than
+    // they are uploaded to.
+    DxvkFormatQuery formatQuery = { };
+    formatQuery.format = imageInfo.format;
+    formatQuery.type = imageInfo.type;
+    formatQuery.tiling = imageInfo.tiling;
+    formatQuery.usage = imageInfo.usage;
+    formatQuery.flags = imageInfo.flags;
+
+    auto limits = device->getFormatLimits(formatQuery);
+
+    if (!limits || !limits->optimalDeviceAccess)
+      return 0;
+
+    return VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+  }
+
+
   VkImageUsageFlags D3D9CommonTexture::EnableMetaCopyUsage(
           VkFormat              Format,
           VkImageTiling         Tiling) const {
@@ -548,6 +548,9 @@ namespace dxvk {
             VkFormat              Format,
             VkImageTiling         Tiling) const;
 
+    VkImageUsageFlags EnableHostCopyUsage(
+      const DxvkImageCreateInfo*  pImageInfo) const;
+
     D3D9_COMMON_TEXTURE_MAP_MODE DetermineMapMode() const;
 
     VkImageLayout OptimizeLayout(
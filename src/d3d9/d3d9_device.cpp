@@ -48,6 +48,7 @@ namespace dxvk {
     , m_dxvkDevice      ( dxvkDevice )
     , m_memoryAllocator ( )
     , m_shaderAllocator ( )
+    , m_ffModules       ( this )
     , m_shaderModules   ( new D3D9ShaderModuleSet )
     , m_stagingBuffer   ( dxvkDevice, StagingBufferSize )
     , m_d3d9Options     ( dxvkDevice, pParent->GetInstance()->config() )
@@ -73,6 +74,11 @@ namespace dxvk {
     m_initializer      = new D3D9Initializer(m_dxvkDevice);
     m_converter        = new D3D9FormatHelper(m_dxvkDevice);
 
+    m_ffModules.PrecompileCachedShaders();
+
+    if (m_d3d9Options.ffUbershader)
+      m_ffModules.CreateUbershaders();
+
     EmitCs([
       cDevice = m_dxvkDevice
     ] (DxvkContext* ctx) {
@@ -195,6 +201,9 @@ namespace dxvk {
     Flush();
     SynchronizeCsThread(DxvkCsThread::SynchronizeAll);
 
+    m_ffModules.StopWorkers();
+    m_shaderModules->StopWorkers();
+
     if (m_annotation)
       delete m_annotation;
 
@@ -2798,6 +2807,7 @@ namespace dxvk {
           IDirect3DVertexBuffer9*      pDestBuffer,
           IDirect3DVertexDeclaration9* pVertexDecl,
           DWORD                        Flags) {
+    DXVK_PROFILE_ZONE("api", "IDirect3DDevice9::ProcessVertices");
     D3D9DeviceLock lock = LockDevice();
 
     if (unlikely(pDestBuffer == nullptr))
@@ -2812,23 +2822,12 @@ namespace dxvk {
         return D3DERR_INVALIDCALL;
     }
 
-    if (!SupportsSWVP()) {
-      static bool s_errorShown = false;
-
-      if (!std::exchange(s_errorShown, true))
-        Logger::err("D3D9DeviceEx::ProcessVertices: SWVP emu unsupported (vertexPipelineStoresAndAtomics)");
-
-      return D3D_OK;
-    }
-
     if (!VertexCount)
       return D3D_OK;
 
     D3D9CommonBuffer* dst  = static_cast<D3D9VertexBuffer*>(pDestBuffer)->GetCommonBuffer();
     D3D9VertexDecl*   decl = static_cast<D3D9VertexDecl*>  (pVertexDecl);
 
-    PrepareDraw(D3DPT_FORCE_DWORD);
-
     if (decl == nullptr) {
       DWORD FVF = dst->Desc()->FVF;
 
@@ -2842,6 +2841,24 @@ namespace dxvk {
         decl = iter->second.ptr();
     }
 
+    // Small batches are faster to process on the CPU than
+    // going through the GPU and reading the results back
+    if (UseProgrammableVS() && (!SupportsSWVP() || VertexCount <= uint32_t(m_d3d9Options.swvpCpuVertexLimit))) {
+      if (ProcessVerticesCpu(SrcStartIndex, DestIndex, VertexCount, dst, decl, Flags))
+        return D3D_OK;
+    }
+
+    if (!SupportsSWVP()) {
+      static bool s_errorShown = false;
+
+      if (!std::exchange(s_errorShown, true))
+        Logger::err("D3D9DeviceEx::ProcessVertices: SWVP emu unsupported (vertexPipelineStoresAndAtomics)");
+
+      return D3D_OK;
+    }
+
+    PrepareDraw(D3DPT_FORCE_DWORD);
+
     uint32_t offset = DestIndex * decl->GetSize();
 
     auto slice = dst->GetBufferSlice<D3D9_COMMON_BUFFER_TYPE_REAL>();
@@ -2908,6 +2925,91 @@ namespace dxvk {
   }
 
 
+  bool D3D9DeviceEx::ProcessVerticesCpu(
+          UINT                    SrcStartIndex,
+          UINT                    DestIndex,
+          UINT                    VertexCount,
+          D3D9CommonBuffer*       pDst,
+          D3D9VertexDecl*         pDecl,
+          DWORD                   Flags) {
+    const D3D9SWVPCpuProgram* program = m_swvpCpuEmulator.GetProgram(m_state.vertexShader.ptr());
+
+    if (program == nullptr)
+      return false;
+
+    const auto& rs = m_state.renderStates;
+
+    D3D9SWVPCpuArgs args;
+    args.constants  = m_state.vsConsts.get();
+    args.floatCount = m_vsLayout.floatCount;
+    args.pointSize  = bit::cast<float>(rs[D3DRS_POINTSIZE]);
+    args.srcDecl    = m_state.vertexDecl.ptr();
+    args.dstDecl    = pDecl;
+    args.copyData   = !(Flags & D3DPV_DONOTCOPYDATA);
+
+    args.floatEmulation = m_d3d9Options.d3d9FloatEmulation;
+
+    // Map every stream the vertex declaration reads from. Buffers
+    // written by the GPU will be synchronized by the lock as needed.
+    uint32_t streamMask = 0;
+
+    for (const auto& element : m_state.vertexDecl->GetElements())
+      streamMask |= 1u << element.Stream;
+
+    std::array<D3D9CommonBuffer*, caps::MaxStreams> srcBuffers = { };
+
+    for (uint32_t i : bit::BitMask(streamMask)) {
+      const auto& vbo = m_state.vertexBuffers[i];
+
+      if (vbo.vertexBuffer == nullptr)
+        continue;
+
+      D3D9CommonBuffer* buffer = vbo.vertexBuffer->GetCommonBuffer();
+      void* data = nullptr;
+
+      if (FAILED(LockBuffer(buffer, 0, 0, &data, D3DLOCK_READONLY)))
+        continue;
+
+      srcBuffers[i] = buffer;
+
+      size_t offset = size_t(vbo.offset) + size_t(vbo.stride) * SrcStartIndex;
+      size_t size   = buffer->Desc()->Size;
+
+      if (offset < size) {
+        args.streams[i].data   = reinterpret_cast<const uint8_t*>(data) + offset;
+        args.streams[i].stride = vbo.stride;
+        args.streams[i].size   = uint32_t(size - offset);
+      }
+    }
+
+    uint32_t vertexSize = pDecl->GetSize();
+    uint32_t offset     = DestIndex * vertexSize;
+    uint32_t bufferSize = pDst->Desc()->Size;
+
+    if (vertexSize && offset < bufferSize)
+      args.vertexCount = std::min(VertexCount, (bufferSize - offset) / vertexSize);
+
+    if (args.vertexCount) {
+      void* data = nullptr;
+
+      if (SUCCEEDED(LockBuffer(pDst, offset, args.vertexCount * vertexSize, &data, 0))) {
+        args.dstData = reinterpret_cast<uint8_t*>(data);
+
+        m_swvpCpuEmulator.ProcessVertices(*program, args);
+
+        UnlockBuffer(pDst);
+      }
+    }
+
+    for (D3D9CommonBuffer* buffer : srcBuffers) {
+      if (buffer != nullptr)
+        UnlockBuffer(buffer);
+    }
+
+    return true;
+  }
+
+
   HRESULT STDMETHODCALLTYPE D3D9DeviceEx::CreateVertexDeclaration(
     const D3DVERTEXELEMENT9*            pVertexElements,
           IDirect3DVertexDeclaration9** ppDecl) {
@@ -4443,6 +4545,7 @@ namespace dxvk {
             D3DLOCKED_BOX*          pLockedBox,
       const D3DBOX*                 pBox,
             DWORD                   Flags) {
+    DXVK_PROFILE_ZONE("api", "IDirect3DTexture9::LockRect");
     D3D9DeviceLock lock = LockDevice();
 
     UINT Subresource = pResource->CalcSubresource(Face, MipLevel);
@@ -4841,7 +4944,18 @@ namespace dxvk {
         cOffset         = alignedDestOffset,
         cPackedDSFormat = packedDSFormat
       ] (DxvkContext* ctx) {
-        if (cDstLayers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+        // If the image is idle, we can write the data directly and
+        // skip the copy on the GPU. Since this runs on the CS thread,
+        // all prior uses of the image are already being tracked.
+        VkImageLayout layout = cDstImage->info().layout;
+
+        if (cDstImage->canHostCopy(layout) && !cDstImage->isInUse()) {
+          cDstImage->copyMemoryToImage(cDstLayers,
+            cOffset, cDstLevelExtent, layout,
+            cSrcSlice.mapPtr(0), 0, 0);
+
+          ctx->addStatCtr(DxvkStatCounter::ImageHostCopyBytes, cSrcSlice.length());
+        } else if (cDstLayers.aspectMask != (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
           ctx->copyBufferToImage(
             cDstImage,  cDstLayers,
             cOffset, cDstLevelExtent,
@@ -4927,6 +5041,7 @@ namespace dxvk {
           UINT                    SizeToLock,
           void**                  ppbData,
           DWORD                   Flags) {
+    DXVK_PROFILE_ZONE("api", "IDirect3DVertexBuffer9::Lock");
     D3D9DeviceLock lock = LockDevice();
 
     if (unlikely(ppbData == nullptr))
@@ -6624,7 +6739,7 @@ namespace dxvk {
   const D3D9CommonShader*                 pShaderModule) {
     auto shader = pShaderModule->GetShader();
 
-    if (unlikely(shader->needsLibraryCompile()))
+    if (unlikely(shader != nullptr && shader->needsLibraryCompile()))
       m_dxvkDevice->requestCompileShader(shader);
 
     EmitCs([
@@ -6999,12 +7114,13 @@ namespace dxvk {
 
       key.Data.Contents.VertexClipping = IsClipPlaneEnabled();
 
+      m_ffModules.PrecompileShaderModule(key);
+
       EmitCs([
-        this,
         cKey     = key,
        &cShaders = m_ffModules
       ](DxvkContext* ctx) {
-        auto shader = cShaders.GetShaderModule(this, cKey);
+        auto shader = cShaders.GetShaderModule(cKey);
         ctx->bindShader<VK_SHADER_STAGE_VERTEX_BIT>(shader.GetShader());
       });
     }
@@ -7173,13 +7289,38 @@ namespace dxvk {
       if (idx >= 1)
         key.Stages[idx - 1].Contents.ResultIsTemp = false;
 
+      m_ffModules.PrecompileShaderModule(key);
+
+      m_ffKeyFS = key;
+      m_ffUbershaderPS = m_d3d9Options.ffUbershader
+        && !m_ffModules.IsShaderModuleReady(key);
+
+      if (m_d3d9Options.ffUbershader)
+        m_flags.set(D3D9DeviceFlag::DirtyFFPixelData);
+
+      if (m_ffUbershaderPS) {
+        EmitCs([
+          cShader = m_ffModules.GetUbershaderFS()
+        ](DxvkContext* ctx) {
+          ctx->bindShader<VK_SHADER_STAGE_FRAGMENT_BIT>(cShader.GetShader());
+        });
+      } else {
+        EmitCs([
+          cKey     = key,
+         &cShaders = m_ffModules
+        ](DxvkContext* ctx) {
+          auto shader = cShaders.GetShaderModule(cKey);
+          ctx->bindShader<VK_SHADER_STAGE_FRAGMENT_BIT>(shader.GetShader());
+        });
+      }
+    } else if (unlikely(m_ffUbershaderPS) && m_ffModules.IsShaderModuleReady(m_ffKeyFS)) {
+      // Swap out the ubershader as soon as the specialized shader is done
+      m_ffUbershaderPS = false;
+
       EmitCs([
-        this,
-        cKey     = key,
-       &cShaders = m_ffModules
+        cShader = m_ffModules.GetShaderModule(m_ffKeyFS)
       ](DxvkContext* ctx) {
-        auto shader = cShaders.GetShaderModule(this, cKey);
-        ctx->bindShader<VK_SHADER_STAGE_FRAGMENT_BIT>(shader.GetShader());
+        ctx->bindShader<VK_SHADER_STAGE_FRAGMENT_BIT>(cShader.GetShader());
       });
     }
 
@@ -7193,6 +7334,9 @@ namespace dxvk {
 
       D3D9FixedFunctionPS* data = reinterpret_cast<D3D9FixedFunctionPS*>(mapPtr);
       DecodeD3DCOLOR((D3DCOLOR)rs[D3DRS_TEXTUREFACTOR], data->textureFactor.data);
+
+      if (m_d3d9Options.ffUbershader)
+        PackFixedFunctionUberStages(m_ffKeyFS, data);
     }
   }
 
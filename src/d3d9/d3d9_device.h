@@ -25,6 +25,7 @@
 #include "d3d9_sampler.h"
 #include "d3d9_fixed_function.h"
 #include "d3d9_swvp_emu.h"
+#include "d3d9_swvp_cpu.h"
 
 #include "d3d9_spec_constants.h"
 #include "d3d9_interop.h"
@@ -966,6 +967,10 @@ namespace dxvk {
       return &m_memoryAllocator;
     }
 
+    D3D9FFShaderStats GetFFShaderStats() const {
+      return m_ffModules.GetStats();
+    }
+
     void* MapTexture(D3D9CommonTexture* pTexture, UINT Subresource);
     void TouchMappedTexture(D3D9CommonTexture* pTexture);
     void RemoveMappedTexture(D3D9CommonTexture* pTexture);
@@ -1004,7 +1009,8 @@ namespace dxvk {
   private:
 
     DxvkCsChunkRef AllocCsChunk() {
-      DxvkCsChunk* chunk = m_csChunkPool.allocChunk(DxvkCsChunkFlag::SingleUse);
+      DxvkCsChunk* chunk = m_csChunkPool.allocChunk(
+        DxvkCsChunkFlag::SingleUse, m_csThread.preferredChunkSize());
       return DxvkCsChunkRef(chunk, &m_csChunkPool);
     }
 
@@ -1196,6 +1202,20 @@ namespace dxvk {
 
     bool UseProgrammablePS();
 
+    /**
+     * \brief Runs ProcessVertices on the CPU
+     *
+     * \returns \c false if the current vertex
+     *    shader cannot be run on the CPU.
+     */
+    bool ProcessVerticesCpu(
+            UINT                    SrcStartIndex,
+            UINT                    DestIndex,
+            UINT                    VertexCount,
+            D3D9CommonBuffer*       pDst,
+            D3D9VertexDecl*         pDecl,
+            DWORD                   Flags);
+
     uint32_t GetAlphaTestPrecision();
 
     void BindAlphaTestState();
@@ -1243,6 +1263,7 @@ namespace dxvk {
 
     D3D9FFShaderModuleSet           m_ffModules;
     D3D9SWVPEmulator                m_swvpEmulator;
+    D3D9SWVPCpuEmulator             m_swvpCpuEmulator;
 
     Com<D3D9StateBlock, false>      m_recorder;
 
@@ -1329,6 +1350,11 @@ namespace dxvk {
     uint32_t                        m_lastHazardsDS = 0;
     uint32_t                        m_lastSamplerTypesFF = 0;
 
+    // Fixed-function pixel shader key, and whether the
+    // ubershader is bound while it is being compiled
+    D3D9FFShaderKeyFS               m_ffKeyFS;
+    bool                            m_ffUbershaderPS = false;
+
     D3D9SpecializationInfo          m_specInfo = D3D9SpecializationInfo();
 
     D3D9ShaderMasks                 m_vsShaderMasks = D3D9ShaderMasks();
@@ -688,6 +688,7 @@ namespace dxvk {
 
   enum D3D9FFPSMembers {
     TextureFactor = 0,
+    UberStages,
 
     MemberCount
   };
@@ -713,6 +714,13 @@ namespace dxvk {
       uint32_t varId;
     } samplers[8];
 
+    // Indexed by the texture type
+    // stored in the shader key
+    struct {
+      uint32_t typeId;
+      uint32_t varId;
+    } uberSamplers[8][3];
+
     struct {
       uint32_t COLOR;
     } out;
@@ -734,6 +742,12 @@ namespace dxvk {
       const std::string&             Name,
             D3D9FixedFunctionOptions Options);
 
+    D3D9FFShaderCompiler(
+            Rc<DxvkDevice>           Device,
+      const D3D9FFUbershaderFS&      Key,
+      const std::string&             Name,
+            D3D9FixedFunctionOptions Options);
+
     Rc<DxvkShader> compile();
 
     DxsoIsgn isgn() { return m_isgn; }
@@ -758,8 +772,24 @@ namespace dxvk {
 
     void compilePS();
 
+    void compileUberPS();
+
     void setupPS();
 
+    void setupUberSamplers();
+
+    uint32_t emitTextureOp(
+            D3DTEXTUREOP                            op,
+            uint32_t                                dst,
+            std::array<uint32_t, TextureArgCount>   arg,
+            uint32_t                                current,
+      const std::function<uint32_t()>&              getTexture);
+
+    uint32_t emitScalarReplicate(uint32_t reg);
+    uint32_t emitAlphaReplicate(uint32_t reg);
+    uint32_t emitComplement(uint32_t reg);
+    uint32_t emitSaturate(uint32_t reg);
+
     void emitPsSharedConstants();
 
     void emitVsClipping(uint32_t vtx);
@@ -787,6 +817,7 @@ namespace dxvk {
     DxsoProgramType       m_programType;
     D3D9FFShaderKeyVS     m_vsKey;
     D3D9FFShaderKeyFS     m_fsKey;
+    bool                  m_ubershader = false;
 
     D3D9FFVertexData      m_vs = { };
     D3D9FFPixelData       m_ps = { };
@@ -837,6 +868,18 @@ namespace dxvk {
   }
 
 
+  D3D9FFShaderCompiler::D3D9FFShaderCompiler(
+          Rc<DxvkDevice>           Device,
+    const D3D9FFUbershaderFS&      Key,
+    const std::string&             Name,
+          D3D9FixedFunctionOptions Options)
+  : m_module(spvVersion(1, 3)), m_options(Options) {
+    m_programType = DxsoProgramTypes::PixelShader;
+    m_ubershader  = true;
+    m_filename    = Name;
+  }
+
+
   Rc<DxvkShader> D3D9FFShaderCompiler::compile() {
     m_floatType  = m_module.defFloatType(32);
     m_uint32Type = m_module.defIntType(32, 0);
@@ -873,6 +916,8 @@ namespace dxvk {
 
     if (isVS())
       compileVS();
+    else if (m_ubershader)
+      compileUberPS();
     else
       compilePS();
 
@@ -1868,30 +1913,6 @@ namespace dxvk {
         return texture;
       };
 
-      auto ScalarReplicate = [&](uint32_t reg) {
-        std::array<uint32_t, 4> replicant = { reg, reg, reg, reg };
-        return m_module.opCompositeConstruct(m_vec4Type, replicant.size(), replicant.data());
-      };
-
-      auto AlphaReplicate = [&](uint32_t reg) {
-        uint32_t alphaComponentId = 3;
-        uint32_t alpha = m_module.opCompositeExtract(m_floatType, reg, 1, &alphaComponentId);
-
-        return ScalarReplicate(alpha);
-      };
-
-      auto Complement = [&](uint32_t reg) {
-        return m_module.opFSub(m_vec4Type,
-          m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f),
-          reg);
-      };
-
-      auto Saturate = [&](uint32_t reg) {
-        return m_module.opFClamp(m_vec4Type, reg,
-          m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f),
-          m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f));
-      };
-
       auto GetArg = [&] (uint32_t arg) {
         uint32_t reg = m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f);
 
@@ -1932,163 +1953,17 @@ namespace dxvk {
 
         // reg = 1 - reg
         if (arg & D3DTA_COMPLEMENT)
-          reg = Complement(reg);
+          reg = emitComplement(reg);
 
         // reg = reg.wwww
         if (arg & D3DTA_ALPHAREPLICATE)
-          reg = AlphaReplicate(reg);
+          reg = emitAlphaReplicate(reg);
 
         return reg;
       };
 
       auto DoOp = [&](D3DTEXTUREOP op, uint32_t dst, std::array<uint32_t, TextureArgCount> arg) {
-        switch (op) {
-          case D3DTOP_SELECTARG1:
-            dst = arg[1];
-            break;
-
-          case D3DTOP_SELECTARG2:
-            dst = arg[2];
-            break;
-
-          case D3DTOP_MODULATE4X:
-            dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
-            dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(4.0f));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATE2X:
-            dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
-            dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATE:
-            dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
-            break;
-
-          case D3DTOP_ADDSIGNED2X:
-            arg[2] = m_module.opFSub(m_vec4Type, arg[2],
-              m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
-
-            dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
-            dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_ADDSIGNED:
-            arg[2] = m_module.opFSub(m_vec4Type, arg[2],
-              m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
-
-            dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_ADD:
-            dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_SUBTRACT:
-            dst = m_module.opFSub(m_vec4Type, arg[1], arg[2]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_ADDSMOOTH:
-            dst = m_module.opFFma(m_vec4Type, Complement(arg[1]), arg[2], arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_BLENDDIFFUSEALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(diffuse));
-            break;
-
-          case D3DTOP_BLENDTEXTUREALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(GetTexture()));
-            break;
-
-          case D3DTOP_BLENDFACTORALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(m_ps.constants.textureFactor));
-            break;
-
-          case D3DTOP_BLENDTEXTUREALPHAPM:
-            dst = m_module.opFFma(m_vec4Type, arg[2], Complement(AlphaReplicate(GetTexture())), arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_BLENDCURRENTALPHA:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], AlphaReplicate(current));
-            break;
-
-          case D3DTOP_PREMODULATE:
-            Logger::warn("D3DTOP_PREMODULATE: not implemented");
-            break;
-
-          case D3DTOP_MODULATEALPHA_ADDCOLOR:
-            dst = m_module.opFFma(m_vec4Type, AlphaReplicate(arg[1]), arg[2], arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATECOLOR_ADDALPHA:
-            dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], AlphaReplicate(arg[1]));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATEINVALPHA_ADDCOLOR:
-            dst = m_module.opFFma(m_vec4Type, Complement(AlphaReplicate(arg[1])), arg[2], arg[1]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_MODULATEINVCOLOR_ADDALPHA:
-            dst = m_module.opFFma(m_vec4Type, Complement(arg[1]), arg[2], AlphaReplicate(arg[1]));
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_BUMPENVMAPLUMINANCE:
-          case D3DTOP_BUMPENVMAP:
-            // Load texture for the next stage...
-            texture = GetTexture();
-            break;
-
-          case D3DTOP_DOTPRODUCT3: {
-            // Get vec3 of arg1 & 2
-            uint32_t vec3Type = m_module.defVectorType(m_floatType, 3);
-            std::array<uint32_t, 3> indices = { 0, 1, 2 };
-            arg[1] = m_module.opVectorShuffle(vec3Type, arg[1], arg[1], indices.size(), indices.data());
-            arg[2] = m_module.opVectorShuffle(vec3Type, arg[2], arg[2], indices.size(), indices.data());
-
-            // Bias according to spec.
-            arg[1] = m_module.opFSub(vec3Type, arg[1], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
-            arg[2] = m_module.opFSub(vec3Type, arg[2], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
-
-            // Do the dotting!
-            dst = m_module.opDot(m_floatType, arg[1], arg[2]);
-
-            // Multiply by 4 and replicate -> vec4
-            dst = m_module.opFMul(m_floatType, dst, m_module.constf32(4.0f));
-            dst = ScalarReplicate(dst);
-
-            // Saturate
-            dst = Saturate(dst);
-
-            break;
-          }
-
-          case D3DTOP_MULTIPLYADD:
-            dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], arg[0]);
-            dst = Saturate(dst);
-            break;
-
-          case D3DTOP_LERP:
-            dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], arg[0]);
-            break;
-
-          default:
-            Logger::warn("Unhandled texture op!");
-            break;
-        }
-
-        return dst;
+        return emitTextureOp(op, dst, arg, current, GetTexture);
       };
 
       uint32_t& dst = stage.ResultIsTemp ? temp : current;
@@ -2175,6 +2050,543 @@ namespace dxvk {
     alphaTestPS();
   }
 
+  void D3D9FFShaderCompiler::compileUberPS() {
+    setupPS();
+
+    uint32_t boolType  = m_module.defBoolType();
+    uint32_t bvec4Type = m_module.defVectorType(boolType, 4);
+    uint32_t uvec4Type = m_module.defVectorType(m_uint32Type, 4);
+
+    uint32_t diffuse  = m_ps.in.COLOR[0];
+    uint32_t specular = m_ps.in.COLOR[1];
+
+    // Stages execute conditionally, so the registers
+    // have to live in variables rather than SSA values.
+    uint32_t vec4PtrType = m_module.defPointerType(m_vec4Type, spv::StorageClassPrivate);
+
+    uint32_t currentVar = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+    uint32_t tempVar    = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+    uint32_t textureVar = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+    uint32_t resultVar  = m_module.newVar(vec4PtrType, spv::StorageClassPrivate);
+
+    m_module.setDebugName(currentVar, "current");
+    m_module.setDebugName(tempVar,    "temp");
+    m_module.setDebugName(textureVar, "texture");
+    m_module.setDebugName(resultVar,  "result");
+
+    m_module.opStore(currentVar, diffuse);
+    m_module.opStore(tempVar,    m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f));
+    m_module.opStore(textureVar, m_module.constvec4f32(0.0f, 0.0f, 0.0f, 1.0f));
+
+    uint32_t unboundTextureConstId = m_module.constvec4f32(0.0f, 0.0f, 0.0f, 1.0f);
+
+    auto BoolReplicate = [&](uint32_t cond) {
+      std::array<uint32_t, 4> replicant = { cond, cond, cond, cond };
+      return m_module.opCompositeConstruct(bvec4Type, replicant.size(), replicant.data());
+    };
+
+    auto ExtractBits = [&](uint32_t value, uint32_t offset, uint32_t count) {
+      return m_module.opBitFieldUExtract(m_uint32Type, value,
+        m_module.consti32(offset), m_module.consti32(count));
+    };
+
+    auto TestMask = [&](uint32_t value, uint32_t mask) {
+      return m_module.opINotEqual(boolType,
+        m_module.opBitwiseAnd(m_uint32Type, value, m_module.constu32(mask)),
+        m_module.constu32(0));
+    };
+
+    auto LoadStage = [&](uint32_t stage) {
+      std::array<uint32_t, 2> indices = {{
+        m_module.constu32(uint32_t(D3D9FFPSMembers::UberStages)),
+        m_module.constu32(stage),
+      }};
+
+      return m_module.opLoad(uvec4Type, m_module.opAccessChain(
+        m_module.defPointerType(uvec4Type, spv::StorageClassUniform),
+        m_ps.constantBuffer, indices.size(), indices.data()));
+    };
+
+    auto LoadShared = [&](uint32_t type, uint32_t index) {
+      uint32_t offset = m_module.constu32(index);
+
+      return m_module.opLoad(type, m_module.opAccessChain(
+        m_module.defPointerType(type, spv::StorageClassUniform),
+        m_ps.sharedState, 1, &offset));
+    };
+
+    // Ops that leave the destination untouched, i.e. DISABLE,
+    // PREMODULATE and the bump mapping ops, use the default case.
+    static constexpr std::array<D3DTEXTUREOP, 22> uberOps = {{
+      D3DTOP_SELECTARG1,
+      D3DTOP_SELECTARG2,
+      D3DTOP_MODULATE,
+      D3DTOP_MODULATE2X,
+      D3DTOP_MODULATE4X,
+      D3DTOP_ADD,
+      D3DTOP_ADDSIGNED,
+      D3DTOP_ADDSIGNED2X,
+      D3DTOP_SUBTRACT,
+      D3DTOP_ADDSMOOTH,
+      D3DTOP_BLENDDIFFUSEALPHA,
+      D3DTOP_BLENDTEXTUREALPHA,
+      D3DTOP_BLENDFACTORALPHA,
+      D3DTOP_BLENDTEXTUREALPHAPM,
+      D3DTOP_BLENDCURRENTALPHA,
+      D3DTOP_MODULATEALPHA_ADDCOLOR,
+      D3DTOP_MODULATECOLOR_ADDALPHA,
+      D3DTOP_MODULATEINVALPHA_ADDCOLOR,
+      D3DTOP_MODULATEINVCOLOR_ADDALPHA,
+      D3DTOP_DOTPRODUCT3,
+      D3DTOP_MULTIPLYADD,
+      D3DTOP_LERP,
+    }};
+
+    for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
+      uint32_t stage = LoadStage(i);
+
+      std::array<uint32_t, 4> components;
+
+      for (uint32_t c = 0; c < components.size(); c++)
+        components[c] = m_module.opCompositeExtract(m_uint32Type, stage, 1, &c);
+
+      uint32_t colorOp = ExtractBits(components[0], 0, 8);
+      uint32_t alphaOp = ExtractBits(components[0], 8, 8);
+      uint32_t flags   = components[3];
+
+      std::array<uint32_t, TextureArgCount> colorArgs;
+      std::array<uint32_t, TextureArgCount> alphaArgs;
+
+      for (uint32_t a = 0; a < TextureArgCount; a++) {
+        colorArgs[a] = ExtractBits(components[1], 8 * a, 8);
+        alphaArgs[a] = ExtractBits(components[2], 8 * a, 8);
+      }
+
+      // The key disables all stages after the first disabled
+      // one, so there is no need to track this across stages.
+      uint32_t stageLabel    = m_module.allocateId();
+      uint32_t stageEndLabel = m_module.allocateId();
+
+      m_module.opSelectionMerge(stageEndLabel, spv::SelectionControlMaskNone);
+      m_module.opBranchConditional(
+        m_module.opINotEqual(boolType, colorOp, m_module.constu32(D3DTOP_DISABLE)),
+        stageLabel, stageEndLabel);
+      m_module.opLabel(stageLabel);
+
+      // Sample the texture up front if any arg or op needs it
+      uint32_t sampleLabel    = m_module.allocateId();
+      uint32_t sampleEndLabel = m_module.allocateId();
+
+      m_module.opSelectionMerge(sampleEndLabel, spv::SelectionControlMaskNone);
+      m_module.opBranchConditional(
+        TestMask(flags, 1u << D3D9FFUberStage_SampleTexture),
+        sampleLabel, sampleEndLabel);
+      m_module.opLabel(sampleLabel);
+
+      uint32_t texcoord = m_ps.in.TEXCOORD[i];
+
+      uint32_t projIdx   = ExtractBits(flags, D3D9FFUberStage_ProjectedIdx, 2);
+      uint32_t projValue = m_module.opVectorExtractDynamic(m_floatType, texcoord, projIdx);
+      uint32_t projRcp   = m_module.opFDiv(m_floatType, m_module.constf32(1.0f), projValue);
+
+      texcoord = m_module.opSelect(m_vec4Type,
+        BoolReplicate(TestMask(flags, 1u << D3D9FFUberStage_Projected)),
+        m_module.opVectorTimesScalar(m_vec4Type, texcoord, projRcp),
+        texcoord);
+
+      uint32_t prevBump = ExtractBits(flags, D3D9FFUberStage_PrevBump, 2);
+
+      if (i != 0) {
+        std::array<uint32_t, 2> indices = { 0, 1 };
+
+        uint32_t prevTexture = m_module.opLoad(m_vec4Type, textureVar);
+        uint32_t t = m_module.opVectorShuffle(m_vec2Type,
+          prevTexture, prevTexture, indices.size(), indices.data());
+
+        uint32_t bumpCoords = texcoord;
+
+        for (uint32_t c = 0; c < 2; c++) {
+          uint32_t bm = LoadShared(m_vec2Type,
+            D3D9SharedPSStages_Count * (i - 1) + D3D9SharedPSStages_BumpEnvMat0 + c);
+
+          uint32_t tc_m_n = m_module.opCompositeExtract(m_floatType, bumpCoords, 1, &c);
+                   tc_m_n = m_module.opFAdd(m_floatType, tc_m_n, m_module.opDot(m_floatType, bm, t));
+
+          bumpCoords = m_module.opCompositeInsert(m_vec4Type, tc_m_n, bumpCoords, 1, &c);
+        }
+
+        texcoord = m_module.opSelect(m_vec4Type,
+          BoolReplicate(m_module.opINotEqual(boolType, prevBump, m_module.constu32(0))),
+          bumpCoords, texcoord);
+      }
+
+      std::array<SpirvSwitchCaseLabel, 3> typeCaseLabels = {{
+        { 0u, m_module.allocateId() },
+        { 1u, m_module.allocateId() },
+        { 2u, m_module.allocateId() },
+      }};
+
+      uint32_t typeEndLabel = m_module.allocateId();
+
+      m_module.opSelectionMerge(typeEndLabel, spv::SelectionControlMaskNone);
+      m_module.opSwitch(ExtractBits(flags, D3D9FFUberStage_Type, 2),
+        typeCaseLabels[0].labelId,
+        typeCaseLabels.size(),
+        typeCaseLabels.data());
+
+      for (const auto& label : typeCaseLabels) {
+        m_module.opLabel(label.labelId);
+
+        const auto& sampler = m_ps.uberSamplers[i][label.literal];
+
+        // 2D textures use two coordinates, volumes and cubes three
+        uint32_t texcoordCnt = label.literal ? 3 : 2;
+        uint32_t texcoord_t  = m_module.defVectorType(m_floatType, texcoordCnt);
+
+        std::array<uint32_t, 3> indices = { 0, 1, 2 };
+
+        SpirvImageOperands imageOperands;
+        uint32_t texture = m_module.opImageSampleImplicitLod(m_vec4Type,
+          m_module.opLoad(sampler.typeId, sampler.varId),
+          m_module.opVectorShuffle(texcoord_t, texcoord, texcoord, texcoordCnt, indices.data()),
+          imageOperands);
+
+        m_module.opStore(textureVar, texture);
+        m_module.opBranch(typeEndLabel);
+      }
+
+      m_module.opLabel(typeEndLabel);
+
+      if (i != 0) {
+        uint32_t texture = m_module.opLoad(m_vec4Type, textureVar);
+
+        uint32_t lScale  = LoadShared(m_floatType, D3D9SharedPSStages_Count * (i - 1) + D3D9SharedPSStages_BumpEnvLScale);
+        uint32_t lOffset = LoadShared(m_floatType, D3D9SharedPSStages_Count * (i - 1) + D3D9SharedPSStages_BumpEnvLOffset);
+
+        uint32_t zIndex = 2;
+        uint32_t scale = m_module.opCompositeExtract(m_floatType, texture, 1, &zIndex);
+                 scale = m_module.opFMul(m_floatType, scale, lScale);
+                 scale = m_module.opFAdd(m_floatType, scale, lOffset);
+                 scale = m_module.opFClamp(m_floatType, scale, m_module.constf32(0.0f), m_module.constf32(1.0));
+
+        texture = m_module.opSelect(m_vec4Type,
+          BoolReplicate(m_module.opIEqual(boolType, prevBump, m_module.constu32(2))),
+          m_module.opVectorTimesScalar(m_vec4Type, texture, scale),
+          texture);
+
+        m_module.opStore(textureVar, texture);
+      }
+
+      m_module.opBranch(sampleEndLabel);
+      m_module.opLabel(sampleEndLabel);
+
+      uint32_t current  = m_module.opLoad(m_vec4Type, currentVar);
+      uint32_t temp     = m_module.opLoad(m_vec4Type, tempVar);
+      uint32_t texture  = m_module.opLoad(m_vec4Type, textureVar);
+      uint32_t constant = LoadShared(m_vec4Type, D3D9SharedPSStages_Count * i + D3D9SharedPSStages_Constant);
+
+      uint32_t textureArg = m_module.opSelect(m_vec4Type,
+        BoolReplicate(TestMask(flags, 1u << D3D9FFUberStage_TextureBound)),
+        texture, unboundTextureConstId);
+
+      auto GetArg = [&] (uint32_t arg) {
+        const std::array<std::pair<uint32_t, uint32_t>, 7> regs = {{
+          { D3DTA_CONSTANT, constant                      },
+          { D3DTA_CURRENT,  current                       },
+          { D3DTA_DIFFUSE,  diffuse                       },
+          { D3DTA_SPECULAR, specular                      },
+          { D3DTA_TEMP,     temp                          },
+          { D3DTA_TEXTURE,  textureArg                    },
+          { D3DTA_TFACTOR,  m_ps.constants.textureFactor  },
+        }};
+
+        uint32_t select = m_module.opBitwiseAnd(m_uint32Type, arg, m_module.constu32(D3DTA_SELECTMASK));
+        uint32_t reg = m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f);
+
+        for (const auto& entry : regs) {
+          reg = m_module.opSelect(m_vec4Type,
+            BoolReplicate(m_module.opIEqual(boolType, select, m_module.constu32(entry.first))),
+            entry.second, reg);
+        }
+
+        reg = m_module.opSelect(m_vec4Type,
+          BoolReplicate(TestMask(arg, D3DTA_COMPLEMENT)),
+          emitComplement(reg), reg);
+
+        reg = m_module.opSelect(m_vec4Type,
+          BoolReplicate(TestMask(arg, D3DTA_ALPHAREPLICATE)),
+          emitAlphaReplicate(reg), reg);
+
+        return reg;
+      };
+
+      auto DoOp = [&](uint32_t op, uint32_t dst, std::array<uint32_t, TextureArgCount> arg) {
+        for (uint32_t& a : arg)
+          a = GetArg(a);
+
+        std::array<SpirvSwitchCaseLabel, uberOps.size()> opCaseLabels;
+
+        for (uint32_t o = 0; o < uberOps.size(); o++)
+          opCaseLabels[o] = { uint32_t(uberOps[o]), m_module.allocateId() };
+
+        uint32_t opEndLabel = m_module.allocateId();
+
+        m_module.opStore(resultVar, dst);
+        m_module.opSelectionMerge(opEndLabel, spv::SelectionControlMaskNone);
+        m_module.opSwitch(op, opEndLabel, opCaseLabels.size(), opCaseLabels.data());
+
+        for (const auto& label : opCaseLabels) {
+          m_module.opLabel(label.labelId);
+          m_module.opStore(resultVar, emitTextureOp(D3DTEXTUREOP(label.literal),
+            dst, arg, current, [texture] { return texture; }));
+          m_module.opBranch(opEndLabel);
+        }
+
+        m_module.opLabel(opEndLabel);
+        return m_module.opLoad(m_vec4Type, resultVar);
+      };
+
+      uint32_t resultIsTemp = BoolReplicate(TestMask(flags, 1u << D3D9FFUberStage_ResultIsTemp));
+
+      uint32_t dst = m_module.opSelect(m_vec4Type, resultIsTemp, temp, current);
+
+      uint32_t colorResult = DoOp(colorOp, dst, colorArgs);
+      uint32_t alphaResult = DoOp(alphaOp, dst, alphaArgs);
+
+      // src0.x, src0.y, src0.z src1.w
+      std::array<uint32_t, 4> indices = { 0, 1, 2, 4 + 3 };
+      uint32_t result = m_module.opVectorShuffle(m_vec4Type,
+        colorResult, alphaResult, indices.size(), indices.data());
+
+      // D3DTOP_DOTPRODUCT3 also writes alpha
+      result = m_module.opSelect(m_vec4Type,
+        BoolReplicate(m_module.opIEqual(boolType, colorOp, m_module.constu32(D3DTOP_DOTPRODUCT3))),
+        colorResult, result);
+
+      m_module.opStore(tempVar,    m_module.opSelect(m_vec4Type, resultIsTemp, result, temp));
+      m_module.opStore(currentVar, m_module.opSelect(m_vec4Type, resultIsTemp, current, result));
+
+      m_module.opBranch(stageEndLabel);
+      m_module.opLabel(stageEndLabel);
+    }
+
+    uint32_t current = m_module.opLoad(m_vec4Type, currentVar);
+
+    // Global specular enable is stored in the first stage
+    uint32_t flagsIndex = 3;
+    uint32_t specularEnable = TestMask(
+      m_module.opCompositeExtract(m_uint32Type, LoadStage(0), 1, &flagsIndex),
+      1u << D3D9FFUberStage_GlobalSpecular);
+
+    current = m_module.opSelect(m_vec4Type, BoolReplicate(specularEnable),
+      m_module.opFAdd(m_vec4Type, current,
+        m_module.opFMul(m_vec4Type, specular, m_module.constvec4f32(1.0f, 1.0f, 1.0f, 0.0f))),
+      current);
+
+    D3D9FogContext fogCtx;
+    fogCtx.IsPixel     = true;
+    fogCtx.RangeFog    = false;
+    fogCtx.RenderState = m_rsBlock;
+    fogCtx.vPos        = m_ps.in.POS;
+    fogCtx.vFog        = m_ps.in.FOG;
+    fogCtx.oColor      = current;
+    fogCtx.IsFixedFunction = true;
+    fogCtx.IsPositionT = false;
+    fogCtx.HasSpecular = false;
+    fogCtx.Specular    = 0;
+    fogCtx.SpecUBO     = m_specUbo;
+    current = DoFixedFunctionFog(m_spec, m_module, fogCtx);
+
+    m_module.opStore(m_ps.out.COLOR, current);
+
+    alphaTestPS();
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitTextureOp(
+          D3DTEXTUREOP                            op,
+          uint32_t                                dst,
+          std::array<uint32_t, TextureArgCount>   arg,
+          uint32_t                                current,
+    const std::function<uint32_t()>&              getTexture) {
+    switch (op) {
+      case D3DTOP_SELECTARG1:
+        dst = arg[1];
+        break;
+
+      case D3DTOP_SELECTARG2:
+        dst = arg[2];
+        break;
+
+      case D3DTOP_MODULATE4X:
+        dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
+        dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(4.0f));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATE2X:
+        dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
+        dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATE:
+        dst = m_module.opFMul(m_vec4Type, arg[1], arg[2]);
+        break;
+
+      case D3DTOP_ADDSIGNED2X:
+        arg[2] = m_module.opFSub(m_vec4Type, arg[2],
+          m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
+
+        dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
+        dst = m_module.opVectorTimesScalar(m_vec4Type, dst, m_module.constf32(2.0f));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_ADDSIGNED:
+        arg[2] = m_module.opFSub(m_vec4Type, arg[2],
+          m_module.constvec4f32(0.5f, 0.5f, 0.5f, 0.5f));
+
+        dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_ADD:
+        dst = m_module.opFAdd(m_vec4Type, arg[1], arg[2]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_SUBTRACT:
+        dst = m_module.opFSub(m_vec4Type, arg[1], arg[2]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_ADDSMOOTH:
+        dst = m_module.opFFma(m_vec4Type, emitComplement(arg[1]), arg[2], arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_BLENDDIFFUSEALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(m_ps.in.COLOR[0]));
+        break;
+
+      case D3DTOP_BLENDTEXTUREALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(getTexture()));
+        break;
+
+      case D3DTOP_BLENDFACTORALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(m_ps.constants.textureFactor));
+        break;
+
+      case D3DTOP_BLENDTEXTUREALPHAPM:
+        dst = m_module.opFFma(m_vec4Type, arg[2], emitComplement(emitAlphaReplicate(getTexture())), arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_BLENDCURRENTALPHA:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], emitAlphaReplicate(current));
+        break;
+
+      case D3DTOP_PREMODULATE:
+        Logger::warn("D3DTOP_PREMODULATE: not implemented");
+        break;
+
+      case D3DTOP_MODULATEALPHA_ADDCOLOR:
+        dst = m_module.opFFma(m_vec4Type, emitAlphaReplicate(arg[1]), arg[2], arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATECOLOR_ADDALPHA:
+        dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], emitAlphaReplicate(arg[1]));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATEINVALPHA_ADDCOLOR:
+        dst = m_module.opFFma(m_vec4Type, emitComplement(emitAlphaReplicate(arg[1])), arg[2], arg[1]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_MODULATEINVCOLOR_ADDALPHA:
+        dst = m_module.opFFma(m_vec4Type, emitComplement(arg[1]), arg[2], emitAlphaReplicate(arg[1]));
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_BUMPENVMAPLUMINANCE:
+      case D3DTOP_BUMPENVMAP:
+        // Load texture for the next stage...
+        getTexture();
+        break;
+
+      case D3DTOP_DOTPRODUCT3: {
+        // Get vec3 of arg1 & 2
+        uint32_t vec3Type = m_module.defVectorType(m_floatType, 3);
+        std::array<uint32_t, 3> indices = { 0, 1, 2 };
+        arg[1] = m_module.opVectorShuffle(vec3Type, arg[1], arg[1], indices.size(), indices.data());
+        arg[2] = m_module.opVectorShuffle(vec3Type, arg[2], arg[2], indices.size(), indices.data());
+
+        // Bias according to spec.
+        arg[1] = m_module.opFSub(vec3Type, arg[1], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
+        arg[2] = m_module.opFSub(vec3Type, arg[2], m_module.constvec3f32(0.5f, 0.5f, 0.5f));
+
+        // Do the dotting!
+        dst = m_module.opDot(m_floatType, arg[1], arg[2]);
+
+        // Multiply by 4 and replicate -> vec4
+        dst = m_module.opFMul(m_floatType, dst, m_module.constf32(4.0f));
+        dst = emitScalarReplicate(dst);
+
+        // Saturate
+        dst = emitSaturate(dst);
+
+        break;
+      }
+
+      case D3DTOP_MULTIPLYADD:
+        dst = m_module.opFFma(m_vec4Type, arg[1], arg[2], arg[0]);
+        dst = emitSaturate(dst);
+        break;
+
+      case D3DTOP_LERP:
+        dst = m_module.opFMix(m_vec4Type, arg[2], arg[1], arg[0]);
+        break;
+
+      default:
+        Logger::warn("Unhandled texture op!");
+        break;
+    }
+
+    return dst;
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitScalarReplicate(uint32_t reg) {
+    std::array<uint32_t, 4> replicant = { reg, reg, reg, reg };
+    return m_module.opCompositeConstruct(m_vec4Type, replicant.size(), replicant.data());
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitAlphaReplicate(uint32_t reg) {
+    uint32_t alphaComponentId = 3;
+    uint32_t alpha = m_module.opCompositeExtract(m_floatType, reg, 1, &alphaComponentId);
+
+    return emitScalarReplicate(alpha);
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitComplement(uint32_t reg) {
+    return m_module.opFSub(m_vec4Type,
+      m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f),
+      reg);
+  }
+
+
+  uint32_t D3D9FFShaderCompiler::emitSaturate(uint32_t reg) {
+    return m_module.opFClamp(m_vec4Type, reg,
+      m_module.constvec4f32(0.0f, 0.0f, 0.0f, 0.0f),
+      m_module.constvec4f32(1.0f, 1.0f, 1.0f, 1.0f));
+  }
+
+
   void D3D9FFShaderCompiler::setupPS() {
     setupRenderStateInfo();
     m_specUbo = SetupSpecUBO(m_module, m_bindings);
@@ -2206,8 +2618,15 @@ namespace dxvk {
     m_ps.out.COLOR   = declareIO(false, DxsoSemantic{ DxsoUsage::Color, 0 });
 
     // Constant Buffer for PS.
+    uint32_t uberStagesType = m_module.defArrayTypeUnique(
+      m_module.defVectorType(m_uint32Type, 4),
+      m_module.constu32(caps::TextureStageCount));
+
+    m_module.decorateArrayStride(uberStagesType, sizeof(uint32_t) * 4);
+
     std::array<uint32_t, uint32_t(D3D9FFPSMembers::MemberCount)> members = {
-      m_vec4Type // Texture Factor
+      m_vec4Type,     // Texture Factor
+      uberStagesType, // Packed stages, ubershader only
     };
 
     const uint32_t structType =
@@ -2223,6 +2642,7 @@ namespace dxvk {
 
     m_module.setDebugName(structType, "D3D9FixedFunctionPS");
     m_module.setDebugMemberName(structType, 0, "textureFactor");
+    m_module.setDebugMemberName(structType, 1, "uberStages");
 
     m_ps.constantBuffer = m_module.newVar(
       m_module.defPointerType(structType, spv::StorageClassUniform),
@@ -2255,6 +2675,12 @@ namespace dxvk {
 
     m_ps.constants.textureFactor = LoadConstant(m_vec4Type, uint32_t(D3D9FFPSMembers::TextureFactor));
 
+    if (m_ubershader) {
+      setupUberSamplers();
+      emitPsSharedConstants();
+      return;
+    }
+
     // Samplers
     for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
       auto& sampler = m_ps.samplers[i];
@@ -2315,6 +2741,52 @@ namespace dxvk {
   }
 
 
+  void D3D9FFShaderCompiler::setupUberSamplers() {
+    // The texture type is only known at runtime, so declare
+    // samplers for all types with the same binding, which
+    // is what DXSO does for SM1 shaders as well.
+    static const std::array<std::pair<spv::Dim, const char*>, 3> types = {{
+      { spv::Dim2D,   "_2d"   },
+      { spv::Dim3D,   "_3d"   },
+      { spv::DimCube, "_cube" },
+    }};
+
+    for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
+      const uint32_t bindingId = computeResourceSlotId(DxsoProgramType::PixelShader,
+        DxsoBindingType::Image, i);
+
+      for (uint32_t t = 0; t < types.size(); t++) {
+        auto& sampler = m_ps.uberSamplers[i][t];
+
+        sampler.typeId = m_module.defImageType(
+          m_module.defFloatType(32),
+          types[t].first, 0, 0, 0, 1,
+          spv::ImageFormatUnknown);
+
+        sampler.typeId = m_module.defSampledImageType(sampler.typeId);
+
+        sampler.varId = m_module.newVar(
+          m_module.defPointerType(
+            sampler.typeId, spv::StorageClassUniformConstant),
+          spv::StorageClassUniformConstant);
+
+        std::string name = str::format("s", i, types[t].second);
+        m_module.setDebugName(sampler.varId, name.c_str());
+
+        m_module.decorateDescriptorSet(sampler.varId, 0);
+        m_module.decorateBinding(sampler.varId, bindingId);
+      }
+
+      // Store descriptor info for the shader interface
+      DxvkBindingInfo binding = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER };
+      binding.resourceBinding = bindingId;
+      binding.viewType        = VK_IMAGE_VIEW_TYPE_MAX_ENUM;
+      binding.access          = VK_ACCESS_SHADER_READ_BIT;
+      m_bindings.push_back(binding);
+    }
+  }
+
+
   void D3D9FFShaderCompiler::emitPsSharedConstants() {
     m_ps.sharedState = GetSharedConstants(m_module);
 
@@ -2457,6 +2929,72 @@ namespace dxvk {
   }
 
 
+  void PackFixedFunctionUberStages(
+    const D3D9FFShaderKeyFS&    Key,
+          D3D9FixedFunctionPS*  pData) {
+    auto UsesTexture = [](uint32_t op, uint32_t arg0, uint32_t arg1, uint32_t arg2) {
+      return op != D3DTOP_DISABLE && (
+        (arg0 & D3DTA_SELECTMASK) == D3DTA_TEXTURE ||
+        (arg1 & D3DTA_SELECTMASK) == D3DTA_TEXTURE ||
+        (arg2 & D3DTA_SELECTMASK) == D3DTA_TEXTURE);
+    };
+
+    auto OpSamplesTexture = [](uint32_t op) {
+      return op == D3DTOP_BLENDTEXTUREALPHA
+          || op == D3DTOP_BLENDTEXTUREALPHAPM
+          || op == D3DTOP_BUMPENVMAP
+          || op == D3DTOP_BUMPENVMAPLUMINANCE;
+    };
+
+    for (uint32_t i = 0; i < caps::TextureStageCount; i++) {
+      const auto& stage = Key.Stages[i].Contents;
+
+      pData->uberStages[i][0] = stage.ColorOp
+                              | stage.AlphaOp   << 8;
+      pData->uberStages[i][1] = stage.ColorArg0
+                              | stage.ColorArg1 << 8
+                              | stage.ColorArg2 << 16;
+      pData->uberStages[i][2] = stage.AlphaArg0
+                              | stage.AlphaArg1 << 8
+                              | stage.AlphaArg2 << 16;
+
+      // Same projection component as the specialized
+      // shader, taking the texture dimensions into account
+      uint32_t texcoordCnt = (stage.Type ? 3 : 2) + stage.Projected;
+      uint32_t projIdx = stage.ProjectedCount;
+
+      if (projIdx == 0 || projIdx > texcoordCnt)
+        projIdx = 4;
+
+      bool sampleTexture = OpSamplesTexture(stage.ColorOp)
+        || OpSamplesTexture(stage.AlphaOp)
+        || (stage.TextureBound && (
+          UsesTexture(stage.ColorOp, stage.ColorArg0, stage.ColorArg1, stage.ColorArg2) ||
+          UsesTexture(stage.AlphaOp, stage.AlphaArg0, stage.AlphaArg1, stage.AlphaArg2)));
+
+      uint32_t prevBump = 0;
+
+      if (i != 0) {
+        uint32_t prevOp = Key.Stages[i - 1].Contents.ColorOp;
+
+        if (prevOp == D3DTOP_BUMPENVMAP)
+          prevBump = 1;
+        else if (prevOp == D3DTOP_BUMPENVMAPLUMINANCE)
+          prevBump = 2;
+      }
+
+      pData->uberStages[i][3] = stage.Type                 << D3D9FFUberStage_Type
+                              | stage.ResultIsTemp         << D3D9FFUberStage_ResultIsTemp
+                              | stage.Projected            << D3D9FFUberStage_Projected
+                              | (projIdx - 1)              << D3D9FFUberStage_ProjectedIdx
+                              | stage.TextureBound         << D3D9FFUberStage_TextureBound
+                              | uint32_t(sampleTexture)    << D3D9FFUberStage_SampleTexture
+                              | prevBump                   << D3D9FFUberStage_PrevBump
+                              | stage.GlobalSpecularEnable << D3D9FFUberStage_GlobalSpecular;
+    }
+  }
+
+
   D3D9FFShader::D3D9FFShader(
           D3D9DeviceEx*         pDevice,
     const D3D9FFShaderKeyVS&    Key) {
@@ -2502,6 +3040,28 @@ namespace dxvk {
     pDevice->GetDXVKDevice()->registerShader(m_shader);
   }
 
+  D3D9FFShader::D3D9FFShader(
+          D3D9DeviceEx*         pDevice,
+    const D3D9FFUbershaderFS&   Key) {
+    std::string name = "FF_UBER_PS";
+
+    Sha1Hash hash = Sha1Hash::compute(name.data(), name.size());
+    DxvkShaderKey shaderKey = { VK_SHADER_STAGE_FRAGMENT_BIT, hash };
+
+    D3D9FFShaderCompiler compiler(
+      pDevice->GetDXVKDevice(),
+      Key, name,
+      pDevice->GetOptions());
+
+    m_shader = compiler.compile();
+    m_isgn   = compiler.isgn();
+
+    Dump(pDevice, Key, name);
+
+    m_shader->setShaderKey(shaderKey);
+    pDevice->GetDXVKDevice()->registerShader(m_shader);
+  }
+
   template <typename T>
   void D3D9FFShader::Dump(D3D9DeviceEx* pDevice, const T& Key, const std::string& Name) {
     const std::string& dumpPath = pDevice->GetOptions()->shaderDumpPath;
@@ -2516,37 +3076,375 @@ namespace dxvk {
   }
 
 
-  D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
-          D3D9DeviceEx*         pDevice,
+  /**
+   * \brief Fixed-function key cache header
+   *
+   * Key sizes are stored in the header so that any change
+   * to the key layout invalidates the cache file.
+   */
+  struct D3D9FFKeyCacheHeader {
+    char     magic[4]  = { 'D', '9', 'F', 'F' };
+    uint32_t version   = 1;
+    uint32_t keySizeVS = sizeof(D3D9FFShaderKeyVS);
+    uint32_t keySizeFS = sizeof(D3D9FFShaderKeyFS);
+  };
+
+
+  /**
+   * \brief Fixed-function key cache entry header
+   *
+   * Followed by the raw key data.
+   */
+  struct D3D9FFKeyCacheEntryHeader {
+    uint32_t stage;
+    Sha1Hash hash;
+  };
+
+
+  D3D9FFShaderModuleSet::D3D9FFShaderModuleSet(
+          D3D9DeviceEx*         pDevice)
+  : m_device(pDevice) {
+
+  }
+
+
+  D3D9FFShaderModuleSet::~D3D9FFShaderModuleSet() {
+    this->StopWorkers();
+  }
+
+
+  void D3D9FFShaderModuleSet::PrecompileShaderModule(
     const D3D9FFShaderKeyVS&    ShaderKey) {
-    // Use the shader's unique key for the lookup
-    auto entry = m_vsModules.find(ShaderKey);
-    if (entry != m_vsModules.end())
-      return entry->second;
-    
-    D3D9FFShader shader(
-      pDevice, ShaderKey);
+    std::unique_lock lock(m_mutex);
+    QueueShaderModule(m_vsModules, ShaderKey, false);
+  }
 
-    m_vsModules.insert({ShaderKey, shader});
 
-    return shader;
+  void D3D9FFShaderModuleSet::PrecompileShaderModule(
+    const D3D9FFShaderKeyFS&    ShaderKey) {
+    std::unique_lock lock(m_mutex);
+    QueueShaderModule(m_fsModules, ShaderKey, false);
+  }
+
+
+  D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
+    const D3D9FFShaderKeyVS&    ShaderKey) {
+    return LookupShaderModule(m_vsModules, ShaderKey);
   }
 
 
   D3D9FFShader D3D9FFShaderModuleSet::GetShaderModule(
-          D3D9DeviceEx*         pDevice,
     const D3D9FFShaderKeyFS&    ShaderKey) {
-    // Use the shader's unique key for the lookup
+    return LookupShaderModule(m_fsModules, ShaderKey);
+  }
+
+
+  bool D3D9FFShaderModuleSet::IsShaderModuleReady(
+    const D3D9FFShaderKeyFS&    ShaderKey) const {
+    std::unique_lock lock(m_mutex);
+
     auto entry = m_fsModules.find(ShaderKey);
-    if (entry != m_fsModules.end())
-      return entry->second;
-    
-    D3D9FFShader shader(
-      pDevice, ShaderKey);
+    return entry != m_fsModules.end() && entry->second;
+  }
+
+
+  void D3D9FFShaderModuleSet::CreateUbershaders() {
+    m_ubershaderFS = D3D9FFShader(m_device, D3D9FFUbershaderFS());
+  }
+
+
+  void D3D9FFShaderModuleSet::PrecompileCachedShaders() {
+    std::string useStateCache = env::getEnvVar("DXVK_STATE_CACHE");
+
+    m_cacheEnabled = useStateCache != "0" && useStateCache != "disable"
+      && m_device->GetDXVKDevice()->config().enableStateCache;
+
+    if (!m_cacheEnabled)
+      return;
+
+    std::vector<WorkItem> items;
+    bool valid = useStateCache != "reset";
+
+    if (valid) {
+      std::ifstream file(GetCacheFileName().c_str(), std::ios_base::binary);
+
+      D3D9FFKeyCacheHeader expected;
+      D3D9FFKeyCacheHeader header;
+
+      valid = file && file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        && !std::memcmp(&header, &expected, sizeof(header));
+
+      D3D9FFKeyCacheEntryHeader entry;
+
+      while (valid && file.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        WorkItem item = { };
+        item.isVS     = entry.stage == VK_SHADER_STAGE_VERTEX_BIT;
+        item.isCached = true;
+
+        void*  keyData = item.isVS ? static_cast<void*>(&item.keyVS) : static_cast<void*>(&item.keyFS);
+        size_t keySize = item.isVS ? sizeof(item.keyVS) : sizeof(item.keyFS);
+
+        valid = (item.isVS || entry.stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+          && file.read(reinterpret_cast<char*>(keyData), keySize)
+          && entry.hash == Sha1Hash::compute(keyData, keySize);
+
+        if (valid)
+          items.push_back(item);
+      }
+
+      valid &= file.eof();
+    }
+
+    bool cacheFileOpen = false;
+
+    { std::unique_lock lock(m_cacheMutex);
+
+      if (valid) {
+        m_cacheFile = std::ofstream(GetCacheFileName().c_str(),
+          std::ios_base::binary | std::ios_base::app);
+      } else {
+        // Recreate the file if it is missing or corrupted,
+        // and write back all the entries we could recover
+        m_cacheFile = std::ofstream(GetCacheFileName().c_str(),
+          std::ios_base::binary | std::ios_base::trunc);
+
+        std::string cacheDir = env::getEnvVar("DXVK_STATE_CACHE_PATH");
+
+        if (!m_cacheFile && env::createDirectory(cacheDir)) {
+          m_cacheFile = std::ofstream(GetCacheFileName().c_str(),
+            std::ios_base::binary | std::ios_base::trunc);
+        }
+
+        if (m_cacheFile) {
+          Logger::warn("D3D9: Creating new fixed-function key cache file");
+
+          D3D9FFKeyCacheHeader header;
+          m_cacheFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+      }
+
+      cacheFileOpen = bool(m_cacheFile);
+    }
+
+    if (!cacheFileOpen)
+      return;
+
+    if (!items.empty())
+      Logger::info(str::format("D3D9: Precompiling ", items.size(), " fixed-function shaders"));
+
+    // Entries recovered from a corrupted file are written back
+    std::unique_lock lock(m_mutex);
+
+    for (const auto& item : items) {
+      if (item.isVS)
+        QueueShaderModule(m_vsModules, item.keyVS, valid);
+      else
+        QueueShaderModule(m_fsModules, item.keyFS, valid);
+    }
+  }
+
+
+  D3D9FFShaderStats D3D9FFShaderModuleSet::GetStats() const {
+    std::unique_lock lock(m_mutex);
+
+    D3D9FFShaderStats result;
+    result.shaderCount  = uint32_t(m_vsModules.size() + m_fsModules.size()) - m_pendingCount;
+    result.pendingCount = m_pendingCount;
+    result.stallCount   = m_stallCount;
+    return result;
+  }
+
+
+  void D3D9FFShaderModuleSet::StopWorkers() {
+    { std::unique_lock lock(m_mutex);
+
+      // Prevent workers from being started during
+      // teardown even if they never ran before
+      m_workersStopped = true;
+
+      if (!m_workersRunning)
+        return;
+
+      m_workersRunning = false;
+      m_workerCond.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+
+    m_workers.clear();
+  }
+
+
+  template <typename Key>
+  void D3D9FFShaderModuleSet::QueueShaderModule(
+          ModuleMap<Key>&       Map,
+    const Key&                  ShaderKey,
+          bool                  IsCached) {
+    if (m_workersStopped)
+      return;
+
+    auto entry = Map.emplace(std::piecewise_construct,
+      std::forward_as_tuple(ShaderKey),
+      std::forward_as_tuple());
+
+    if (!entry.second)
+      return;
+
+    WorkItem item = { };
+    item.isVS     = std::is_same_v<Key, D3D9FFShaderKeyVS>;
+    item.isCached = IsCached;
+
+    if constexpr (std::is_same_v<Key, D3D9FFShaderKeyVS>)
+      item.keyVS = ShaderKey;
+    else
+      item.keyFS = ShaderKey;
+
+    m_workQueue.push(item);
+    m_pendingCount += 1;
+
+    StartWorkers();
+    m_workerCond.notify_one();
+  }
+
+
+  template <typename Key>
+  D3D9FFShader D3D9FFShaderModuleSet::LookupShaderModule(
+          ModuleMap<Key>&       Map,
+    const Key&                  ShaderKey) {
+    std::unique_lock lock(m_mutex);
+
+    auto entry = Map.find(ShaderKey);
+
+    if (likely(entry != Map.end() && entry->second))
+      return *entry->second;
+
+    m_stallCount += 1;
+
+    // Other threads may insert into the map while the lock is
+    // released, which can invalidate iterators on rehash, but
+    // pointers to the mapped values remain valid.
+    auto* slot = entry != Map.end() ? &entry->second : nullptr;
+
+    if (!slot) {
+      // The shader was never queued, compile it on the
+      // calling thread instead of going through a worker.
+      slot = &Map.emplace(std::piecewise_construct,
+        std::forward_as_tuple(ShaderKey),
+        std::forward_as_tuple()).first->second;
+
+      m_pendingCount += 1;
+
+      lock.unlock();
+      CompileShaderModule(Map, ShaderKey, false);
+      lock.lock();
+    }
+
+    m_readyCond.wait(lock, [slot] {
+      return slot->has_value();
+    });
+
+    return **slot;
+  }
+
+
+  template <typename Key>
+  void D3D9FFShaderModuleSet::CompileShaderModule(
+          ModuleMap<Key>&       Map,
+    const Key&                  ShaderKey,
+          bool                  IsCached) {
+    D3D9FFShader shader(m_device, ShaderKey);
+
+    { std::unique_lock lock(m_mutex);
+      Map.find(ShaderKey)->second = shader;
+      m_pendingCount -= 1;
+      m_readyCond.notify_all();
+    }
+
+    if (!IsCached) {
+      constexpr VkShaderStageFlagBits stage = std::is_same_v<Key, D3D9FFShaderKeyVS>
+        ? VK_SHADER_STAGE_VERTEX_BIT
+        : VK_SHADER_STAGE_FRAGMENT_BIT;
+
+      WriteCacheEntry(stage == VK_SHADER_STAGE_VERTEX_BIT, &ShaderKey, sizeof(ShaderKey));
+    }
+  }
+
+
+  void D3D9FFShaderModuleSet::StartWorkers() {
+    if (m_workersRunning)
+      return;
+
+    m_workersRunning = true;
+
+    // Fixed-function shaders are cheap to generate compared to
+    // pipelines, so a small number of workers is sufficient.
+    uint32_t workerCount = dxvk::thread::hardware_concurrency() / 4u;
+    workerCount = std::max(1u, std::min(workerCount, 4u));
+
+    m_workers.reserve(workerCount);
+
+    for (uint32_t i = 0; i < workerCount; i++) {
+      auto& worker = m_workers.emplace_back([this] { RunWorker(); });
+      worker.set_priority(ThreadPriority::Lowest);
+    }
+  }
+
+
+  void D3D9FFShaderModuleSet::RunWorker() {
+    env::setThreadName("dxvk-ff-shader");
+
+    while (true) {
+      WorkItem item;
+
+      { std::unique_lock lock(m_mutex);
+
+        m_workerCond.wait(lock, [this] {
+          return !m_workQueue.empty() || !m_workersRunning;
+        });
+
+        if (!m_workersRunning)
+          break;
+
+        item = m_workQueue.front();
+        m_workQueue.pop();
+      }
+
+      if (item.isVS)
+        CompileShaderModule(m_vsModules, item.keyVS, item.isCached);
+      else
+        CompileShaderModule(m_fsModules, item.keyFS, item.isCached);
+    }
+  }
+
+
+  void D3D9FFShaderModuleSet::WriteCacheEntry(
+          bool                  IsVS,
+    const void*                 pKeyData,
+          size_t                KeySize) {
+    std::unique_lock lock(m_cacheMutex);
+
+    if (!m_cacheEnabled || !m_cacheFile)
+      return;
+
+    D3D9FFKeyCacheEntryHeader entry;
+    entry.stage = IsVS ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+    entry.hash  = Sha1Hash::compute(pKeyData, KeySize);
+
+    m_cacheFile.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    m_cacheFile.write(reinterpret_cast<const char*>(pKeyData), KeySize);
+    m_cacheFile.flush();
+  }
+
+
+  str::path_string D3D9FFShaderModuleSet::GetCacheFileName() const {
+    std::string path = env::getEnvVar("DXVK_STATE_CACHE_PATH");
 
-    m_fsModules.insert({ShaderKey, shader});
+    if (!path.empty() && *path.rbegin() != '/')
+      path += '/';
 
-    return shader;
+    path += env::getExeBaseName() + ".dxvk-ffcache";
+    return str::topath(path.c_str());
   }
 
 
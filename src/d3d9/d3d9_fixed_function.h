@@ -8,8 +8,11 @@
 
 #include "../dxso/dxso_isgn.h"
 
-#include <unordered_map>
 #include <bitset>
+#include <fstream>
+#include <optional>
+#include <queue>
+#include <unordered_map>
 
 namespace dxvk {
 
@@ -17,6 +20,7 @@ namespace dxvk {
   class SpirvModule;
 
   struct D3D9Options;
+  struct D3D9FixedFunctionPS;
   class D3D9ShaderSpecConstantManager;
 
   struct D3D9FogContext {
@@ -205,6 +209,24 @@ namespace dxvk {
     bool operator () (const D3D9FFShaderKeyFS& a, const D3D9FFShaderKeyFS& b) const;
   };
 
+  /**
+   * \brief Fixed-function pixel ubershader
+   *
+   * Evaluates texture stage state at runtime instead of
+   * baking it into the shader, see \ref D3D9FFUberStageFlags.
+   */
+  struct D3D9FFUbershaderFS { };
+
+  /**
+   * \brief Packs texture stage state for the ubershader
+   *
+   * \param [in] Key Fixed-function pixel shader key
+   * \param [out] pData Constant buffer data
+   */
+  void PackFixedFunctionUberStages(
+    const D3D9FFShaderKeyFS&    Key,
+          D3D9FixedFunctionPS*  pData);
+
   class D3D9FFShader {
 
   public:
@@ -217,6 +239,10 @@ namespace dxvk {
             D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyFS&    Key);
 
+    D3D9FFShader(
+            D3D9DeviceEx*         pDevice,
+      const D3D9FFUbershaderFS&   Key);
+
     template <typename T>
     void Dump(D3D9DeviceEx* pDevice, const T& Key, const std::string& Name);
 
@@ -233,29 +259,179 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Fixed-function shader statistics
+   */
+  struct D3D9FFShaderStats {
+    uint32_t shaderCount;
+    uint32_t pendingCount;
+    uint64_t stallCount;
+  };
+
+
+  /**
+   * \brief Fixed-function shader module set
+   *
+   * Generates fixed-function shaders on worker threads as soon
+   * as the application sets up the state that requires them,
+   * so that the CS thread only has to wait for shaders that
+   * have not finished compiling by the time they get bound.
+   *
+   * All keys are also written to a per-app key cache so that
+   * shaders used in a previous run can be generated ahead of
+   * time when the device gets created.
+   */
   class D3D9FFShaderModuleSet : public RcObject {
 
   public:
 
+    D3D9FFShaderModuleSet(
+            D3D9DeviceEx*         pDevice);
+
+    ~D3D9FFShaderModuleSet();
+
+    /**
+     * \brief Starts generating a shader
+     *
+     * Queues the shader for compilation on a worker thread
+     * unless it is already available or being compiled.
+     * \param [in] ShaderKey Fixed-function shader key
+     */
+    void PrecompileShaderModule(
+      const D3D9FFShaderKeyVS&    ShaderKey);
+
+    void PrecompileShaderModule(
+      const D3D9FFShaderKeyFS&    ShaderKey);
+
+    /**
+     * \brief Retrieves a shader
+     *
+     * Waits for the shader to become available if it is
+     * still being compiled, and compiles it on the calling
+     * thread if it has not been queued yet. Both cases
+     * count as a stall.
+     * \param [in] ShaderKey Fixed-function shader key
+     * \returns The fixed-function shader
+     */
     D3D9FFShader GetShaderModule(
-            D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyVS&    ShaderKey);
 
     D3D9FFShader GetShaderModule(
-            D3D9DeviceEx*         pDevice,
       const D3D9FFShaderKeyFS&    ShaderKey);
 
+    /**
+     * \brief Checks whether a shader is available
+     *
+     * \param [in] ShaderKey Fixed-function shader key
+     * \returns \c true if the shader can be retrieved
+     *    without waiting for a worker thread
+     */
+    bool IsShaderModuleReady(
+      const D3D9FFShaderKeyFS&    ShaderKey) const;
+
+    /**
+     * \brief Creates the pixel ubershader
+     *
+     * Must be called before \ref GetUbershaderFS.
+     */
+    void CreateUbershaders();
+
+    /**
+     * \brief Retrieves the pixel ubershader
+     *
+     * Used in place of specialized pixel shaders
+     * until they become available.
+     * \returns The fixed-function pixel ubershader
+     */
+    D3D9FFShader GetUbershaderFS() const {
+      return *m_ubershaderFS;
+    }
+
+    /**
+     * \brief Queues shaders from the key cache
+     *
+     * Reads all keys from the key cache file, if enabled,
+     * and queues the corresponding shaders for compilation.
+     */
+    void PrecompileCachedShaders();
+
+    /**
+     * \brief Queries shader statistics
+     * \returns Shader counts and number of stalls
+     */
+    D3D9FFShaderStats GetStats() const;
+
+    /**
+     * \brief Stops worker threads
+     *
+     * Pending work is discarded.
+     */
+    void StopWorkers();
+
   private:
 
-    std::unordered_map<
-      D3D9FFShaderKeyVS,
-      D3D9FFShader,
-      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq> m_vsModules;
+    struct WorkItem {
+      bool                isVS;
+      bool                isCached;
+      D3D9FFShaderKeyVS   keyVS;
+      D3D9FFShaderKeyFS   keyFS;
+    };
+
+    template <typename Key>
+    using ModuleMap = std::unordered_map<
+      Key, std::optional<D3D9FFShader>,
+      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq>;
+
+    D3D9DeviceEx*                 m_device;
+
+    mutable dxvk::mutex           m_mutex;
+    dxvk::condition_variable      m_readyCond;
+    dxvk::condition_variable      m_workerCond;
+
+    ModuleMap<D3D9FFShaderKeyVS>  m_vsModules;
+    ModuleMap<D3D9FFShaderKeyFS>  m_fsModules;
+
+    std::optional<D3D9FFShader>   m_ubershaderFS;
+
+    std::queue<WorkItem>          m_workQueue;
+    uint32_t                      m_pendingCount = 0;
+    uint64_t                      m_stallCount   = 0;
+
+    bool                          m_workersRunning = false;
+    bool                          m_workersStopped = false;
+    std::vector<dxvk::thread>     m_workers;
+
+    dxvk::mutex                   m_cacheMutex;
+    bool                          m_cacheEnabled = false;
+    std::ofstream                 m_cacheFile;
+
+    template <typename Key>
+    void QueueShaderModule(
+            ModuleMap<Key>&       Map,
+      const Key&                  ShaderKey,
+            bool                  IsCached);
+
+    template <typename Key>
+    D3D9FFShader LookupShaderModule(
+            ModuleMap<Key>&       Map,
+      const Key&                  ShaderKey);
+
+    template <typename Key>
+    void CompileShaderModule(
+            ModuleMap<Key>&       Map,
+      const Key&                  ShaderKey,
+            bool                  IsCached);
+
+    void StartWorkers();
+
+    void RunWorker();
+
+    void WriteCacheEntry(
+            bool                  IsVS,
+      const void*                 pKeyData,
+            size_t                KeySize);
 
-    std::unordered_map<
-      D3D9FFShaderKeyFS,
-      D3D9FFShader,
-      D3D9FFShaderKeyHash, D3D9FFShaderKeyEq> m_fsModules;
+    str::path_string GetCacheFileName() const;
 
   };
 
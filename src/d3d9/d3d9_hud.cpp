@@ -33,6 +33,56 @@ namespace dxvk::hud {
     return position;
   }
 
+
+  HudFixedFunctionShaders::HudFixedFunctionShaders(D3D9DeviceEx* device)
+    : m_device       (device)
+    , m_shaderString ("0")
+    , m_stallString  ("0") {
+
+  }
+
+
+  void HudFixedFunctionShaders::update(dxvk::high_resolution_clock::time_point time) {
+    D3D9FFShaderStats stats = m_device->GetFFShaderStats();
+
+    m_shaderString = stats.pendingCount
+      ? str::format(stats.shaderCount, " (", stats.pendingCount, " pending)")
+      : str::format(stats.shaderCount);
+    m_stallString = str::format(stats.stallCount);
+  }
+
+
+  HudPos HudFixedFunctionShaders::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.0f, 1.0f, 0.75f, 1.0f },
+      "FF shaders:");
+
+    renderer.drawText(16.0f,
+      { position.x + 120.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_shaderString);
+
+    position.y += 20.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.0f, 1.0f, 0.75f, 1.0f },
+      "FF stalls:");
+
+    renderer.drawText(16.0f,
+      { position.x + 120.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_stallString);
+
+    position.y += 8.0f;
+    return position;
+  }
+
   HudTextureMemory::HudTextureMemory(D3D9DeviceEx* device)
           : m_device          (device)
           , m_allocatedString ("")
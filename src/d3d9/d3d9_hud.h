@@ -26,6 +26,30 @@ namespace dxvk::hud {
 
     std::string m_samplerCount;
 
+  };
+
+  /**
+   * \brief HUD item to display fixed-function shader stats
+   */
+  class HudFixedFunctionShaders : public HudItem {
+
+  public:
+
+    HudFixedFunctionShaders(D3D9DeviceEx* device);
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    D3D9DeviceEx* m_device;
+
+    std::string m_shaderString;
+    std::string m_stallString;
+
   };
 
     /**
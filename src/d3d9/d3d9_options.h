@@ -152,6 +152,14 @@ namespace dxvk {
 
     /// Enable emulation of device loss when a fullscreen app loses focus
     bool deviceLossOnFocusLoss;
+
+    /// Use a fixed-function pixel ubershader while specialized
+    /// fixed-function pixel shaders are being generated
+    bool ffUbershader;
+
+    /// Maximum number of vertices for which ProcessVertices
+    /// runs the vertex shader on the CPU instead of the GPU
+    int32_t swvpCpuVertexLimit;
   };
 
 }
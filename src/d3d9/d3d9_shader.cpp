@@ -6,24 +6,74 @@
 
 namespace dxvk {
 
-  D3D9CommonShader::D3D9CommonShader() {}
-
-  D3D9CommonShader::D3D9CommonShader(
+  D3D9CommonShaderFuture::D3D9CommonShaderFuture(
             D3D9DeviceEx*         pDevice,
             VkShaderStageFlagBits ShaderStage,
       const DxvkShaderKey&        Key,
       const DxsoModuleInfo*       pDxsoModuleInfo,
       const void*                 pShaderBytecode,
-      const DxsoAnalysisInfo&     AnalysisInfo,
-            DxsoModule*           pModule) {
-    const uint32_t bytecodeLength = AnalysisInfo.bytecodeByteLength;
+      const DxsoAnalysisInfo&     AnalysisInfo)
+  : m_device      ( pDevice ),
+    m_stage       ( ShaderStage ),
+    m_key         ( Key ),
+    m_moduleInfo  ( *pDxsoModuleInfo ),
+    m_analysis    ( AnalysisInfo ),
+    m_bytecode    ( reinterpret_cast<const char*>(pShaderBytecode),
+                    reinterpret_cast<const char*>(pShaderBytecode) + AnalysisInfo.bytecodeByteLength ) {
+
+  }
+
+
+  void D3D9CommonShaderFuture::Run() {
+    State expected = State::Pending;
+
+    if (!m_state.compare_exchange_strong(expected, State::Running, std::memory_order_acquire))
+      return;
+
+    // The bytecode is validated when the shader is created,
+    // so this can only fail on internal compiler errors.
+    try {
+      Translate();
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
+      m_data = D3D9CommonShaderData();
+    }
+
+    // The bytecode is no longer needed at this point
+    m_bytecode = std::vector<char>();
+    m_analysis = DxsoAnalysisInfo();
+
+    std::unique_lock lock(m_mutex);
+    m_state.store(State::Ready, std::memory_order_release);
+    m_cond.notify_all();
+  }
+
+
+  const D3D9CommonShaderData& D3D9CommonShaderFuture::Wait() {
+    // Translate the shader on the calling thread if no
+    // worker got to it yet rather than waiting for one
+    Run();
+
+    std::unique_lock lock(m_mutex);
+
+    m_cond.wait(lock, [this] {
+      return m_state.load(std::memory_order_acquire) == State::Ready;
+    });
+
+    return m_data;
+  }
 
-    const std::string name = Key.toString();
+
+  void D3D9CommonShaderFuture::Translate() {
+    const void*    pShaderBytecode = m_bytecode.data();
+    const uint32_t bytecodeLength  = m_analysis.bytecodeByteLength;
+
+    const std::string name = m_key.toString();
     Logger::debug(str::format("Compiling shader ", name));
     
     // If requested by the user, dump both the raw DXBC
     // shader and the compiled SPIR-V module to a file.
-    const std::string& dumpPath = pDevice->GetOptions()->shaderDumpPath;
+    const std::string& dumpPath = m_device->GetOptions()->shaderDumpPath;
     
     if (dumpPath.size() != 0) {
       DxsoReader reader(
@@ -47,41 +97,60 @@ namespace dxvk {
           blob->GetBufferSize());
       }
     }
+
+    DxsoReader reader(
+      reinterpret_cast<const char*>(pShaderBytecode));
+
+    DxsoModule module(reader);
     
     // Decide whether we need to create a pass-through
     // geometry shader for vertex shader stream output
 
-    const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
-      ? pDevice->GetVertexConstantLayout()
-      : pDevice->GetPixelConstantLayout();
-    m_shader       = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
-    m_isgn         = pModule->isgn();
-    m_usedSamplers = pModule->usedSamplers();
+    const D3D9ConstantLayout& constantLayout = m_stage == VK_SHADER_STAGE_VERTEX_BIT
+      ? m_device->GetVertexConstantLayout()
+      : m_device->GetPixelConstantLayout();
+    m_data.shader       = module.compile(m_moduleInfo, name, m_analysis, constantLayout);
+    m_data.isgn         = module.isgn();
+    m_data.usedSamplers = module.usedSamplers();
 
     // Shift up these sampler bits so we can just
     // do an or per-draw in the device.
     // We shift by 17 because 16 ps samplers + 1 dmap (tess)
-    if (ShaderStage == VK_SHADER_STAGE_VERTEX_BIT)
-      m_usedSamplers <<= caps::MaxTexturesPS + 1;
+    if (m_stage == VK_SHADER_STAGE_VERTEX_BIT)
+      m_data.usedSamplers <<= caps::MaxTexturesPS + 1;
 
-    m_usedRTs      = pModule->usedRTs();
+    m_data.usedRTs      = module.usedRTs();
 
-    m_info      = pModule->info();
-    m_meta      = pModule->meta();
-    m_constants = pModule->constants();
-    m_maxDefinedConst = pModule->maxDefinedConstant();
+    m_data.info      = module.info();
+    m_data.meta      = module.meta();
+    m_data.constants = module.constants();
+    m_data.maxDefinedConst = module.maxDefinedConstant();
 
-    m_shader->setShaderKey(Key);
+    m_data.shader->setShaderKey(m_key);
 
     if (dumpPath.size() != 0) {
       std::ofstream dumpStream(
         str::topath(str::format(dumpPath, "/", name, ".spv").c_str()).c_str(),
         std::ios_base::binary | std::ios_base::trunc);
       
-      m_shader->dump(dumpStream);
+      m_data.shader->dump(dumpStream);
     }
 
-    pDevice->GetDXVKDevice()->registerShader(m_shader);
+    m_device->GetDXVKDevice()->registerShader(m_data.shader);
+  }
+
+
+  D3D9CommonShader::D3D9CommonShader() {}
+
+  D3D9CommonShader::D3D9CommonShader(
+          Rc<D3D9CommonShaderFuture> Future)
+  : m_future(std::move(Future)) {
+
+  }
+
+
+  D3D9ShaderModuleSet::~D3D9ShaderModuleSet() {
+    this->StopWorkers();
   }
 
 
@@ -110,33 +179,102 @@ namespace dxvk {
       ShaderStage,
       Sha1Hash::compute(pShaderBytecode, info.bytecodeByteLength));
 
-    // Use the shader's unique key for the lookup
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
+    // Use the shader's unique key for the lookup. If the shader
+    // is not known yet, queue it for translation and return a
+    // shader object that only blocks once its data is needed.
+    Rc<D3D9CommonShaderFuture> future;
+
+    { auto& bucket = m_buckets[lookupKey.hash() % BucketCount];
+      std::unique_lock<dxvk::mutex> lock(bucket.mutex);
       
-      auto entry = m_modules.find(lookupKey);
-      if (entry != m_modules.end()) {
+      auto entry = bucket.modules.find(lookupKey);
+      if (entry != bucket.modules.end()) {
         *pShaderModule = entry->second;
         return;
       }
+
+      future = new D3D9CommonShaderFuture(
+        pDevice, ShaderStage, lookupKey,
+        pDxbcModuleInfo, pShaderBytecode, info);
+
+      *pShaderModule = D3D9CommonShader(future);
+      bucket.modules.insert({ lookupKey, *pShaderModule });
     }
-    
-    // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    *pShaderModule = D3D9CommonShader(
-      pDevice, ShaderStage, lookupKey,
-      pDxbcModuleInfo, pShaderBytecode,
-      info, &module);
-    
-    // Insert the new module into the lookup table. If another thread
-    // has compiled the same shader in the meantime, we should return
-    // that object instead and discard the newly created module.
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      
-      auto status = m_modules.insert({ lookupKey, *pShaderModule });
-      if (!status.second) {
-        *pShaderModule = status.first->second;
+
+    QueueShaderModule(std::move(future));
+  }
+
+
+  void D3D9ShaderModuleSet::StopWorkers() {
+    { std::unique_lock lock(m_workerMutex);
+
+      if (!m_workersRunning)
         return;
+
+      m_workersRunning = false;
+      m_workersStopped = true;
+      m_workerCond.notify_all();
+    }
+
+    for (auto& worker : m_workers)
+      worker.join();
+
+    m_workers.clear();
+  }
+
+
+  void D3D9ShaderModuleSet::QueueShaderModule(
+          Rc<D3D9CommonShaderFuture> Future) {
+    std::unique_lock lock(m_workerMutex);
+
+    if (m_workersStopped)
+      return;
+
+    m_workQueue.push(std::move(Future));
+
+    StartWorkers();
+    m_workerCond.notify_one();
+  }
+
+
+  void D3D9ShaderModuleSet::StartWorkers() {
+    if (m_workersRunning)
+      return;
+
+    m_workersRunning = true;
+
+    // Leave some room for the application's own threads,
+    // as well as our CS thread and pipeline compilers
+    uint32_t workerCount = dxvk::thread::hardware_concurrency() / 2u;
+    workerCount = std::max(1u, std::min(workerCount, 8u));
+
+    m_workers.reserve(workerCount);
+
+    for (uint32_t i = 0; i < workerCount; i++)
+      m_workers.emplace_back([this] { RunWorker(); });
+  }
+
+
+  void D3D9ShaderModuleSet::RunWorker() {
+    env::setThreadName("dxvk-shader-d3d9");
+
+    while (true) {
+      Rc<D3D9CommonShaderFuture> future;
+
+      { std::unique_lock lock(m_workerMutex);
+
+        m_workerCond.wait(lock, [this] {
+          return !m_workQueue.empty() || !m_workersRunning;
+        });
+
+        if (!m_workersRunning)
+          break;
+
+        future = std::move(m_workQueue.front());
+        m_workQueue.pop();
       }
+
+      future->Run();
     }
   }
 
@@ -6,16 +6,111 @@
 #include "d3d9_mem.h"
 
 #include <array>
+#include <atomic>
+#include <queue>
 
 namespace dxvk {
 
 
+  /**
+   * \brief Translated shader data
+   *
+   * Everything we know about a shader once the
+   * DXSO bytecode has been translated to SPIR-V.
+   */
+  struct D3D9CommonShaderData {
+    DxsoIsgn              isgn;
+    uint32_t              usedSamplers = 0;
+    uint32_t              usedRTs      = 0;
+
+    DxsoProgramInfo       info;
+    DxsoShaderMetaInfo    meta;
+    DxsoDefinedConstants  constants;
+    uint32_t              maxDefinedConst = 0;
+
+    Rc<DxvkShader>        shader;
+  };
+
+
+  /**
+   * \brief Pending shader translation
+   *
+   * Holds a copy of the shader bytecode until the shader
+   * has been translated, either by a worker thread or by
+   * whichever thread needs the result first.
+   */
+  class D3D9CommonShaderFuture : public RcObject {
+
+  public:
+
+    D3D9CommonShaderFuture(
+            D3D9DeviceEx*         pDevice,
+            VkShaderStageFlagBits ShaderStage,
+      const DxvkShaderKey&        Key,
+      const DxsoModuleInfo*       pDxsoModuleInfo,
+      const void*                 pShaderBytecode,
+      const DxsoAnalysisInfo&     AnalysisInfo);
+
+    /**
+     * \brief Retrieves translated shader
+     *
+     * Translates the shader on the calling thread if no
+     * worker has picked it up yet, or waits for the worker
+     * to finish otherwise.
+     * \returns Translated shader data
+     */
+    const D3D9CommonShaderData& Get() {
+      if (likely(m_state.load(std::memory_order_acquire) == State::Ready))
+        return m_data;
+
+      return Wait();
+    }
+
+    /**
+     * \brief Translates the shader
+     *
+     * Does nothing if another thread already
+     * started translating the shader.
+     */
+    void Run();
+
+  private:
+
+    enum class State : uint32_t {
+      Pending,
+      Running,
+      Ready,
+    };
+
+    std::atomic<State>        m_state = { State::Pending };
+
+    dxvk::mutex               m_mutex;
+    dxvk::condition_variable  m_cond;
+
+    D3D9DeviceEx*             m_device;
+    VkShaderStageFlagBits     m_stage;
+    DxvkShaderKey             m_key;
+    DxsoModuleInfo            m_moduleInfo;
+    DxsoAnalysisInfo          m_analysis;
+    std::vector<char>         m_bytecode;
+
+    D3D9CommonShaderData      m_data;
+
+    const D3D9CommonShaderData& Wait();
+
+    void Translate();
+
+  };
+
+
   /**
    * \brief Common shader object
    * 
    * Stores the compiled SPIR-V shader and the SHA-1
    * hash of the original DXBC shader, which can be
-   * used to identify the shader.
+   * used to identify the shader. Translation happens
+   * asynchronously, so accessing any of the properties
+   * may block until the shader is ready.
    */
   class D3D9CommonShader {
 
@@ -24,48 +119,36 @@ namespace dxvk {
     D3D9CommonShader();
 
     D3D9CommonShader(
-            D3D9DeviceEx*         pDevice,
-            VkShaderStageFlagBits ShaderStage,
-      const DxvkShaderKey&        Key,
-      const DxsoModuleInfo*       pDxbcModuleInfo,
-      const void*                 pShaderBytecode,
-      const DxsoAnalysisInfo&     AnalysisInfo,
-            DxsoModule*           pModule);
-
+            Rc<D3D9CommonShaderFuture> Future);
 
     Rc<DxvkShader> GetShader() const {
-      return m_shader;
+      return GetData().shader;
     }
 
     std::string GetName() const {
-      return m_shader->debugName();
+      return GetData().shader->debugName();
     }
 
     const DxsoIsgn& GetIsgn() const {
-      return m_isgn;
+      return GetData().isgn;
     }
 
-    const DxsoShaderMetaInfo& GetMeta() const { return m_meta; }
-    const DxsoDefinedConstants& GetConstants() const { return m_constants; }
+    const DxsoShaderMetaInfo& GetMeta() const { return GetData().meta; }
+    const DxsoDefinedConstants& GetConstants() const { return GetData().constants; }
 
-    D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ m_usedSamplers, m_usedRTs }; }
+    D3D9ShaderMasks GetShaderMask() const { return D3D9ShaderMasks{ GetData().usedSamplers, GetData().usedRTs }; }
 
-    const DxsoProgramInfo& GetInfo() const { return m_info; }
+    const DxsoProgramInfo& GetInfo() const { return GetData().info; }
 
-    uint32_t GetMaxDefinedConstant() const { return m_maxDefinedConst; }
+    uint32_t GetMaxDefinedConstant() const { return GetData().maxDefinedConst; }
 
   private:
 
-    DxsoIsgn              m_isgn;
-    uint32_t              m_usedSamplers;
-    uint32_t              m_usedRTs;
+    Rc<D3D9CommonShaderFuture> m_future;
 
-    DxsoProgramInfo       m_info;
-    DxsoShaderMetaInfo    m_meta;
-    DxsoDefinedConstants  m_constants;
-    uint32_t              m_maxDefinedConst;
-
-    Rc<DxvkShader>        m_shader;
+    const D3D9CommonShaderData& GetData() const {
+      return m_future->Get();
+    }
 
   };
 
@@ -182,12 +265,17 @@ namespace dxvk {
    * 
    * Some applications may compile the same shader multiple
    * times, so we should cache the resulting shader modules
-   * and reuse them rather than creating new ones. This
-   * class is thread-safe.
+   * and reuse them rather than creating new ones. Shaders
+   * are translated on worker threads. This class is
+   * thread-safe, and the lookup table is split into
+   * multiple buckets so that threads creating different
+   * shaders do not contend on the same lock.
    */
   class D3D9ShaderModuleSet : public RcObject {
     
   public:
+
+    ~D3D9ShaderModuleSet();
     
     void GetShaderModule(
             D3D9DeviceEx*         pDevice,
@@ -196,15 +284,45 @@ namespace dxvk {
             VkShaderStageFlagBits ShaderStage,
       const DxsoModuleInfo*       pDxbcModuleInfo,
       const void*                 pShaderBytecode);
+
+    /**
+     * \brief Stops worker threads
+     *
+     * Shaders that have not been translated yet
+     * will be translated on first use instead.
+     */
+    void StopWorkers();
     
   private:
-    
-    dxvk::mutex m_mutex;
-    
-    std::unordered_map<
-      DxvkShaderKey,
-      D3D9CommonShader,
-      DxvkHash, DxvkEq> m_modules;
+
+    constexpr static uint32_t BucketCount = 16;
+
+    struct Bucket {
+      dxvk::mutex mutex;
+
+      std::unordered_map<
+        DxvkShaderKey,
+        D3D9CommonShader,
+        DxvkHash, DxvkEq> modules;
+    };
+
+    std::array<Bucket, BucketCount> m_buckets;
+
+    dxvk::mutex               m_workerMutex;
+    dxvk::condition_variable  m_workerCond;
+
+    std::queue<Rc<D3D9CommonShaderFuture>> m_workQueue;
+
+    bool                      m_workersRunning = false;
+    bool                      m_workersStopped = false;
+    std::vector<dxvk::thread> m_workers;
+
+    void QueueShaderModule(
+            Rc<D3D9CommonShaderFuture> Future);
+
+    void StartWorkers();
+
+    void RunWorker();
     
   };
 
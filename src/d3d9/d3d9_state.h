@@ -137,8 +137,29 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Packed texture stage state for the ubershader
+   *
+   * The x component stores the color and alpha ops, y and z
+   * store the color and alpha args respectively, using eight
+   * bits per op or arg. The w component stores stage flags.
+   */
+  enum D3D9FFUberStageFlags : uint32_t {
+    D3D9FFUberStage_Type           = 0, // 2 bits
+    D3D9FFUberStage_ResultIsTemp   = 2,
+    D3D9FFUberStage_Projected      = 3,
+    D3D9FFUberStage_ProjectedIdx   = 4, // 2 bits
+    D3D9FFUberStage_TextureBound   = 6,
+    D3D9FFUberStage_SampleTexture  = 7,
+    D3D9FFUberStage_PrevBump       = 8, // 2 bits
+    D3D9FFUberStage_GlobalSpecular = 10,
+  };
+
   struct D3D9FixedFunctionPS {
     Vector4 textureFactor;
+
+    // Only read by the ubershader
+    uint32_t uberStages[caps::TextureStageCount][4];
   };
 
   enum D3D9SharedPSStages {
@@ -82,6 +82,58 @@ namespace dxvk {
     }
   }
 
+  /**
+   * \brief Iterates over ranges of set bits
+   *
+   * Scans the bit set one dword at a time and calls
+   * \c fn once for every run of consecutive set bits,
+   * so that contiguous state can be applied at once.
+   * \param [in] mask Bit set to scan
+   * \param [in] fn Function taking the index of the
+   *    first bit and the number of bits in the run
+   */
+  template <size_t Bits, typename Fn>
+  void ForEachBitRange(bit::bitset<Bits>& mask, Fn&& fn) {
+    uint32_t start = 0;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < mask.dwordCount(); i++) {
+      uint32_t dword = mask.dword(i);
+      uint32_t index = 0;
+
+      while (index < 32) {
+        uint32_t bits = dword >> index;
+
+        if (!bits) {
+          if (count)
+            fn(start, std::exchange(count, 0u));
+          break;
+        }
+
+        uint32_t zeros = bit::tzcnt(bits);
+
+        if (zeros) {
+          if (count)
+            fn(start, std::exchange(count, 0u));
+
+          index += zeros;
+          bits >>= zeros;
+        }
+
+        uint32_t ones = bit::tzcnt(~bits);
+
+        if (!count)
+          start = i * 32 + index;
+
+        count += ones;
+        index += ones;
+      }
+    }
+
+    if (count)
+      fn(start, count);
+  }
+
   using D3D9StateBlockBase = D3D9DeviceChild<IDirect3DStateBlock9>;
   class D3D9StateBlock : public D3D9StateBlockBase {
 
@@ -262,21 +314,15 @@ namespace dxvk {
       }
 
       if (m_captures.flags.test(D3D9CapturedStateFlag::VsConstants)) {
-        for (uint32_t i = 0; i < m_captures.vsConsts.fConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.vsConsts.fConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
+        // Constants are usually captured in large contiguous
+        // blocks, set each block with a single call.
+        ForEachBitRange(m_captures.vsConsts.fConsts, [&] (uint32_t idx, uint32_t count) {
+          dst->SetVertexShaderConstantF(idx, (float*)&src->vsConsts->fConsts[idx], count);
+        });
 
-            dst->SetVertexShaderConstantF(idx, (float*)&src->vsConsts->fConsts[idx], 1);
-          }
-        }
-
-        for (uint32_t i = 0; i < m_captures.vsConsts.iConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.vsConsts.iConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetVertexShaderConstantI(idx, (int*)&src->vsConsts->iConsts[idx], 1);
-          }
-        }
+        ForEachBitRange(m_captures.vsConsts.iConsts, [&] (uint32_t idx, uint32_t count) {
+          dst->SetVertexShaderConstantI(idx, (int*)&src->vsConsts->iConsts[idx], count);
+        });
 
         if (m_captures.vsConsts.bConsts.any()) {
           for (uint32_t i = 0; i < m_captures.vsConsts.bConsts.dwordCount(); i++)
@@ -285,21 +331,13 @@ namespace dxvk {
       }
 
       if (m_captures.flags.test(D3D9CapturedStateFlag::PsConstants)) {
-        for (uint32_t i = 0; i < m_captures.psConsts.fConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.psConsts.fConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
+        ForEachBitRange(m_captures.psConsts.fConsts, [&] (uint32_t idx, uint32_t count) {
+          dst->SetPixelShaderConstantF(idx, (float*)&src->psConsts->fConsts[idx], count);
+        });
 
-            dst->SetPixelShaderConstantF(idx, (float*)&src->psConsts->fConsts[idx], 1);
-          }
-        }
-
-        for (uint32_t i = 0; i < m_captures.psConsts.iConsts.dwordCount(); i++) {
-          for (uint32_t consts : bit::BitMask(m_captures.psConsts.iConsts.dword(i))) {
-            uint32_t idx = i * 32 + consts;
-
-            dst->SetPixelShaderConstantI(idx, (int*)&src->psConsts->iConsts[idx], 1);
-          }
-        }
+        ForEachBitRange(m_captures.psConsts.iConsts, [&] (uint32_t idx, uint32_t count) {
+          dst->SetPixelShaderConstantI(idx, (int*)&src->psConsts->iConsts[idx], count);
+        });
 
         if (m_captures.psConsts.bConsts.any()) {
           for (uint32_t i = 0; i < m_captures.psConsts.bConsts.dwordCount(); i++)
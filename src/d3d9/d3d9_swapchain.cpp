@@ -110,6 +110,7 @@ namespace dxvk {
           HWND     hDestWindowOverride,
     const RGNDATA* pDirtyRegion,
           DWORD    dwFlags) {
+    DXVK_PROFILE_ZONE("api", "IDirect3DSwapChain9::Present");
     D3D9DeviceLock lock = m_parent->LockDevice();
 
     if (unlikely(m_parent->IsDeviceLost()))
@@ -802,8 +803,12 @@ namespace dxvk {
       SubmitPresent(sync, i);
     }
 
+    m_wctx->presenter->latencySleep(m_wctx->frameId);
+
     SyncFrameLatency();
 
+    m_wctx->presenter->beginFrame(m_wctx->frameId + 1);
+
     // Rotate swap chain buffers so that the back
     // buffer at index 0 becomes the front buffer.
     for (uint32_t i = 1; i < m_backBuffers.size(); i++)
@@ -1062,6 +1067,7 @@ namespace dxvk {
     if (m_hud != nullptr) {
       m_hud->addItem<hud::HudClientApiItem>("api", 1, GetApiName());
       m_hud->addItem<hud::HudSamplerCount>("samplers", -1, m_parent);
+      m_hud->addItem<hud::HudFixedFunctionShaders>("ffshaders", -1, m_parent);
 
 #ifdef D3D9_ALLOW_UNMAPPING
       m_hud->addItem<hud::HudTextureMemory>("memory", -1, m_parent);
@@ -0,0 +1,1197 @@
+#include "d3d9_swvp_cpu.h"
+
+#include "d3d9_util.h"
+#include "d3d9_vertex_declaration.h"
+
+#include "../dxso/dxso_code.h"
+#include "../dxso/dxso_header.h"
+#include "../dxso/dxso_reader.h"
+
+#include "../util/util_bit.h"
+
+#include <cfloat>
+#include <cmath>
+
+namespace dxvk {
+
+#ifdef DXVK_ARCH_X86
+  using SwvpLane = __m128;
+
+  static inline SwvpLane LaneSet(float v) { return _mm_set1_ps(v); }
+  static inline SwvpLane LaneLoad(const float* p) { return _mm_loadu_ps(p); }
+  static inline void     LaneStore(float* p, SwvpLane v) { _mm_storeu_ps(p, v); }
+
+  static inline SwvpLane LaneAdd(SwvpLane a, SwvpLane b) { return _mm_add_ps(a, b); }
+  static inline SwvpLane LaneSub(SwvpLane a, SwvpLane b) { return _mm_sub_ps(a, b); }
+  static inline SwvpLane LaneMulRaw(SwvpLane a, SwvpLane b) { return _mm_mul_ps(a, b); }
+  static inline SwvpLane LaneDiv(SwvpLane a, SwvpLane b) { return _mm_div_ps(a, b); }
+  static inline SwvpLane LaneMin(SwvpLane a, SwvpLane b) { return _mm_min_ps(a, b); }
+  static inline SwvpLane LaneMax(SwvpLane a, SwvpLane b) { return _mm_max_ps(a, b); }
+  static inline SwvpLane LaneSqrt(SwvpLane a) { return _mm_sqrt_ps(a); }
+  static inline SwvpLane LaneAbs(SwvpLane a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+  static inline SwvpLane LaneNeg(SwvpLane a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+
+  // D3D9 multiplication, 0 * x is 0 even if x is inf or nan
+  static inline SwvpLane LaneMulZero(SwvpLane a, SwvpLane b) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 mask = _mm_or_ps(_mm_cmpeq_ps(a, zero), _mm_cmpeq_ps(b, zero));
+    return _mm_andnot_ps(mask, _mm_mul_ps(a, b));
+  }
+
+  static inline SwvpLane LaneLt(SwvpLane a, SwvpLane b) { return _mm_and_ps(_mm_cmplt_ps(a, b), _mm_set1_ps(1.0f)); }
+  static inline SwvpLane LaneGe(SwvpLane a, SwvpLane b) { return _mm_and_ps(_mm_cmpge_ps(a, b), _mm_set1_ps(1.0f)); }
+#else
+  struct SwvpLane { float v[4]; };
+
+  template<typename Fn>
+  static inline SwvpLane LaneOp(SwvpLane a, SwvpLane b, Fn fn) {
+    SwvpLane r;
+    for (uint32_t i = 0; i < 4; i++)
+      r.v[i] = fn(a.v[i], b.v[i]);
+    return r;
+  }
+
+  static inline SwvpLane LaneSet(float v) { return SwvpLane { { v, v, v, v } }; }
+  static inline SwvpLane LaneLoad(const float* p) { SwvpLane r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+  static inline void     LaneStore(float* p, SwvpLane v) { std::memcpy(p, v.v, sizeof(v.v)); }
+
+  static inline SwvpLane LaneAdd(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x + y; }); }
+  static inline SwvpLane LaneSub(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x - y; }); }
+  static inline SwvpLane LaneMulRaw(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x * y; }); }
+  static inline SwvpLane LaneDiv(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x / y; }); }
+  static inline SwvpLane LaneMin(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x < y ? x : y; }); }
+  static inline SwvpLane LaneMax(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x > y ? x : y; }); }
+  static inline SwvpLane LaneSqrt(SwvpLane a) { return LaneOp(a, a, [] (float x, float) { return std::sqrt(x); }); }
+  static inline SwvpLane LaneAbs(SwvpLane a) { return LaneOp(a, a, [] (float x, float) { return std::abs(x); }); }
+  static inline SwvpLane LaneNeg(SwvpLane a) { return LaneOp(a, a, [] (float x, float) { return -x; }); }
+
+  // D3D9 multiplication, 0 * x is 0 even if x is inf or nan
+  static inline SwvpLane LaneMulZero(SwvpLane a, SwvpLane b) {
+    return LaneOp(a, b, [] (float x, float y) { return (x == 0.0f || y == 0.0f) ? 0.0f : x * y; });
+  }
+
+  static inline SwvpLane LaneLt(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x <  y ? 1.0f : 0.0f; }); }
+  static inline SwvpLane LaneGe(SwvpLane a, SwvpLane b) { return LaneOp(a, b, [] (float x, float y) { return x >= y ? 1.0f : 0.0f; }); }
+#endif
+
+  template<typename Fn>
+  static inline SwvpLane LaneMap(SwvpLane a, Fn fn) {
+    alignas(16) float v[4];
+    LaneStore(v, a);
+
+    for (uint32_t i = 0; i < 4; i++)
+      v[i] = fn(v[i]);
+
+    return LaneLoad(v);
+  }
+
+  template<typename Fn>
+  static inline SwvpLane LaneMap(SwvpLane a, SwvpLane b, Fn fn) {
+    alignas(16) float v[4];
+    alignas(16) float w[4];
+    LaneStore(v, a);
+    LaneStore(w, b);
+
+    for (uint32_t i = 0; i < 4; i++)
+      v[i] = fn(v[i], w[i]);
+
+    return LaneLoad(v);
+  }
+
+  static inline SwvpLane LaneFloor(SwvpLane a) {
+    return LaneMap(a, [] (float x) { return std::floor(x); });
+  }
+
+  static inline SwvpLane LaneSaturate(SwvpLane a) {
+    return LaneMin(LaneMax(a, LaneSet(0.0f)), LaneSet(1.0f));
+  }
+
+
+  /**
+   * \brief Register value for four vertices
+   *
+   * Each component holds the
+   * value for all four vertices.
+   */
+  struct SwvpVec {
+    SwvpLane c[4];
+  };
+
+  static inline SwvpVec VecSet(float x, float y, float z, float w) {
+    return SwvpVec { { LaneSet(x), LaneSet(y), LaneSet(z), LaneSet(w) } };
+  }
+
+  static inline SwvpVec VecReplicate(SwvpLane a) {
+    return SwvpVec { { a, a, a, a } };
+  }
+
+
+  static inline float ClampF(float v, float lo, float hi) {
+    // Also maps nan to the lower bound
+    return v >= lo ? (v <= hi ? v : hi) : lo;
+  }
+
+
+  static float HalfToFloat(uint16_t h) {
+    uint32_t exp  = (h >> 10) & 0x1f;
+    uint32_t mant = (h & 0x3ff);
+    float    v;
+
+    if (exp == 0)
+      v = std::ldexp(float(mant), -24);
+    else if (exp == 31)
+      v = mant ? NAN : INFINITY;
+    else
+      v = std::ldexp(float(mant | 0x400), int32_t(exp) - 25);
+
+    return (h & 0x8000) ? -v : v;
+  }
+
+
+  static uint16_t FloatToHalf(float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t mant = bits & 0x7fffff;
+    int32_t  exp  = int32_t((bits >> 23) & 0xff) - 127 + 15;
+
+    if (((bits >> 23) & 0xff) == 0xff)
+      return sign | 0x7c00 | (mant ? 0x200 : 0);
+
+    if (exp >= 31)
+      return sign | 0x7c00;
+
+    if (exp <= 0) {
+      if (exp < -10)
+        return sign;
+
+      mant |= 0x800000;
+
+      uint32_t shift = uint32_t(14 - exp);
+      uint32_t half  = mant >> shift;
+      uint32_t rem   = mant & ((1u << shift) - 1);
+      uint32_t mid   = 1u << (shift - 1);
+
+      if (rem > mid || (rem == mid && (half & 1)))
+        half++;
+
+      return sign | half;
+    }
+
+    uint32_t half = (uint32_t(exp) << 10) | (mant >> 13);
+    uint32_t rem  = mant & 0x1fff;
+
+    // Carries into the exponent as needed
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1)))
+      half++;
+
+    return sign | half;
+  }
+
+
+  template<typename T>
+  static inline T ReadElement(const uint8_t* pData, uint32_t Index) {
+    T value;
+    std::memcpy(&value, pData + Index * sizeof(T), sizeof(T));
+    return value;
+  }
+
+
+  template<typename T>
+  static inline void WriteElement(uint8_t* pData, uint32_t Index, T Value) {
+    std::memcpy(pData + Index * sizeof(T), &Value, sizeof(T));
+  }
+
+
+  static void DecodeElement(D3DDECLTYPE Type, const uint8_t* pData, float* pValue) {
+    switch (Type) {
+      case D3DDECLTYPE_FLOAT4: pValue[3] = ReadElement<float>(pData, 3); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT3: pValue[2] = ReadElement<float>(pData, 2); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT2: pValue[1] = ReadElement<float>(pData, 1); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT1: pValue[0] = ReadElement<float>(pData, 0); break;
+
+      case D3DDECLTYPE_D3DCOLOR: {
+        uint32_t color = ReadElement<uint32_t>(pData, 0);
+        pValue[0] = float((color >> 16) & 0xff) / 255.0f;
+        pValue[1] = float((color >>  8) & 0xff) / 255.0f;
+        pValue[2] = float((color >>  0) & 0xff) / 255.0f;
+        pValue[3] = float((color >> 24) & 0xff) / 255.0f;
+      } break;
+
+      case D3DDECLTYPE_UBYTE4:
+      case D3DDECLTYPE_UBYTE4N: {
+        float scale = Type == D3DDECLTYPE_UBYTE4N ? 1.0f / 255.0f : 1.0f;
+
+        for (uint32_t i = 0; i < 4; i++)
+          pValue[i] = float(pData[i]) * scale;
+      } break;
+
+      case D3DDECLTYPE_SHORT2:
+      case D3DDECLTYPE_SHORT4:
+      case D3DDECLTYPE_SHORT2N:
+      case D3DDECLTYPE_SHORT4N: {
+        bool normalize = Type == D3DDECLTYPE_SHORT2N || Type == D3DDECLTYPE_SHORT4N;
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++) {
+          float value = float(ReadElement<int16_t>(pData, i));
+          pValue[i] = normalize ? std::max(value / 32767.0f, -1.0f) : value;
+        }
+      } break;
+
+      case D3DDECLTYPE_USHORT2N:
+      case D3DDECLTYPE_USHORT4N: {
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++)
+          pValue[i] = float(ReadElement<uint16_t>(pData, i)) / 65535.0f;
+      } break;
+
+      case D3DDECLTYPE_UDEC3:
+      case D3DDECLTYPE_DEC3N: {
+        uint32_t packed = ReadElement<uint32_t>(pData, 0);
+
+        for (uint32_t i = 0; i < 3; i++) {
+          uint32_t value = (packed >> (10 * i)) & 0x3ff;
+
+          if (Type == D3DDECLTYPE_DEC3N) {
+            int32_t signedValue = int32_t(value << 22) >> 22;
+            pValue[i] = std::max(float(signedValue) / 511.0f, -1.0f);
+          } else {
+            pValue[i] = float(value);
+          }
+        }
+      } break;
+
+      case D3DDECLTYPE_FLOAT16_2:
+      case D3DDECLTYPE_FLOAT16_4: {
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++)
+          pValue[i] = HalfToFloat(ReadElement<uint16_t>(pData, i));
+      } break;
+
+      default:
+        break;
+    }
+  }
+
+
+  static void EncodeElement(D3DDECLTYPE Type, const float* pValue, uint8_t* pData) {
+    switch (Type) {
+      case D3DDECLTYPE_FLOAT4: WriteElement<float>(pData, 3, pValue[3]); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT3: WriteElement<float>(pData, 2, pValue[2]); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT2: WriteElement<float>(pData, 1, pValue[1]); [[fallthrough]];
+      case D3DDECLTYPE_FLOAT1: WriteElement<float>(pData, 0, pValue[0]); break;
+
+      case D3DDECLTYPE_D3DCOLOR: {
+        auto unorm = [] (float v) { return uint32_t(ClampF(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+
+        WriteElement<uint32_t>(pData, 0,
+          (unorm(pValue[3]) << 24) | (unorm(pValue[0]) << 16) |
+          (unorm(pValue[1]) <<  8) | (unorm(pValue[2]) <<  0));
+      } break;
+
+      case D3DDECLTYPE_UBYTE4:
+        for (uint32_t i = 0; i < 4; i++)
+          pData[i] = uint8_t(ClampF(pValue[i], 0.0f, 255.0f));
+        break;
+
+      case D3DDECLTYPE_UBYTE4N:
+        for (uint32_t i = 0; i < 4; i++)
+          pData[i] = uint8_t(ClampF(pValue[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+        break;
+
+      case D3DDECLTYPE_SHORT2:
+      case D3DDECLTYPE_SHORT4: {
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteElement<int16_t>(pData, i, int16_t(ClampF(pValue[i], -32768.0f, 32767.0f)));
+      } break;
+
+      case D3DDECLTYPE_SHORT2N:
+      case D3DDECLTYPE_SHORT4N: {
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteElement<int16_t>(pData, i, int16_t(std::lround(ClampF(pValue[i], -1.0f, 1.0f) * 32767.0f)));
+      } break;
+
+      case D3DDECLTYPE_USHORT2N:
+      case D3DDECLTYPE_USHORT4N: {
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteElement<uint16_t>(pData, i, uint16_t(ClampF(pValue[i], 0.0f, 1.0f) * 65535.0f + 0.5f));
+      } break;
+
+      case D3DDECLTYPE_UDEC3:
+      case D3DDECLTYPE_DEC3N: {
+        uint32_t packed = 0;
+
+        for (uint32_t i = 0; i < 3; i++) {
+          uint32_t value = Type == D3DDECLTYPE_DEC3N
+            ? uint32_t(std::lround(ClampF(pValue[i], -1.0f, 1.0f) * 511.0f))
+            : uint32_t(ClampF(pValue[i], 0.0f, 1023.0f));
+
+          packed |= (value & 0x3ff) << (10 * i);
+        }
+
+        WriteElement<uint32_t>(pData, 0, packed);
+      } break;
+
+      case D3DDECLTYPE_FLOAT16_2:
+      case D3DDECLTYPE_FLOAT16_4: {
+        uint32_t count = GetDecltypeCount(Type);
+
+        for (uint32_t i = 0; i < count; i++)
+          WriteElement<uint16_t>(pData, i, FloatToHalf(pValue[i]));
+      } break;
+
+      default:
+        break;
+    }
+  }
+
+
+  static uint32_t GetMatrixColumnCount(DxsoOpcode Opcode) {
+    switch (Opcode) {
+      case DxsoOpcode::M3x2: return 2;
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M4x3: return 3;
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M4x4: return 4;
+      default:               return 0;
+    }
+  }
+
+
+  static uint32_t GetSourceCount(DxsoOpcode Opcode) {
+    switch (Opcode) {
+      case DxsoOpcode::Mov:
+      case DxsoOpcode::Mova:
+      case DxsoOpcode::Rcp:
+      case DxsoOpcode::Rsq:
+      case DxsoOpcode::Exp:
+      case DxsoOpcode::ExpP:
+      case DxsoOpcode::Log:
+      case DxsoOpcode::LogP:
+      case DxsoOpcode::Frc:
+      case DxsoOpcode::Abs:
+      case DxsoOpcode::Sgn:
+      case DxsoOpcode::Nrm:
+      case DxsoOpcode::SinCos:
+      case DxsoOpcode::Lit:
+        return 1;
+
+      case DxsoOpcode::Add:
+      case DxsoOpcode::Sub:
+      case DxsoOpcode::Mul:
+      case DxsoOpcode::Dp3:
+      case DxsoOpcode::Dp4:
+      case DxsoOpcode::Min:
+      case DxsoOpcode::Max:
+      case DxsoOpcode::Slt:
+      case DxsoOpcode::Sge:
+      case DxsoOpcode::Pow:
+      case DxsoOpcode::Crs:
+      case DxsoOpcode::Dst:
+      case DxsoOpcode::M3x2:
+      case DxsoOpcode::M3x3:
+      case DxsoOpcode::M3x4:
+      case DxsoOpcode::M4x3:
+      case DxsoOpcode::M4x4:
+        return 2;
+
+      case DxsoOpcode::Mad:
+      case DxsoOpcode::Lrp:
+        return 3;
+
+      default:
+        // Not supported by the interpreter
+        return ~0u;
+    }
+  }
+
+
+  static bool IsSupportedSource(const DxsoRegister& Reg, uint32_t Range) {
+    if (Reg.modifier != DxsoRegModifier::None
+     && Reg.modifier != DxsoRegModifier::Neg
+     && Reg.modifier != DxsoRegModifier::Abs
+     && Reg.modifier != DxsoRegModifier::AbsNeg)
+      return false;
+
+    switch (Reg.id.type) {
+      case DxsoRegisterType::Temp:
+        return !Reg.hasRelative && Reg.id.num + Range <= DxsoMaxTempRegs;
+
+      case DxsoRegisterType::Input:
+        return !Reg.hasRelative && Reg.id.num + Range <= DxsoMaxInterfaceRegs;
+
+      case DxsoRegisterType::Const:
+        return !Reg.hasRelative || Reg.relative.id.type == DxsoRegisterType::Addr;
+
+      default:
+        return false;
+    }
+  }
+
+
+  static bool IsSupportedDestination(const DxsoRegister& Reg) {
+    if (Reg.hasRelative || Reg.shift != 0)
+      return false;
+
+    switch (Reg.id.type) {
+      case DxsoRegisterType::Temp:          return Reg.id.num < DxsoMaxTempRegs;
+      case DxsoRegisterType::Addr:          return Reg.id.num == 0;
+      case DxsoRegisterType::RasterizerOut: return Reg.id.num <= RasterOutPointSize;
+      case DxsoRegisterType::AttributeOut:  return Reg.id.num < 2;
+      case DxsoRegisterType::Output:        return Reg.id.num < DxsoMaxInterfaceRegs;
+      default:                              return false;
+    }
+  }
+
+
+  static std::unique_ptr<D3D9SWVPCpuProgram> DecodeProgram(const char* pBytecode) {
+    DxsoReader reader(pBytecode);
+    DxsoHeader header(reader);
+    DxsoCode   code(reader);
+
+    const DxsoProgramInfo& info = header.info();
+
+    if (info.type() != DxsoProgramTypes::VertexShader)
+      return nullptr;
+
+    auto program = std::make_unique<D3D9SWVPCpuProgram>();
+    program->majorVersion = info.majorVersion();
+    program->minorVersion = info.minorVersion();
+
+    DxsoDecodeContext decoder(info);
+    DxsoCodeIter iter = code.iter();
+
+    while (decoder.decodeInstruction(iter)) {
+      const DxsoInstructionContext& ctx = decoder.getInstructionContext();
+      const DxsoOpcode opcode = ctx.instruction.opcode;
+
+      switch (opcode) {
+        case DxsoOpcode::Nop:
+        case DxsoOpcode::Comment:
+        case DxsoOpcode::DefI:
+        case DxsoOpcode::DefB:
+          continue;
+
+        case DxsoOpcode::Dcl: {
+          uint32_t num = ctx.dst.id.num;
+
+          if (ctx.dst.id.type == DxsoRegisterType::Input && num < DxsoMaxInterfaceRegs) {
+            program->inputs[num] = ctx.dcl.semantic;
+            program->inputMask |= 1u << num;
+          } else if (ctx.dst.id.type == DxsoRegisterType::Output && num < DxsoMaxInterfaceRegs) {
+            program->outputs[num] = ctx.dcl.semantic;
+            program->outputMask |= 1u << num;
+          }
+        } continue;
+
+        case DxsoOpcode::Def: {
+          uint32_t num = ctx.dst.id.num;
+
+          if (num >= caps::MaxFloatConstantsSoftware)
+            return nullptr;
+
+          if (num >= program->defIndices.size())
+            program->defIndices.resize(num + 1, -1);
+
+          program->defIndices[num] = int32_t(program->defValues.size());
+          program->defValues.push_back(Vector4(
+            ctx.def.float32[0], ctx.def.float32[1],
+            ctx.def.float32[2], ctx.def.float32[3]));
+        } continue;
+
+        default:
+          break;
+      }
+
+      uint32_t srcCount = GetSourceCount(opcode);
+
+      if (srcCount == ~0u || ctx.instruction.predicated)
+        return nullptr;
+
+      if (!IsSupportedDestination(ctx.dst))
+        return nullptr;
+
+      for (uint32_t i = 0; i < srcCount; i++) {
+        uint32_t range = i == 1 ? std::max(GetMatrixColumnCount(opcode), 1u) : 1u;
+
+        if (!IsSupportedSource(ctx.src[i], range))
+          return nullptr;
+      }
+
+      if (program->majorVersion < 3) {
+        if (ctx.dst.id.type == DxsoRegisterType::AttributeOut)
+          program->colorMask |= 1u << ctx.dst.id.num;
+
+        if (ctx.dst.id.type == DxsoRegisterType::Output) {
+          program->outputs[ctx.dst.id.num] = DxsoSemantic { DxsoUsage::Texcoord, ctx.dst.id.num };
+          program->outputMask |= 1u << ctx.dst.id.num;
+        }
+      }
+
+      program->code.push_back(ctx);
+    }
+
+    return program;
+  }
+
+
+  /**
+   * \brief Interpreter state
+   *
+   * Holds the register file for one
+   * group of four vertices.
+   */
+  class D3D9SWVPCpuExecutor {
+
+  public:
+
+    D3D9SWVPCpuExecutor(
+      const D3D9SWVPCpuProgram&   Program,
+      const D3D9SWVPCpuArgs&      Args)
+    : m_program(Program), m_args(Args) {
+      for (uint32_t i = 0; i < DxsoMaxInterfaceRegs; i++) {
+        m_inputElements[i] = nullptr;
+
+        if (!(m_program.inputMask & (1u << i)))
+          continue;
+
+        for (const auto& element : m_args.srcDecl->GetElements()) {
+          if (DxsoSemantic { DxsoUsage(element.Usage), element.UsageIndex } == m_program.inputs[i]) {
+            m_inputElements[i] = &element;
+            break;
+          }
+        }
+      }
+
+      for (const auto& element : m_args.dstDecl->GetElements()) {
+        DxsoSemantic semantic = { DxsoUsage(element.Usage), element.UsageIndex };
+
+        if (semantic.usage == DxsoUsage::PositionT)
+          semantic.usage = DxsoUsage::Position;
+
+        OutputBinding binding;
+        binding.element  = &element;
+        binding.reg      = FindOutput(semantic);
+        binding.source   = nullptr;
+        binding.saturate = m_program.majorVersion < 3
+                        && semantic.usage == DxsoUsage::Color
+                        && semantic.usageIndex < 2;
+
+        // Elements that the shader does not write are copied from
+        // the source vertex unless D3DPV_DONOTCOPYDATA is set, and
+        // left untouched otherwise.
+        if (binding.reg == &m_zero) {
+          binding.source = m_args.copyData
+            ? FindSourceElement(element)
+            : nullptr;
+
+          if (binding.source == nullptr)
+            continue;
+        }
+
+        m_outputBindings.push_back(binding);
+      }
+    }
+
+    void Run(uint32_t FirstVertex, uint32_t VertexCount) {
+      ResetRegisters();
+      FetchInputs(FirstVertex, VertexCount);
+
+      for (const auto& ctx : m_program.code)
+        Execute(ctx);
+
+      WriteOutputs(FirstVertex, VertexCount);
+    }
+
+  private:
+
+    struct OutputBinding {
+      const D3DVERTEXELEMENT9*  element;
+      const SwvpVec*            reg;
+      const D3DVERTEXELEMENT9*  source;
+      bool                      saturate;
+    };
+
+    const D3D9SWVPCpuProgram& m_program;
+    const D3D9SWVPCpuArgs&    m_args;
+
+    std::array<SwvpVec, DxsoMaxTempRegs>      m_temps;
+    std::array<SwvpVec, DxsoMaxInterfaceRegs> m_inputs;
+    std::array<SwvpVec, DxsoMaxInterfaceRegs> m_outputs;
+    std::array<SwvpVec, 2>                    m_colors;
+
+    SwvpVec m_position;
+    SwvpVec m_fog;
+    SwvpVec m_pointSize;
+
+    SwvpVec m_zero = VecSet(0.0f, 0.0f, 0.0f, 0.0f);
+    SwvpVec m_one  = VecSet(1.0f, 1.0f, 1.0f, 1.0f);
+
+    int32_t m_addr[4][4];
+
+    std::array<const D3DVERTEXELEMENT9*, DxsoMaxInterfaceRegs> m_inputElements;
+    std::vector<OutputBinding>                                 m_outputBindings;
+
+    const SwvpVec* FindOutput(const DxsoSemantic& Semantic) const {
+      for (uint32_t i : bit::BitMask(m_program.outputMask)) {
+        if (m_program.outputs[i] == Semantic)
+          return &m_outputs[i];
+      }
+
+      if (Semantic == DxsoSemantic { DxsoUsage::Color, 0 } && m_program.majorVersion >= 3)
+        return &m_one;
+
+      if (m_program.majorVersion < 3) {
+        if (Semantic == DxsoSemantic { DxsoUsage::Position, 0 })
+          return &m_position;
+
+        if (Semantic == DxsoSemantic { DxsoUsage::Fog, 0 })
+          return &m_fog;
+
+        if (Semantic == DxsoSemantic { DxsoUsage::PointSize, 0 })
+          return &m_pointSize;
+
+        if (Semantic.usage == DxsoUsage::Color && Semantic.usageIndex < 2)
+          return &m_colors[Semantic.usageIndex];
+      }
+
+      return &m_zero;
+    }
+
+    const D3DVERTEXELEMENT9* FindSourceElement(const D3DVERTEXELEMENT9& Element) const {
+      for (const auto& element : m_args.srcDecl->GetElements()) {
+        if (element.Usage == Element.Usage && element.UsageIndex == Element.UsageIndex)
+          return &element;
+      }
+
+      return nullptr;
+    }
+
+    bool LoadElement(const D3DVERTEXELEMENT9& Element, uint32_t Vertex, float* pValue) const {
+      const D3D9SWVPCpuStream& stream = m_args.streams[Element.Stream];
+
+      size_t offset = size_t(stream.stride) * Vertex + Element.Offset;
+      size_t size   = GetDecltypeSize(D3DDECLTYPE(Element.Type));
+
+      if (stream.data == nullptr || offset + size > stream.size)
+        return false;
+
+      DecodeElement(D3DDECLTYPE(Element.Type), stream.data + offset, pValue);
+      return true;
+    }
+
+    void ResetRegisters() {
+      m_temps.fill(m_zero);
+      m_outputs.fill(m_zero);
+      m_colors.fill(m_zero);
+
+      // Color 0 defaults to white if the shader never writes it
+      if (!(m_program.colorMask & 1u))
+        m_colors[0] = m_one;
+
+      m_position  = m_zero;
+      m_fog       = m_one;
+      m_pointSize = VecReplicate(LaneSet(m_args.pointSize));
+
+      std::memset(m_addr, 0, sizeof(m_addr));
+    }
+
+    void FetchInputs(uint32_t FirstVertex, uint32_t VertexCount) {
+      for (uint32_t i : bit::BitMask(m_program.inputMask)) {
+        const D3DVERTEXELEMENT9* element = m_inputElements[i];
+
+        alignas(16) float values[4][4];
+
+        for (uint32_t j = 0; j < 4; j++) {
+          float value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+          if (element != nullptr && j < VertexCount)
+            LoadElement(*element, FirstVertex + j, value);
+
+          for (uint32_t k = 0; k < 4; k++)
+            values[k][j] = value[k];
+        }
+
+        for (uint32_t k = 0; k < 4; k++)
+          m_inputs[i].c[k] = LaneLoad(values[k]);
+      }
+    }
+
+    void WriteOutputs(uint32_t FirstVertex, uint32_t VertexCount) {
+      const uint32_t vertexSize = m_args.dstDecl->GetSize();
+
+      for (const auto& binding : m_outputBindings) {
+        if (binding.source != nullptr) {
+          for (uint32_t j = 0; j < VertexCount; j++) {
+            float value[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+            if (!LoadElement(*binding.source, FirstVertex + j, value))
+              continue;
+
+            uint8_t* dst = m_args.dstData
+              + size_t(vertexSize) * (FirstVertex + j)
+              + binding.element->Offset;
+
+            EncodeElement(D3DDECLTYPE(binding.element->Type), value, dst);
+          }
+
+          continue;
+        }
+
+        alignas(16) float values[4][4];
+
+        for (uint32_t k = 0; k < 4; k++) {
+          SwvpLane lane = binding.reg->c[k];
+
+          if (binding.saturate)
+            lane = LaneSaturate(lane);
+
+          LaneStore(values[k], lane);
+        }
+
+        for (uint32_t j = 0; j < VertexCount; j++) {
+          float value[4] = { values[0][j], values[1][j], values[2][j], values[3][j] };
+
+          uint8_t* dst = m_args.dstData
+            + size_t(vertexSize) * (FirstVertex + j)
+            + binding.element->Offset;
+
+          EncodeElement(D3DDECLTYPE(binding.element->Type), value, dst);
+        }
+      }
+    }
+
+    Vector4 LoadConstant(int32_t Index) const {
+      if (Index < 0 || uint32_t(Index) >= m_args.floatCount)
+        return Vector4(0.0f);
+
+      if (uint32_t(Index) < m_program.defIndices.size()) {
+        int32_t def = m_program.defIndices[Index];
+
+        if (def >= 0)
+          return m_program.defValues[def];
+      }
+
+      return m_args.constants->fConsts[Index];
+    }
+
+    SwvpVec LoadRegister(const DxsoRegister& Reg, uint32_t Offset) const {
+      uint32_t num = Reg.id.num + Offset;
+
+      switch (Reg.id.type) {
+        case DxsoRegisterType::Temp:
+          return m_temps[num];
+
+        case DxsoRegisterType::Input:
+          return m_inputs[num];
+
+        case DxsoRegisterType::Const: {
+          if (!Reg.hasRelative) {
+            Vector4 value = LoadConstant(int32_t(num));
+            return VecSet(value.x, value.y, value.z, value.w);
+          }
+
+          // Relative addressing, each vertex
+          // may read a different constant
+          const int32_t* addr = m_addr[Reg.relative.swizzle[0]];
+
+          alignas(16) float values[4][4];
+
+          for (uint32_t j = 0; j < 4; j++) {
+            Vector4 value = LoadConstant(int32_t(num) + addr[j]);
+
+            for (uint32_t k = 0; k < 4; k++)
+              values[k][j] = value[k];
+          }
+
+          SwvpVec result;
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneLoad(values[k]);
+
+          return result;
+        }
+
+        default:
+          return m_zero;
+      }
+    }
+
+    SwvpVec LoadSource(const DxsoRegister& Reg, uint32_t Offset = 0) const {
+      SwvpVec value = LoadRegister(Reg, Offset);
+      SwvpVec result;
+
+      for (uint32_t k = 0; k < 4; k++)
+        result.c[k] = value.c[Reg.swizzle[k]];
+
+      if (Reg.modifier == DxsoRegModifier::Abs
+       || Reg.modifier == DxsoRegModifier::AbsNeg) {
+        for (uint32_t k = 0; k < 4; k++)
+          result.c[k] = LaneAbs(result.c[k]);
+      }
+
+      if (Reg.modifier == DxsoRegModifier::Neg
+       || Reg.modifier == DxsoRegModifier::AbsNeg) {
+        for (uint32_t k = 0; k < 4; k++)
+          result.c[k] = LaneNeg(result.c[k]);
+      }
+
+      return result;
+    }
+
+    SwvpVec* GetDestination(const DxsoRegisterId& Id) {
+      switch (Id.type) {
+        case DxsoRegisterType::Temp:         return &m_temps[Id.num];
+        case DxsoRegisterType::AttributeOut: return &m_colors[Id.num];
+        case DxsoRegisterType::Output:       return &m_outputs[Id.num];
+
+        case DxsoRegisterType::RasterizerOut:
+          switch (Id.num) {
+            case RasterOutPosition:  return &m_position;
+            case RasterOutFog:       return &m_fog;
+            case RasterOutPointSize: return &m_pointSize;
+          }
+          [[fallthrough]];
+
+        default:
+          return nullptr;
+      }
+    }
+
+    void StoreDestination(const DxsoRegister& Reg, SwvpVec Value) {
+      DxsoRegMask mask = Reg.mask;
+
+      if (Reg.id.type == DxsoRegisterType::RasterizerOut && Reg.id.num != RasterOutPosition)
+        mask = DxsoRegMask(true, false, false, false);
+
+      if (Reg.saturate) {
+        for (uint32_t k = 0; k < 4; k++)
+          Value.c[k] = LaneSaturate(Value.c[k]);
+      }
+
+      if (Reg.id.type == DxsoRegisterType::Addr) {
+        // VS 1.1 and below floor, everything else rounds,
+        // matching what the shader compiler does.
+        bool floor = m_program.majorVersion < 2 && m_program.minorVersion < 2;
+
+        for (uint32_t k = 0; k < 4; k++) {
+          if (!mask[k])
+            continue;
+
+          SwvpLane lane = floor
+            ? LaneFloor(Value.c[k])
+            : LaneFloor(LaneAdd(Value.c[k], LaneSet(0.5f)));
+
+          alignas(16) float values[4];
+          LaneStore(values, lane);
+
+          for (uint32_t j = 0; j < 4; j++)
+            m_addr[k][j] = int32_t(ClampF(values[j], -16777216.0f, 16777216.0f));
+        }
+        return;
+      }
+
+      SwvpVec* dst = GetDestination(Reg.id);
+
+      for (uint32_t k = 0; k < 4; k++) {
+        if (mask[k])
+          dst->c[k] = Value.c[k];
+      }
+    }
+
+    // Match the float emulation mode used by the shader compiler,
+    // so that results are the same as on the GPU path
+    SwvpLane Mul(SwvpLane a, SwvpLane b) const {
+      return m_args.floatEmulation == D3D9FloatEmulation::Strict
+        ? LaneMulZero(a, b)
+        : LaneMulRaw(a, b);
+    }
+
+    SwvpLane Dot(const SwvpVec& a, const SwvpVec& b, uint32_t n) const {
+      SwvpLane result = Mul(a.c[0], b.c[0]);
+
+      for (uint32_t i = 1; i < n; i++)
+        result = LaneAdd(result, Mul(a.c[i], b.c[i]));
+
+      return result;
+    }
+
+    SwvpLane ClampFloat(SwvpLane a, float limit) const {
+      if (m_args.floatEmulation != D3D9FloatEmulation::Enabled)
+        return a;
+
+      return limit > 0.0f
+        ? LaneMin(a, LaneSet(limit))
+        : LaneMax(a, LaneSet(limit));
+    }
+
+    void Execute(const DxsoInstructionContext& ctx) {
+      const auto& src = ctx.src;
+
+      const SwvpLane zero = LaneSet(0.0f);
+      const SwvpLane one  = LaneSet(1.0f);
+
+      SwvpVec result;
+
+      switch (ctx.instruction.opcode) {
+        case DxsoOpcode::Mov:
+        case DxsoOpcode::Mova:
+          result = LoadSource(src[0]);
+          break;
+
+        case DxsoOpcode::Add:
+        case DxsoOpcode::Sub:
+        case DxsoOpcode::Mul:
+        case DxsoOpcode::Min:
+        case DxsoOpcode::Max:
+        case DxsoOpcode::Slt:
+        case DxsoOpcode::Sge: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpVec b = LoadSource(src[1]);
+
+          for (uint32_t k = 0; k < 4; k++) {
+            switch (ctx.instruction.opcode) {
+              case DxsoOpcode::Add: result.c[k] = LaneAdd(a.c[k], b.c[k]); break;
+              case DxsoOpcode::Sub: result.c[k] = LaneSub(a.c[k], b.c[k]); break;
+              case DxsoOpcode::Mul: result.c[k] = Mul(a.c[k], b.c[k]); break;
+              case DxsoOpcode::Min: result.c[k] = LaneMin(a.c[k], b.c[k]); break;
+              case DxsoOpcode::Max: result.c[k] = LaneMax(a.c[k], b.c[k]); break;
+              case DxsoOpcode::Slt: result.c[k] = LaneLt (a.c[k], b.c[k]); break;
+              default:              result.c[k] = LaneGe (a.c[k], b.c[k]); break;
+            }
+          }
+        } break;
+
+        case DxsoOpcode::Mad: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpVec b = LoadSource(src[1]);
+          SwvpVec c = LoadSource(src[2]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneAdd(Mul(a.c[k], b.c[k]), c.c[k]);
+        } break;
+
+        case DxsoOpcode::Rcp: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = ClampFloat(LaneDiv(one, a.c[k]), FLT_MAX);
+        } break;
+
+        case DxsoOpcode::Rsq: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = ClampFloat(LaneDiv(one, LaneSqrt(LaneAbs(a.c[k]))), FLT_MAX);
+        } break;
+
+        case DxsoOpcode::Dp3:
+          result = VecReplicate(Dot(LoadSource(src[0]), LoadSource(src[1]), 3));
+          break;
+
+        case DxsoOpcode::Dp4:
+          result = VecReplicate(Dot(LoadSource(src[0]), LoadSource(src[1]), 4));
+          break;
+
+        case DxsoOpcode::ExpP:
+          if (m_program.majorVersion < 2) {
+            SwvpLane x = LoadSource(src[0]).c[0];
+            SwvpLane f = LaneFloor(x);
+
+            result.c[0] = LaneMap(f, [] (float v) { return std::exp2(v); });
+            result.c[1] = LaneSub(x, f);
+            result.c[2] = LaneMap(x, [] (float v) { return std::exp2(v); });
+            result.c[3] = one;
+            break;
+          }
+          [[fallthrough]];
+
+        case DxsoOpcode::Exp: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneMap(a.c[k], [] (float v) { return std::exp2(v); });
+        } break;
+
+        case DxsoOpcode::Log:
+        case DxsoOpcode::LogP: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++) {
+            result.c[k] = LaneMap(LaneAbs(a.c[k]), [] (float v) { return std::log2(v); });
+            result.c[k] = ClampFloat(result.c[k], -FLT_MAX);
+          }
+        } break;
+
+        case DxsoOpcode::Pow: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpVec b = LoadSource(src[1]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneMap(LaneAbs(a.c[k]), b.c[k], [] (float x, float y) { return std::pow(x, y); });
+        } break;
+
+        case DxsoOpcode::Crs: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpVec b = LoadSource(src[1]);
+
+          result.c[0] = LaneSub(Mul(a.c[1], b.c[2]), Mul(a.c[2], b.c[1]));
+          result.c[1] = LaneSub(Mul(a.c[2], b.c[0]), Mul(a.c[0], b.c[2]));
+          result.c[2] = LaneSub(Mul(a.c[0], b.c[1]), Mul(a.c[1], b.c[0]));
+          result.c[3] = zero;
+        } break;
+
+        case DxsoOpcode::Abs: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneAbs(a.c[k]);
+        } break;
+
+        case DxsoOpcode::Sgn: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneSub(LaneLt(zero, a.c[k]), LaneLt(a.c[k], zero));
+        } break;
+
+        case DxsoOpcode::Nrm: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpLane dot = LaneAdd(LaneAdd(LaneMulRaw(a.c[0], a.c[0]),
+            LaneMulRaw(a.c[1], a.c[1])), LaneMulRaw(a.c[2], a.c[2]));
+          SwvpLane rcp = ClampFloat(LaneDiv(one, LaneSqrt(dot)), FLT_MAX);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = Mul(a.c[k], rcp);
+        } break;
+
+        case DxsoOpcode::SinCos: {
+          SwvpLane x = LoadSource(src[0]).c[0];
+
+          result.c[0] = LaneMap(x, [] (float v) { return std::cos(v); });
+          result.c[1] = LaneMap(x, [] (float v) { return std::sin(v); });
+          result.c[2] = zero;
+          result.c[3] = zero;
+        } break;
+
+        case DxsoOpcode::Lit: {
+          SwvpVec a = LoadSource(src[0]);
+
+          SwvpLane power = LaneMin(LaneMax(a.c[3], LaneSet(-127.9961f)), LaneSet(127.9961f));
+          SwvpLane test  = Mul(LaneGe(a.c[0], zero), LaneGe(a.c[1], zero));
+
+          result.c[0] = one;
+          result.c[1] = LaneMax(a.c[0], zero);
+          result.c[2] = LaneMap(LaneMax(a.c[1], zero), power, [] (float x, float y) { return std::pow(x, y); });
+          result.c[2] = Mul(result.c[2], test);
+          result.c[3] = one;
+        } break;
+
+        case DxsoOpcode::Dst: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpVec b = LoadSource(src[1]);
+
+          result.c[0] = one;
+          result.c[1] = Mul(a.c[1], b.c[1]);
+          result.c[2] = a.c[2];
+          result.c[3] = b.c[3];
+        } break;
+
+        case DxsoOpcode::Lrp: {
+          SwvpVec a = LoadSource(src[0]);
+          SwvpVec b = LoadSource(src[1]);
+          SwvpVec c = LoadSource(src[2]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneAdd(c.c[k], Mul(a.c[k], LaneSub(b.c[k], c.c[k])));
+        } break;
+
+        case DxsoOpcode::Frc: {
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = LaneSub(a.c[k], LaneFloor(a.c[k]));
+        } break;
+
+        case DxsoOpcode::M3x2:
+        case DxsoOpcode::M3x3:
+        case DxsoOpcode::M3x4:
+        case DxsoOpcode::M4x3:
+        case DxsoOpcode::M4x4: {
+          const DxsoOpcode opcode = ctx.instruction.opcode;
+          const uint32_t rows = (opcode == DxsoOpcode::M4x3 || opcode == DxsoOpcode::M4x4) ? 4 : 3;
+          const uint32_t cols = GetMatrixColumnCount(opcode);
+
+          SwvpVec a = LoadSource(src[0]);
+
+          for (uint32_t k = 0; k < 4; k++)
+            result.c[k] = k < cols ? Dot(a, LoadSource(src[1], k), rows) : zero;
+        } break;
+
+        default:
+          // Rejected when decoding the program
+          return;
+      }
+
+      StoreDestination(ctx.dst, result);
+    }
+
+  };
+
+
+  const D3D9SWVPCpuProgram* D3D9SWVPCpuEmulator::GetProgram(D3D9VertexShader* pShader) {
+    Rc<DxvkShader> shader = pShader->GetCommonShader()->GetShader();
+
+    // Shaders that failed to translate are
+    // likely not going to work here either
+    if (shader == nullptr)
+      return nullptr;
+
+    DxvkShaderKey key = shader->getShaderKey();
+
+    auto entry = m_programs.find(key);
+
+    if (entry != m_programs.end())
+      return entry->second.get();
+
+    UINT size = 0;
+    pShader->GetFunction(nullptr, &size);
+
+    std::vector<char> bytecode(size);
+    pShader->GetFunction(bytecode.data(), &size);
+
+    std::unique_ptr<D3D9SWVPCpuProgram> program;
+
+    try {
+      program = DecodeProgram(bytecode.data());
+    } catch (const DxvkError& e) {
+      Logger::err(e.message());
+    }
+
+    if (program == nullptr)
+      Logger::debug(str::format("D3D9SWVPCpuEmulator: ", shader->debugName(), " not supported on CPU"));
+
+    return m_programs.emplace(key, std::move(program)).first->second.get();
+  }
+
+
+  void D3D9SWVPCpuEmulator::ProcessVertices(
+    const D3D9SWVPCpuProgram&   Program,
+    const D3D9SWVPCpuArgs&      Args) {
+    D3D9SWVPCpuExecutor executor(Program, Args);
+
+    for (uint32_t i = 0; i < Args.vertexCount; i += 4)
+      executor.Run(i, std::min(Args.vertexCount - i, 4u));
+  }
+
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "d3d9_include.h"
+#include "d3d9_caps.h"
+#include "d3d9_constant_set.h"
+#include "d3d9_shader.h"
+
+#include "../dxso/dxso_decoder.h"
+
+namespace dxvk {
+
+  class D3D9VertexDecl;
+
+  /**
+   * \brief Decoded vertex shader for the CPU SWVP path
+   *
+   * Only straight-line vertex shaders are supported, i.e.
+   * shaders without flow control, predication or texture
+   * fetches, which covers the majority of shaders used
+   * with \c ProcessVertices.
+   */
+  struct D3D9SWVPCpuProgram {
+    uint32_t                            majorVersion = 0;
+    uint32_t                            minorVersion = 0;
+
+    uint32_t                            inputMask    = 0;
+    uint32_t                            outputMask   = 0;
+    uint32_t                            colorMask    = 0;
+
+    std::array<DxsoSemantic,
+      DxsoMaxInterfaceRegs>             inputs       = { };
+    std::array<DxsoSemantic,
+      DxsoMaxInterfaceRegs>             outputs      = { };
+
+    std::vector<int32_t>                defIndices;
+    std::vector<Vector4>                defValues;
+
+    std::vector<DxsoInstructionContext> code;
+  };
+
+
+  /**
+   * \brief Source vertex stream
+   *
+   * Points to the first vertex that is
+   * going to be processed in the stream.
+   */
+  struct D3D9SWVPCpuStream {
+    const uint8_t*  data   = nullptr;
+    uint32_t        stride = 0;
+    uint32_t        size   = 0;
+  };
+
+
+  /**
+   * \brief CPU vertex processing arguments
+   */
+  struct D3D9SWVPCpuArgs {
+    const D3D9ShaderConstantsVSSoftware*  constants   = nullptr;
+    uint32_t                              floatCount  = 0;
+    float                                 pointSize   = 0.0f;
+
+    const D3D9VertexDecl*                 srcDecl     = nullptr;
+    std::array<D3D9SWVPCpuStream,
+      caps::MaxStreams>                   streams     = { };
+
+    const D3D9VertexDecl*                 dstDecl     = nullptr;
+    uint8_t*                              dstData     = nullptr;
+    uint32_t                              vertexCount = 0;
+
+    bool                                  copyData    = true;
+
+    D3D9FloatEmulation                    floatEmulation = D3D9FloatEmulation::Enabled;
+  };
+
+
+  /**
+   * \brief CPU vertex shader interpreter
+   *
+   * Runs DXSO vertex shaders on the CPU for small \c ProcessVertices
+   * batches, where the GPU round trip dominates, and on devices that
+   * lack the features required by \ref D3D9SWVPEmulator. Vertices are
+   * processed in groups of four, with each register component stored
+   * as one SIMD vector holding that component for all four vertices.
+   */
+  class D3D9SWVPCpuEmulator {
+
+  public:
+
+    /**
+     * \brief Retrieves decoded program for a vertex shader
+     *
+     * \param [in] pShader The vertex shader
+     * \returns The decoded program, or \c nullptr if the
+     *    shader cannot be executed on the CPU.
+     */
+    const D3D9SWVPCpuProgram* GetProgram(D3D9VertexShader* pShader);
+
+    /**
+     * \brief Processes vertices
+     *
+     * \param [in] Program Decoded vertex shader
+     * \param [in] Args Source and destination data
+     */
+    void ProcessVertices(
+      const D3D9SWVPCpuProgram&   Program,
+      const D3D9SWVPCpuArgs&      Args);
+
+  private:
+
+    std::unordered_map<
+      DxvkShaderKey,
+      std::unique_ptr<D3D9SWVPCpuProgram>,
+      DxvkHash, DxvkEq>           m_programs;
+
+  };
+
+}
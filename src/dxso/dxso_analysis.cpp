@@ -1,5 +1,7 @@
 #include "dxso_analysis.h"
 
+#include <algorithm>
+
 namespace dxvk {
 
   DxsoAnalyzer::DxsoAnalyzer(
@@ -47,9 +49,56 @@ namespace dxvk {
      || opcode == DxsoOpcode::TexDepth)
       m_analysis->usesDerivatives = true;
 
+    this->processControlFlow(ctx);
+
     m_parentOpcode = ctx.instruction.opcode;
   }
 
+  void DxsoAnalyzer::processControlFlow(
+    const DxsoInstructionContext& ctx) {
+    // Validate block nesting here so that invalid shaders
+    // are rejected at creation time, before compilation
+    switch (ctx.instruction.opcode) {
+      case DxsoOpcode::If:
+      case DxsoOpcode::Ifc:
+        m_blocks.push_back(BlockType::If);
+        break;
+
+      case DxsoOpcode::Else:
+        if (m_blocks.empty() || m_blocks.back() != BlockType::If)
+          throw DxvkError("DxsoAnalyzer: 'Else' without 'If' found");
+        m_blocks.back() = BlockType::Else;
+        break;
+
+      case DxsoOpcode::EndIf:
+        if (m_blocks.empty() || m_blocks.back() == BlockType::Loop)
+          throw DxvkError("DxsoAnalyzer: 'EndIf' without 'If' found");
+        m_blocks.pop_back();
+        break;
+
+      case DxsoOpcode::Rep:
+      case DxsoOpcode::Loop:
+        m_blocks.push_back(BlockType::Loop);
+        break;
+
+      case DxsoOpcode::EndRep:
+      case DxsoOpcode::EndLoop:
+        if (m_blocks.empty() || m_blocks.back() != BlockType::Loop)
+          throw DxvkError("DxsoAnalyzer: 'EndRep' without 'Rep' or 'Loop' found");
+        m_blocks.pop_back();
+        break;
+
+      case DxsoOpcode::Break:
+      case DxsoOpcode::BreakC:
+        if (std::find(m_blocks.begin(), m_blocks.end(), BlockType::Loop) == m_blocks.end())
+          throw DxvkError("DxsoAnalyzer: 'Break' outside 'Rep' or 'Loop' found");
+        break;
+
+      default:
+        break;
+    }
+  }
+
   void DxsoAnalyzer::finalize(size_t tokenCount) {
     m_analysis->bytecodeByteLength = tokenCount * sizeof(uint32_t);
   }
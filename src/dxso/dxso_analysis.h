@@ -32,10 +32,19 @@ namespace dxvk {
 
   private:
 
+    enum class BlockType : uint32_t {
+      If, Else, Loop
+    };
+
     DxsoAnalysisInfo* m_analysis = nullptr;
 
     DxsoOpcode m_parentOpcode;
 
+    std::vector<BlockType> m_blocks;
+
+    void processControlFlow(
+      const DxsoInstructionContext& ctx);
+
   };
 
 }
\ No newline at end of file
@@ -111,6 +111,14 @@ namespace dxvk {
     if (externalInfo.handleType)
       externalProperties.pNext = std::exchange(properties.pNext, &externalProperties);
 
+    // Host transfer usage may affect device access performance,
+    // e.g. by disabling compression, so query that as well
+    VkHostImageCopyDevicePerformanceQueryEXT hostCopyPerf = { VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT };
+    hostCopyPerf.optimalDeviceAccess = VK_TRUE;
+
+    if (query.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT)
+      hostCopyPerf.pNext = std::exchange(properties.pNext, &hostCopyPerf);
+
     VkResult vr = m_vki->vkGetPhysicalDeviceImageFormatProperties2(
       m_handle, &info, &properties);
 
@@ -124,6 +132,7 @@ namespace dxvk {
     result.sampleCounts     = properties.imageFormatProperties.sampleCounts;
     result.maxResourceSize  = properties.imageFormatProperties.maxResourceSize;
     result.externalFeatures = externalProperties.externalMemoryProperties.externalMemoryFeatures;
+    result.optimalDeviceAccess = hostCopyPerf.optimalDeviceAccess;
     return result;
   }
 
@@ -249,6 +258,7 @@ namespace dxvk {
         && CHECK_FEATURE_NEED(extDepthBiasControl.floatRepresentation)
         && CHECK_FEATURE_NEED(extDepthBiasControl.depthBiasExact)
         && CHECK_FEATURE_NEED(extGraphicsPipelineLibrary.graphicsPipelineLibrary)
+        && CHECK_FEATURE_NEED(extHostImageCopy.hostImageCopy)
         && CHECK_FEATURE_NEED(extMemoryBudget)
         && CHECK_FEATURE_NEED(extMemoryPriority.memoryPriority)
         && CHECK_FEATURE_NEED(extNonSeamlessCubeMap.nonSeamlessCubeMap)
@@ -368,6 +378,10 @@ namespace dxvk {
     enabledFeatures.extGraphicsPipelineLibrary.graphicsPipelineLibrary =
       m_deviceFeatures.extGraphicsPipelineLibrary.graphicsPipelineLibrary;
 
+    // Used to upload texture data without going through a staging buffer
+    enabledFeatures.extHostImageCopy.hostImageCopy =
+      m_deviceFeatures.extHostImageCopy.hostImageCopy;
+
     // Only enable non-default line rasterization features if at least wide lines
     // and rectangular lines are supported. This saves us several feature checks
     // in the actual code.
@@ -562,6 +576,10 @@ namespace dxvk {
           enabledFeatures.extGraphicsPipelineLibrary = *reinterpret_cast<const VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT*>(f);
           break;
 
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT:
+          enabledFeatures.extHostImageCopy = *reinterpret_cast<const VkPhysicalDeviceHostImageCopyFeaturesEXT*>(f);
+          break;
+
         case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_LINE_RASTERIZATION_FEATURES_EXT:
           enabledFeatures.extLineRasterization = *reinterpret_cast<const VkPhysicalDeviceLineRasterizationFeaturesEXT*>(f);
           break;
@@ -748,6 +766,11 @@ namespace dxvk {
       m_deviceInfo.extGraphicsPipelineLibrary.pNext = std::exchange(m_deviceInfo.core.pNext, &m_deviceInfo.extGraphicsPipelineLibrary);
     }
 
+    if (m_deviceExtensions.supports(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)) {
+      m_deviceInfo.extHostImageCopy.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+      m_deviceInfo.extHostImageCopy.pNext = std::exchange(m_deviceInfo.core.pNext, &m_deviceInfo.extHostImageCopy);
+    }
+
     if (m_deviceExtensions.supports(VK_EXT_LINE_RASTERIZATION_EXTENSION_NAME)) {
       m_deviceInfo.extLineRasterization.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_LINE_RASTERIZATION_PROPERTIES_EXT;
       m_deviceInfo.extLineRasterization.pNext = std::exchange(m_deviceInfo.core.pNext, &m_deviceInfo.extLineRasterization);
@@ -775,6 +798,28 @@ namespace dxvk {
 
     // Query full device properties for all enabled extensions
     m_vki->vkGetPhysicalDeviceProperties2(m_handle, &m_deviceInfo.core);
+
+    // Query supported host copy destination layouts. The array is owned
+    // by the adapter, we don't need to know the source layouts for now.
+    m_hostImageCopyLayouts.clear();
+
+    if (m_deviceExtensions.supports(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)) {
+      m_hostImageCopyLayouts.resize(m_deviceInfo.extHostImageCopy.copyDstLayoutCount);
+
+      VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopy = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT };
+      hostImageCopy.copyDstLayoutCount = m_hostImageCopyLayouts.size();
+      hostImageCopy.pCopyDstLayouts = m_hostImageCopyLayouts.data();
+
+      VkPhysicalDeviceProperties2 properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &hostImageCopy };
+      m_vki->vkGetPhysicalDeviceProperties2(m_handle, &properties);
+
+      m_hostImageCopyLayouts.resize(hostImageCopy.copyDstLayoutCount);
+
+      m_deviceInfo.extHostImageCopy.copySrcLayoutCount = 0;
+      m_deviceInfo.extHostImageCopy.pCopySrcLayouts = nullptr;
+      m_deviceInfo.extHostImageCopy.copyDstLayoutCount = m_hostImageCopyLayouts.size();
+      m_deviceInfo.extHostImageCopy.pCopyDstLayouts = m_hostImageCopyLayouts.data();
+    }
     
     // Some drivers reports the driver version in a slightly different format
     switch (m_deviceInfo.vk12.driverID) {
@@ -854,6 +899,11 @@ namespace dxvk {
       m_deviceFeatures.extGraphicsPipelineLibrary.pNext = std::exchange(m_deviceFeatures.core.pNext, &m_deviceFeatures.extGraphicsPipelineLibrary);
     }
 
+    if (m_deviceExtensions.supports(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME)) {
+      m_deviceFeatures.extHostImageCopy.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+      m_deviceFeatures.extHostImageCopy.pNext = std::exchange(m_deviceFeatures.core.pNext, &m_deviceFeatures.extHostImageCopy);
+    }
+
     if (m_deviceExtensions.supports(VK_EXT_LINE_RASTERIZATION_EXTENSION_NAME)) {
       m_deviceFeatures.extLineRasterization.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_LINE_RASTERIZATION_FEATURES_EXT;
       m_deviceFeatures.extLineRasterization.pNext = std::exchange(m_deviceFeatures.core.pNext, &m_deviceFeatures.extLineRasterization);
@@ -975,6 +1025,7 @@ namespace dxvk {
       &devExtensions.extFullScreenExclusive,
       &devExtensions.extGraphicsPipelineLibrary,
       &devExtensions.extHdrMetadata,
+      &devExtensions.extHostImageCopy,
       &devExtensions.extLineRasterization,
       &devExtensions.extMemoryBudget,
       &devExtensions.extMemoryPriority,
@@ -1060,6 +1111,11 @@ namespace dxvk {
       enabledFeatures.extGraphicsPipelineLibrary.pNext = std::exchange(enabledFeatures.core.pNext, &enabledFeatures.extGraphicsPipelineLibrary);
     }
 
+    if (devExtensions.extHostImageCopy) {
+      enabledFeatures.extHostImageCopy.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+      enabledFeatures.extHostImageCopy.pNext = std::exchange(enabledFeatures.core.pNext, &enabledFeatures.extHostImageCopy);
+    }
+
     if (devExtensions.extLineRasterization) {
       enabledFeatures.extLineRasterization.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_LINE_RASTERIZATION_FEATURES_EXT;
       enabledFeatures.extLineRasterization.pNext = std::exchange(enabledFeatures.core.pNext, &enabledFeatures.extLineRasterization);
@@ -1240,6 +1296,8 @@ namespace dxvk {
       "\n  extension supported                    : ", features.extFullScreenExclusive ? "1" : "0",
       "\n", VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
       "\n  graphicsPipelineLibrary                : ", features.extGraphicsPipelineLibrary.graphicsPipelineLibrary ? "1" : "0",
+      "\n", VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME,
+      "\n  hostImageCopy                          : ", features.extHostImageCopy.hostImageCopy ? "1" : "0",
       "\n", VK_EXT_LINE_RASTERIZATION_EXTENSION_NAME,
       "\n  rectangularLines                       : ", features.extLineRasterization.rectangularLines ? "1" : "0",
       "\n  smoothLines                            : ", features.extLineRasterization.smoothLines ? "1" : "0",
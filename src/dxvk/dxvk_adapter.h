@@ -179,6 +179,17 @@ namespace dxvk {
      * \returns Indices for all queue families
      */
     DxvkAdapterQueueIndices findQueueFamilies() const;
+
+    /**
+     * \brief Retrieves queue family properties
+     *
+     * \param [in] family Queue family index
+     * \returns Properties of the given queue family
+     */
+    const VkQueueFamilyProperties& queueFamilyProperties(
+            uint32_t                  family) const {
+      return m_queueFamilies.at(family);
+    }
     
     /**
      * \brief Tests whether all required features are supported
@@ -318,6 +329,7 @@ namespace dxvk {
     bool                m_linkedToDGPU = false;
 
     std::vector<VkQueueFamilyProperties> m_queueFamilies;
+    std::vector<VkImageLayout>           m_hostImageCopyLayouts;
 
     std::array<std::atomic<uint64_t>, VK_MAX_MEMORY_HEAPS> m_memoryAllocated = { };
     std::array<std::atomic<uint64_t>, VK_MAX_MEMORY_HEAPS> m_memoryUsed = { };
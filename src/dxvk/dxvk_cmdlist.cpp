@@ -54,32 +54,60 @@ namespace dxvk {
   }
 
 
+  void DxvkCommandSubmission::endBatch() {
+    BatchInfo batch = getCurrentBatch();
+
+    if (batch.waitCount || batch.commandBufferCount || batch.signalCount)
+      m_batches.push_back(batch);
+  }
+
+
   VkResult DxvkCommandSubmission::submit(
           DxvkDevice*           device,
           VkQueue               queue) {
     auto vk = device->vkd();
 
-    VkSubmitInfo2 submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+    this->endBatch();
 
-    if (!m_semaphoreWaits.empty()) {
-      submitInfo.waitSemaphoreInfoCount = m_semaphoreWaits.size();
-      submitInfo.pWaitSemaphoreInfos = m_semaphoreWaits.data();
-    }
+    m_submitInfos.clear();
 
-    if (!m_commandBuffers.empty()) {
-      submitInfo.commandBufferInfoCount = m_commandBuffers.size();
-      submitInfo.pCommandBufferInfos = m_commandBuffers.data();
-    }
+    uint32_t waitIndex = 0;
+    uint32_t commandBufferIndex = 0;
+    uint32_t signalIndex = 0;
+
+    for (const auto& batch : m_batches) {
+      VkSubmitInfo2 submitInfo = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+
+      if (batch.waitCount) {
+        submitInfo.waitSemaphoreInfoCount = batch.waitCount;
+        submitInfo.pWaitSemaphoreInfos = &m_semaphoreWaits[waitIndex];
+      }
 
-    if (!m_semaphoreSignals.empty()) {
-      submitInfo.signalSemaphoreInfoCount = m_semaphoreSignals.size();
-      submitInfo.pSignalSemaphoreInfos = m_semaphoreSignals.data();
+      if (batch.commandBufferCount) {
+        submitInfo.commandBufferInfoCount = batch.commandBufferCount;
+        submitInfo.pCommandBufferInfos = &m_commandBuffers[commandBufferIndex];
+      }
+
+      if (batch.signalCount) {
+        submitInfo.signalSemaphoreInfoCount = batch.signalCount;
+        submitInfo.pSignalSemaphoreInfos = &m_semaphoreSignals[signalIndex];
+      }
+
+      waitIndex += batch.waitCount;
+      commandBufferIndex += batch.commandBufferCount;
+      signalIndex += batch.signalCount;
+
+      m_submitInfos.push_back(submitInfo);
     }
 
     VkResult vr = VK_SUCCESS;
 
-    if (!this->isEmpty())
-      vr = vk->vkQueueSubmit2(queue, 1, &submitInfo, m_fence);
+    if (!this->isEmpty()) {
+      vr = vk->vkQueueSubmit2(queue, m_submitInfos.size(),
+        m_submitInfos.data(), m_fence);
+
+      device->addStatCtr(DxvkStatCounter::QueueSubmitCount, 1);
+    }
 
     this->reset();
     return vr;
@@ -91,6 +119,7 @@ namespace dxvk {
     m_semaphoreWaits.clear();
     m_semaphoreSignals.clear();
     m_commandBuffers.clear();
+    m_batches.clear();
   }
 
 
@@ -102,6 +131,22 @@ namespace dxvk {
   }
 
 
+  DxvkCommandSubmission::BatchInfo DxvkCommandSubmission::getCurrentBatch() const {
+    BatchInfo batch = { };
+    batch.waitCount = uint32_t(m_semaphoreWaits.size());
+    batch.commandBufferCount = uint32_t(m_commandBuffers.size());
+    batch.signalCount = uint32_t(m_semaphoreSignals.size());
+
+    for (const auto& prev : m_batches) {
+      batch.waitCount -= prev.waitCount;
+      batch.commandBufferCount -= prev.commandBufferCount;
+      batch.signalCount -= prev.signalCount;
+    }
+
+    return batch;
+  }
+
+
   DxvkCommandPool::DxvkCommandPool(
           DxvkDevice*           device,
           uint32_t              queueFamily)
@@ -305,6 +350,79 @@ namespace dxvk {
   }
   
   
+  bool DxvkCommandList::canBatchSubmit() const {
+    // Sparse binding requires submissions to the sparse queue
+    for (const auto& cmd : m_cmdSubmissions) {
+      if (cmd.sparseBind)
+        return false;
+    }
+
+    // Transfer commands and semaphore waits are submitted
+    // to the dedicated transfer queue if there is one
+    if (m_device->hasDedicatedTransferQueue()) {
+      if (!m_waitSemaphores.empty())
+        return false;
+
+      for (const auto& cmd : m_cmdSubmissions) {
+        if (cmd.usedFlags.test(DxvkCmdBuffer::SdmaBuffer))
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+
+  void DxvkCommandList::appendSubmission(
+          DxvkCommandSubmission&  submission,
+          bool                    signalFence) {
+    for (size_t i = 0; i < m_cmdSubmissions.size(); i++) {
+      bool isFirst = i == 0;
+      bool isLast  = i == m_cmdSubmissions.size() - 1;
+
+      const auto& cmd = m_cmdSubmissions[i];
+
+      if (isFirst) {
+        for (const auto& entry : m_waitSemaphores) {
+          submission.waitSemaphore(entry.fence->handle(),
+            entry.value, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
+        }
+      }
+
+      if (cmd.usedFlags.test(DxvkCmdBuffer::SdmaBuffer))
+        submission.executeCommandBuffer(cmd.sdmaBuffer);
+
+      if (isFirst && m_wsiSemaphores.acquire) {
+        submission.waitSemaphore(m_wsiSemaphores.acquire,
+          0, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
+      }
+
+      if (cmd.usedFlags.test(DxvkCmdBuffer::InitBuffer))
+        submission.executeCommandBuffer(cmd.initBuffer);
+
+      if (cmd.usedFlags.test(DxvkCmdBuffer::ExecBuffer))
+        submission.executeCommandBuffer(cmd.execBuffer);
+
+      if (isLast) {
+        for (const auto& entry : m_signalSemaphores) {
+          submission.signalSemaphore(entry.fence->handle(),
+            entry.value, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+        }
+
+        if (m_wsiSemaphores.present) {
+          submission.signalSemaphore(m_wsiSemaphores.present,
+            0, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+        }
+
+        if (signalFence)
+          submission.signalFence(m_fence);
+      }
+
+      submission.endBatch();
+    }
+  }
+
+
   void DxvkCommandList::init() {
     m_cmd = DxvkCommandSubmissionInfo();
 
@@ -328,9 +446,13 @@ namespace dxvk {
     // Reset all command buffer handles
     m_cmd = DxvkCommandSubmissionInfo();
 
-    // Increment queue submission count
-    uint64_t submissionCount = m_cmdSubmissions.size();
-    m_statCounters.addCtr(DxvkStatCounter::QueueSubmitCount, submissionCount);
+    // Increment command list count. Actual queue
+    // submissions are counted when submitting.
+    m_statCounters.addCtr(DxvkStatCounter::QueueCmdListCount, 1);
+
+    // Record how many resource references had to be acquired
+    m_statCounters.addCtr(DxvkStatCounter::ResourceTrackCount, m_resources.trackCount());
+    m_statCounters.addCtr(DxvkStatCounter::ResourceTrackSkipped, m_resources.skipCount());
   }
 
 
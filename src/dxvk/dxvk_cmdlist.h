@@ -85,6 +85,16 @@ namespace dxvk {
     void executeCommandBuffer(
             VkCommandBuffer       commandBuffer);
 
+    /**
+     * \brief Ends the current batch
+     *
+     * Subsequent semaphores and command buffers will be added
+     * to a new batch. All batches are submitted to the queue
+     * with a single call, which retains the same semaphore
+     * ordering as separate submissions would.
+     */
+    void endBatch();
+
     /**
      * \brief Executes submission and resets object
      *
@@ -111,11 +121,22 @@ namespace dxvk {
 
   private:
 
+    struct BatchInfo {
+      uint32_t waitCount;
+      uint32_t commandBufferCount;
+      uint32_t signalCount;
+    };
+
     VkFence                                m_fence = VK_NULL_HANDLE;
     std::vector<VkSemaphoreSubmitInfo>     m_semaphoreWaits;
     std::vector<VkSemaphoreSubmitInfo>     m_semaphoreSignals;
     std::vector<VkCommandBufferSubmitInfo> m_commandBuffers;
 
+    std::vector<BatchInfo>                 m_batches;
+    std::vector<VkSubmitInfo2>             m_submitInfos;
+
+    BatchInfo getCurrentBatch() const;
+
   };
 
 
@@ -200,6 +221,33 @@ namespace dxvk {
      * \returns Submission status
      */
     VkResult submit();
+
+    /**
+     * \brief Checks whether the command list can be batched
+     *
+     * Command lists that only submit work to the graphics
+     * queue can be merged into a single queue submission
+     * with other command lists via \ref appendSubmission.
+     * \returns \c true if the command list can be batched
+     */
+    bool canBatchSubmit() const;
+
+    /**
+     * \brief Appends command list to a queue submission
+     *
+     * Adds one batch per internal submission of this command
+     * list to the given submission object, which must then be
+     * submitted to the graphics queue by the caller. Only valid
+     * if \ref canBatchSubmit returns \c true.
+     * \param [in,out] submission Queue submission
+     * \param [in] signalFence Whether to signal the command
+     *    list's fence. If \c false, the caller must ensure
+     *    that the fence of a command list later in the same
+     *    submission is used for synchronization instead.
+     */
+    void appendSubmission(
+            DxvkCommandSubmission&  submission,
+            bool                    signalFence);
     
     /**
      * \brief Stat counters
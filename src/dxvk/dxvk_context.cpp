@@ -17,6 +17,7 @@ namespace dxvk {
     m_execAcquires(DxvkCmdBuffer::ExecBuffer),
     m_execBarriers(DxvkCmdBuffer::ExecBuffer),
     m_queryManager(m_common->queryPool()),
+    m_gpuProfiler (device.ptr()),
     m_staging     (device, StagingBufferSize) {
     // Init framebuffer info with default render pass in case
     // the app does not explicitly bind any render targets
@@ -80,6 +81,8 @@ namespace dxvk {
     if (m_descriptorPool == nullptr)
       m_descriptorPool = m_descriptorManager->getDescriptorPool();
 
+    m_gpuProfiler.beginRecording();
+
     this->beginCurrentCommands();
   }
   
@@ -87,6 +90,9 @@ namespace dxvk {
   Rc<DxvkCommandList> DxvkContext::endRecording() {
     this->endCurrentCommands();
 
+    m_gpuProfiler.endRecording(m_cmd, m_queryManager);
+    m_queryManager.resolveQueries(m_cmd);
+
     if (m_descriptorPool->shouldSubmit(false)) {
       m_cmd->trackDescriptorPool(m_descriptorPool, m_descriptorManager);
       m_descriptorPool = m_descriptorManager->getDescriptorPool();
@@ -131,6 +137,8 @@ namespace dxvk {
     const VkComponentMapping&   srcMapping,
     const VkImageBlit&          region,
           VkFilter              filter) {
+    this->beginGpuZone(DxvkGpuZoneType::Blit);
+
     this->spillRenderPass(true);
     this->prepareImage(dstImage, vk::makeSubresourceRange(region.dstSubresource));
     this->prepareImage(srcImage, vk::makeSubresourceRange(region.srcSubresource));
@@ -207,6 +215,7 @@ namespace dxvk {
     auto bufferSlice = buffer->getSliceHandle(offset, align(length, sizeof(uint32_t)));
 
     if (!replaceBuffer) {
+      this->beginGpuZone(DxvkGpuZoneType::Clear);
       this->spillRenderPass(true);
     
       if (m_execBarriers.isBufferDirty(bufferSlice, DxvkAccess::Write))
@@ -250,6 +259,8 @@ namespace dxvk {
           VkDeviceSize          offset,
           VkDeviceSize          length,
           VkClearColorValue     value) {
+    this->beginGpuZone(DxvkGpuZoneType::Clear);
+
     this->spillRenderPass(true);
     this->invalidateState();
 
@@ -341,10 +352,12 @@ namespace dxvk {
       // 3) The clear gets executed separately, in which case updateFramebuffer
       //    will indirectly emit barriers for the given render target.
       // If there is overlap, we need to explicitly transition affected attachments.
+      this->beginGpuZone(DxvkGpuZoneType::Clear);
       this->spillRenderPass(true);
       this->prepareImage(imageView->image(), imageView->subresources(), false);
     } else if (!m_state.om.framebufferInfo.isWritable(attachmentIndex, clearAspects)) {
       // We cannot inline clears if the clear aspects are not writable
+      this->beginGpuZone(DxvkGpuZoneType::Clear);
       this->spillRenderPass(true);
     }
 
@@ -406,6 +419,7 @@ namespace dxvk {
     auto dstSlice = dstBuffer->getSliceHandle(dstOffset, numBytes);
 
     if (!replaceBuffer) {
+      this->beginGpuZone(DxvkGpuZoneType::Transfer);
       this->spillRenderPass(true);
 
       if (m_execBarriers.isBufferDirty(srcSlice, DxvkAccess::Read)
@@ -451,6 +465,71 @@ namespace dxvk {
   }
   
   
+  void DxvkContext::copyBufferRegions(
+    const Rc<DxvkBuffer>&       dstBuffer,
+    const Rc<DxvkBuffer>&       srcBuffer,
+          uint32_t              regionCount,
+    const VkBufferCopy*         pRegions) {
+    if (regionCount == 1) {
+      this->copyBuffer(dstBuffer, pRegions->dstOffset,
+        srcBuffer, pRegions->srcOffset, pRegions->size);
+      return;
+    }
+
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+    this->spillRenderPass(true);
+
+    small_vector<VkBufferCopy2, 16> copyRegions;
+    bool isDirty = false;
+
+    for (uint32_t i = 0; i < regionCount; i++) {
+      auto srcSlice = srcBuffer->getSliceHandle(pRegions[i].srcOffset, pRegions[i].size);
+      auto dstSlice = dstBuffer->getSliceHandle(pRegions[i].dstOffset, pRegions[i].size);
+
+      isDirty |= m_execBarriers.isBufferDirty(srcSlice, DxvkAccess::Read)
+              || m_execBarriers.isBufferDirty(dstSlice, DxvkAccess::Write);
+
+      VkBufferCopy2 copyRegion = { VK_STRUCTURE_TYPE_BUFFER_COPY_2 };
+      copyRegion.srcOffset = srcSlice.offset;
+      copyRegion.dstOffset = dstSlice.offset;
+      copyRegion.size      = dstSlice.length;
+      copyRegions.push_back(copyRegion);
+    }
+
+    if (isDirty)
+      m_execBarriers.recordCommands(m_cmd);
+
+    VkCopyBufferInfo2 copyInfo = { VK_STRUCTURE_TYPE_COPY_BUFFER_INFO_2 };
+    copyInfo.srcBuffer = srcBuffer->getSliceHandle().handle;
+    copyInfo.dstBuffer = dstBuffer->getSliceHandle().handle;
+    copyInfo.regionCount = regionCount;
+    copyInfo.pRegions = copyRegions.data();
+
+    m_cmd->cmdCopyBuffer(DxvkCmdBuffer::ExecBuffer, &copyInfo);
+
+    for (uint32_t i = 0; i < regionCount; i++) {
+      m_execBarriers.accessBuffer(
+        srcBuffer->getSliceHandle(pRegions[i].srcOffset, pRegions[i].size),
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_READ_BIT,
+        srcBuffer->info().stages,
+        srcBuffer->info().access);
+
+      m_execBarriers.accessBuffer(
+        dstBuffer->getSliceHandle(pRegions[i].dstOffset, pRegions[i].size),
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_ACCESS_TRANSFER_WRITE_BIT,
+        dstBuffer->info().stages,
+        dstBuffer->info().access);
+    }
+
+    m_cmd->trackResource<DxvkAccess::Write>(dstBuffer);
+    m_cmd->trackResource<DxvkAccess::Read>(srcBuffer);
+
+    m_cmd->addStatCtr(DxvkStatCounter::CmdCopyMergeCount, regionCount - 1);
+  }
+
+
   void DxvkContext::copyBufferRegion(
     const Rc<DxvkBuffer>&       dstBuffer,
           VkDeviceSize          dstOffset,
@@ -490,6 +569,8 @@ namespace dxvk {
           VkDeviceSize          srcOffset,
           VkDeviceSize          rowAlignment,
           VkDeviceSize          sliceAlignment) {
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+
     this->spillRenderPass(true);
     this->prepareImage(dstImage, vk::makeSubresourceRange(dstSubresource));
 
@@ -556,6 +637,8 @@ namespace dxvk {
           VkImageSubresourceLayers srcSubresource,
           VkOffset3D            srcOffset,
           VkExtent3D            extent) {
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+
     this->spillRenderPass(true);
 
     if (this->copyImageClear(dstImage, dstSubresource, dstOffset, extent, srcImage, srcSubresource))
@@ -661,6 +744,8 @@ namespace dxvk {
           VkImageSubresourceLayers srcSubresource,
           VkOffset3D            srcOffset,
           VkExtent3D            srcExtent) {
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+
     this->spillRenderPass(true);
     this->prepareImage(srcImage, vk::makeSubresourceRange(srcSubresource));
 
@@ -723,6 +808,8 @@ namespace dxvk {
           VkOffset2D            srcOffset,
           VkExtent2D            srcExtent,
           VkFormat              format) {
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+
     this->spillRenderPass(true);
     this->prepareImage(srcImage, vk::makeSubresourceRange(srcSubresource));
 
@@ -841,6 +928,8 @@ namespace dxvk {
           VkExtent3D            srcSize,
           VkExtent3D            extent,
           VkDeviceSize          elementSize) {
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+
     this->spillRenderPass(true);
     this->invalidateState();
 
@@ -1009,6 +1098,8 @@ namespace dxvk {
           VkOffset2D            srcOffset,
           VkExtent2D            srcExtent,
           VkFormat              format) {
+    this->beginGpuZone(DxvkGpuZoneType::Transfer);
+
     this->spillRenderPass(true);
     this->invalidateState();
 
@@ -1246,6 +1337,8 @@ namespace dxvk {
           uint32_t y,
           uint32_t z) {
     if (this->commitComputeState()) {
+      this->beginGpuZone(DxvkGpuZoneType::Compute);
+
       this->commitComputeBarriers<false>();
       this->commitComputeBarriers<true>();
 
@@ -1271,6 +1364,8 @@ namespace dxvk {
       m_execBarriers.recordCommands(m_cmd);
     
     if (this->commitComputeState()) {
+      this->beginGpuZone(DxvkGpuZoneType::Compute);
+
       this->commitComputeBarriers<false>();
       this->commitComputeBarriers<true>();
 
@@ -1445,7 +1540,7 @@ namespace dxvk {
     const Rc<DxvkImage>&            image,
     const VkImageSubresourceRange&  subresources,
           VkImageLayout             initialLayout) {
-    if (initialLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
+    if (initialLayout != VK_IMAGE_LAYOUT_UNDEFINED) {
       m_initBarriers.accessImage(image, subresources,
         initialLayout,
         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
@@ -1667,6 +1762,7 @@ namespace dxvk {
     if (imageView->info().numLevels <= 1)
       return;
     
+    this->beginGpuZone(DxvkGpuZoneType::Blit);
     this->spillRenderPass(false);
     this->invalidateState();
 
@@ -1877,6 +1973,8 @@ namespace dxvk {
     const Rc<DxvkImage>&            srcImage,
     const VkImageResolve&           region,
           VkFormat                  format) {
+    this->beginGpuZone(DxvkGpuZoneType::Resolve);
+
     this->spillRenderPass(true);
     this->prepareImage(dstImage, vk::makeSubresourceRange(region.dstSubresource));
     this->prepareImage(srcImage, vk::makeSubresourceRange(region.srcSubresource));
@@ -1910,6 +2008,8 @@ namespace dxvk {
     const VkImageResolve&           region,
           VkResolveModeFlagBits     depthMode,
           VkResolveModeFlagBits     stencilMode) {
+    this->beginGpuZone(DxvkGpuZoneType::Resolve);
+
     this->spillRenderPass(true);
     this->prepareImage(dstImage, vk::makeSubresourceRange(region.dstSubresource));
     this->prepareImage(srcImage, vk::makeSubresourceRange(region.srcSubresource));
@@ -2239,6 +2339,7 @@ namespace dxvk {
     auto bufferSlice = buffer->getSliceHandle(offset, size);
 
     if (!replaceBuffer) {
+      this->beginGpuZone(DxvkGpuZoneType::Transfer);
       this->spillRenderPass(true);
     
       if (m_execBarriers.isBufferDirty(bufferSlice, DxvkAccess::Write))
@@ -3276,6 +3377,7 @@ namespace dxvk {
       attachmentIndex = -1;
 
     if (attachmentIndex < 0) {
+      this->beginGpuZone(DxvkGpuZoneType::Clear);
       this->spillRenderPass(false);
 
       if (m_execBarriers.isImageDirty(imageView->image(), imageView->imageSubresources(), DxvkAccess::Write))
@@ -3377,6 +3479,7 @@ namespace dxvk {
           VkOffset3D            offset,
           VkExtent3D            extent,
           VkClearValue          value) {
+    this->beginGpuZone(DxvkGpuZoneType::Clear);
     this->spillRenderPass(false);
     this->invalidateState();
     
@@ -4517,6 +4620,8 @@ namespace dxvk {
         DxvkContextFlag::GpRenderPassSuspended,
         DxvkContextFlag::GpIndependentSets);
 
+      this->beginGpuZone(DxvkGpuZoneType::RenderPass);
+
       this->renderPassBindFramebuffer(
         m_state.om.framebufferInfo,
         m_state.om.renderPassOps);
@@ -4548,6 +4653,8 @@ namespace dxvk {
       
       this->renderPassUnbindFramebuffer();
 
+      this->endGpuZone(DxvkGpuZoneType::RenderPass);
+
       if (suspend)
         m_flags.set(DxvkContextFlag::GpRenderPassSuspended);
       else
@@ -4568,6 +4675,32 @@ namespace dxvk {
   }
 
 
+  void DxvkContext::beginGpuZone(
+          DxvkGpuZoneType           type) {
+    if (likely(!m_gpuProfiler.isEnabled()))
+      return;
+
+    // Callers begin their zone right before spilling the
+    // render pass, so the zone only starts timing once the
+    // render pass zone has actually ended. Operations that
+    // are recorded inside the render pass must not call this.
+    if (type != DxvkGpuZoneType::RenderPass
+     && m_flags.test(DxvkContextFlag::GpRenderPassBound))
+      m_gpuProfiler.deferZone(type);
+    else
+      m_gpuProfiler.beginZone(m_cmd, m_queryManager, type);
+  }
+
+
+  void DxvkContext::endGpuZone(
+          DxvkGpuZoneType           type) {
+    if (likely(!m_gpuProfiler.isEnabled()))
+      return;
+
+    m_gpuProfiler.endZone(m_cmd, m_queryManager, type);
+  }
+
+
   void DxvkContext::renderPassEmitInitBarriers(
     const DxvkFramebufferInfo&  framebufferInfo,
     const DxvkRenderPassOps&    ops) {
@@ -5877,6 +6010,7 @@ namespace dxvk {
   
   
   bool DxvkContext::commitComputeState() {
+    DXVK_PROFILE_ZONE("context", "Commit compute state");
     this->spillRenderPass(false);
 
     if (m_flags.any(
@@ -5898,6 +6032,8 @@ namespace dxvk {
   
   template<bool Indexed, bool Indirect>
   bool DxvkContext::commitGraphicsState() {
+    DXVK_PROFILE_ZONE("context", "Commit graphics state");
+
     if (m_flags.test(DxvkContextFlag::GpDirtyPipeline)) {
       if (unlikely(!this->updateGraphicsPipeline()))
         return false;
@@ -5,6 +5,7 @@
 #include "dxvk_cmdlist.h"
 #include "dxvk_context_state.h"
 #include "dxvk_data.h"
+#include "dxvk_gpu_profiler.h"
 #include "dxvk_objects.h"
 #include "dxvk_queue.h"
 #include "dxvk_resource.h"
@@ -491,6 +492,23 @@ namespace dxvk {
             VkDeviceSize          srcOffset,
             VkDeviceSize          numBytes);
     
+    /**
+     * \brief Copies multiple regions from one buffer to another
+     *
+     * Equivalent to calling \ref copyBuffer for each region,
+     * but records a single copy command and only checks for
+     * barriers once. Destination regions must not overlap.
+     * \param [in] dstBuffer Destination buffer
+     * \param [in] srcBuffer Source buffer
+     * \param [in] regionCount Number of regions to copy
+     * \param [in] pRegions Source and destination offsets
+     */
+    void copyBufferRegions(
+      const Rc<DxvkBuffer>&       dstBuffer,
+      const Rc<DxvkBuffer>&       srcBuffer,
+            uint32_t              regionCount,
+      const VkBufferCopy*         pRegions);
+    
     /**
      * \brief Copies overlapping buffer region
      * 
@@ -939,7 +957,8 @@ namespace dxvk {
      * \brief Initializes an image
      * 
      * Transitions the image into its default layout, and clears
-     * it to black unless the initial layout is preinitialized.
+     * it to black if the initial layout is undefined. Any other
+     * layout indicates that the contents were written by the host.
      * Only safe to call if the image is not in use by the GPU.
      * \param [in] image The image to initialize
      * \param [in] subresources Image subresources
@@ -1413,6 +1432,7 @@ namespace dxvk {
     DxvkBarrierControlFlags m_barrierControl;
 
     DxvkGpuQueryManager     m_queryManager;
+    DxvkGpuProfiler         m_gpuProfiler;
     DxvkStagingBuffer       m_staging;
     
     DxvkGlobalPipelineBarrier m_globalRoGraphicsBarrier;
@@ -1591,6 +1611,12 @@ namespace dxvk {
 
     void startRenderPass();
     void spillRenderPass(bool suspend);
+
+    void beginGpuZone(
+            DxvkGpuZoneType           type);
+
+    void endGpuZone(
+            DxvkGpuZoneType           type);
     
     void renderPassEmitInitBarriers(
       const DxvkFramebufferInfo&  framebufferInfo,
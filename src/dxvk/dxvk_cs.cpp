@@ -9,32 +9,60 @@ namespace dxvk {
   
   DxvkCsChunk::~DxvkCsChunk() {
     this->reset();
+
+    if (m_data)
+      ::operator delete(m_data, std::align_val_t(64));
   }
   
   
-  void DxvkCsChunk::init(DxvkCsChunkFlags flags) {
+  void DxvkCsChunk::init(DxvkCsChunkFlags flags, size_t blockSize) {
+    // Keep larger allocations around since the
+    // chunk may be reused with a larger size later
+    if (m_capacity < blockSize) {
+      if (m_data)
+        ::operator delete(m_data, std::align_val_t(64));
+
+      m_data = static_cast<char*>(::operator new(blockSize, std::align_val_t(64)));
+      m_capacity = blockSize;
+    }
+
     m_flags = flags;
+    m_blockSize = blockSize;
+  }
+
+
+  void DxvkCsChunk::trim() {
+    if (m_capacity > MinBlockSize) {
+      ::operator delete(m_data, std::align_val_t(64));
+
+      m_data = nullptr;
+      m_capacity = 0;
+    }
   }
 
 
   void DxvkCsChunk::executeAll(DxvkContext* ctx) {
-    auto cmd = m_head;
-    
+    auto cmd = begin();
+    auto end = this->end();
+
     if (m_flags.test(DxvkCsChunkFlag::SingleUse)) {
-      m_commandOffset = 0;
-      
-      while (cmd != nullptr) {
+      // Commands that are trivially destructible can skip
+      // the destroy step, which is the common case
+      DxvkCsCmdOp op = m_needsDestroy
+        ? DxvkCsCmdOp::ExecuteAndDestroy
+        : DxvkCsCmdOp::Execute;
+
+      while (cmd != end) {
         auto next = cmd->next();
-        cmd->exec(ctx);
-        cmd->~DxvkCsCmd();
+        cmd->exec(ctx, op);
         cmd = next;
       }
 
-      m_head = nullptr;
-      m_tail = nullptr;
+      m_commandOffset = 0;
+      m_needsDestroy = false;
     } else {
-      while (cmd != nullptr) {
-        cmd->exec(ctx);
+      while (cmd != end) {
+        cmd->exec(ctx, DxvkCsCmdOp::Execute);
         cmd = cmd->next();
       }
     }
@@ -42,18 +70,19 @@ namespace dxvk {
   
   
   void DxvkCsChunk::reset() {
-    auto cmd = m_head;
+    if (m_needsDestroy) {
+      auto cmd = begin();
+      auto end = this->end();
 
-    while (cmd != nullptr) {
-      auto next = cmd->next();
-      cmd->~DxvkCsCmd();
-      cmd = next;
+      while (cmd != end) {
+        auto next = cmd->next();
+        cmd->exec(nullptr, DxvkCsCmdOp::Destroy);
+        cmd = next;
+      }
     }
-    
-    m_head = nullptr;
-    m_tail = nullptr;
 
     m_commandOffset = 0;
+    m_needsDestroy = false;
   }
   
   
@@ -65,24 +94,34 @@ namespace dxvk {
   DxvkCsChunkPool::~DxvkCsChunkPool() {
     for (DxvkCsChunk* chunk : m_chunks)
       delete chunk;
+
+    for (DxvkCsChunk* chunk : m_largeChunks)
+      delete chunk;
   }
   
   
-  DxvkCsChunk* DxvkCsChunkPool::allocChunk(DxvkCsChunkFlags flags) {
+  DxvkCsChunk* DxvkCsChunkPool::allocChunk(
+          DxvkCsChunkFlags  flags,
+          size_t            blockSize) {
     DxvkCsChunk* chunk = nullptr;
 
     { std::lock_guard<dxvk::mutex> lock(m_mutex);
-      
-      if (m_chunks.size() != 0) {
-        chunk = m_chunks.back();
-        m_chunks.pop_back();
+
+      // Prefer chunks that already have enough storage,
+      // but never hand out large chunks for small blocks
+      auto& list = blockSize > DxvkCsChunk::MinBlockSize && !m_largeChunks.empty()
+        ? m_largeChunks : m_chunks;
+
+      if (list.size() != 0) {
+        chunk = list.back();
+        list.pop_back();
       }
     }
     
     if (!chunk)
       chunk = new DxvkCsChunk();
     
-    chunk->init(flags);
+    chunk->init(flags, blockSize);
     return chunk;
   }
   
@@ -91,6 +130,16 @@ namespace dxvk {
     chunk->reset();
     
     std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    if (chunk->capacity() > DxvkCsChunk::MinBlockSize) {
+      if (m_largeChunks.size() < MaxLargeChunks) {
+        m_largeChunks.push_back(chunk);
+        return;
+      }
+
+      chunk->trim();
+    }
+
     m_chunks.push_back(chunk);
   }
   
@@ -117,9 +166,11 @@ namespace dxvk {
   uint64_t DxvkCsThread::dispatchChunk(DxvkCsChunkRef&& chunk) {
     uint64_t seq;
 
+    auto t = dxvk::high_resolution_clock::now();
+
     { std::unique_lock<dxvk::mutex> lock(m_mutex);
       seq = ++m_chunksDispatched;
-      m_chunksQueued.push_back(std::move(chunk));
+      m_chunksQueued.push_back({ std::move(chunk), t });
     }
     
     m_condOnAdd.notify_one();
@@ -159,11 +210,18 @@ namespace dxvk {
 
     // Local chunk queue, we use two queues and swap between
     // them in order to potentially reduce lock contention.
-    std::vector<DxvkCsChunkRef> chunks;
+    std::vector<QueuedChunk> chunks;
+
+    // Positive if the CS thread is falling behind,
+    // negative if it repeatedly had to wait for work
+    int32_t load = 0;
 
     try {
       while (!m_stopped.load()) {
+        bool idle;
+
         { std::unique_lock<dxvk::mutex> lock(m_mutex);
+          idle = m_chunksQueued.empty();
 
           m_condOnAdd.wait(lock, [this] {
             return (!m_chunksQueued.empty())
@@ -173,10 +231,20 @@ namespace dxvk {
           std::swap(chunks, m_chunksQueued);
         }
 
-        for (auto& chunk : chunks) {
+        adjustChunkSize(load, idle, chunks.size());
+
+        for (auto& entry : chunks) {
+          auto t = dxvk::high_resolution_clock::now();
+          auto latency = std::chrono::duration_cast<std::chrono::microseconds>(t - entry.time);
+
           m_context->addStatCtr(DxvkStatCounter::CsChunkCount, 1);
+          m_context->addStatCtr(DxvkStatCounter::CsChunkBytes, entry.chunk->blockSize());
+          m_context->addStatCtr(DxvkStatCounter::CsCommandBytes, entry.chunk->size());
+          m_context->addStatCtr(DxvkStatCounter::CsChunkLatency, latency.count());
 
-          chunk->executeAll(m_context.ptr());
+          { DXVK_PROFILE_ZONE("cs", "Execute chunk");
+            entry.chunk->executeAll(m_context.ptr());
+          }
 
           // Use a separate mutex for the chunk counter, this
           // will only ever be contested if synchronization is
@@ -188,7 +256,7 @@ namespace dxvk {
 
           // Explicitly free chunk here to release
           // references to any resources held by it
-          chunk = DxvkCsChunkRef();
+          entry.chunk = DxvkCsChunkRef();
         }
 
         chunks.clear();
@@ -198,5 +266,31 @@ namespace dxvk {
       Logger::err(e.message());
     }
   }
+
+
+  void DxvkCsThread::adjustChunkSize(
+          int32_t&          load,
+          bool              idle,
+          size_t            queued) {
+    // Having multiple chunks queued up means that the
+    // application thread is ahead, so use larger chunks
+    // to reduce the per-chunk dispatch overhead.
+    if (queued > 1)
+      load = std::max(load, 0) + 1;
+    else if (idle)
+      load = std::min(load, 0) - 1;
+
+    size_t chunkSize = m_chunkSize.load(std::memory_order_relaxed);
+
+    if (load >= ChunkSizeHysteresis) {
+      if (chunkSize < DxvkCsChunk::MaxBlockSize)
+        m_chunkSize.store(chunkSize * 2, std::memory_order_relaxed);
+      load = 0;
+    } else if (load <= -ChunkSizeHysteresis) {
+      if (chunkSize > DxvkCsChunk::MinBlockSize)
+        m_chunkSize.store(chunkSize / 2, std::memory_order_relaxed);
+      load = 0;
+    }
+  }
   
-}
\ No newline at end of file
+}
@@ -3,7 +3,9 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <new>
 #include <queue>
+#include <type_traits>
 
 #include "../util/thread.h"
 
@@ -12,46 +14,66 @@
 
 namespace dxvk {
   
+  /**
+   * \brief Command operation
+   *
+   * Passed to the command procedure in order to
+   * execute and/or destroy the command.
+   */
+  enum class DxvkCsCmdOp : uint32_t {
+    Execute,
+    ExecuteAndDestroy,
+    Destroy,
+  };
+
+
   /**
    * \brief Command stream operation
    * 
    * An abstract representation of an operation
    * that can be recorded into a command list.
+   * Commands are stored back to back in a chunk
+   * and store a plain function pointer instead
+   * of a vtable, so that executing a chunk does
+   * not need to chase any pointers.
    */
   class DxvkCsCmd {
     
   public:
-    
-    virtual ~DxvkCsCmd() { }
-    
+
+    using Proc = void (*) (DxvkCsCmd*, DxvkContext*, DxvkCsCmdOp);
+
+    DxvkCsCmd(Proc proc, uint32_t size)
+    : m_proc(proc), m_size(size) { }
+
     /**
      * \brief Retrieves next command in a command chain
      * 
-     * This can be used to quickly iterate
-     * over commands within a chunk.
+     * Commands are tightly packed, so this returns
+     * the address immediately after the command.
      * \returns Pointer the next command
      */
     DxvkCsCmd* next() const {
-      return m_next;
-    }
-    
-    /**
-     * \brief Sets next command in a command chain
-     * \param [in] next Next command
-     */
-    void setNext(DxvkCsCmd* next) {
-      m_next = next;
+      return reinterpret_cast<DxvkCsCmd*>(
+        reinterpret_cast<uintptr_t>(this) + m_size);
     }
     
     /**
-     * \brief Executes embedded commands
+     * \brief Executes and/or destroys the command
+     *
+     * The command must not be accessed after
+     * being destroyed by this operation.
      * \param [in] ctx The target context
+     * \param [in] op Operation to perform
      */
-    virtual void exec(DxvkContext* ctx) = 0;
+    void exec(DxvkContext* ctx, DxvkCsCmdOp op) {
+      m_proc(this, ctx, op);
+    }
     
   private:
     
-    DxvkCsCmd* m_next = nullptr;
+    Proc      m_proc;
+    uint32_t  m_size;
     
   };
   
@@ -66,20 +88,31 @@ namespace dxvk {
   class alignas(16) DxvkCsTypedCmd : public DxvkCsCmd {
     
   public:
+
+    constexpr static bool NeedsDestroy = !std::is_trivially_destructible_v<T>;
     
     DxvkCsTypedCmd(T&& cmd)
-    : m_command(std::move(cmd)) { }
+    : DxvkCsCmd(&DxvkCsTypedCmd::proc, sizeof(DxvkCsTypedCmd)),
+      m_command(std::move(cmd)) { }
     
     DxvkCsTypedCmd             (DxvkCsTypedCmd&&) = delete;
     DxvkCsTypedCmd& operator = (DxvkCsTypedCmd&&) = delete;
     
-    void exec(DxvkContext* ctx) {
-      m_command(ctx);
-    }
-    
   private:
     
     T m_command;
+
+    static void proc(DxvkCsCmd* cmd, DxvkContext* ctx, DxvkCsCmdOp op) {
+      auto self = static_cast<DxvkCsTypedCmd*>(cmd);
+
+      if (op != DxvkCsCmdOp::Destroy)
+        self->m_command(ctx);
+
+      if constexpr (NeedsDestroy) {
+        if (op != DxvkCsCmdOp::Execute)
+          self->~DxvkCsTypedCmd();
+      }
+    }
     
   };
 
@@ -96,18 +129,18 @@ namespace dxvk {
 
   public:
 
+    constexpr static bool NeedsDestroy = !std::is_trivially_destructible_v<T>
+                                      || !std::is_trivially_destructible_v<M>;
+
     template<typename... Args>
     DxvkCsDataCmd(T&& cmd, Args&&... args)
-    : m_command (std::move(cmd)),
+    : DxvkCsCmd (&DxvkCsDataCmd::proc, sizeof(DxvkCsDataCmd)),
+      m_command (std::move(cmd)),
       m_data    (std::forward<Args>(args)...) { }
     
     DxvkCsDataCmd             (DxvkCsDataCmd&&) = delete;
     DxvkCsDataCmd& operator = (DxvkCsDataCmd&&) = delete;
 
-    void exec(DxvkContext* ctx) {
-      m_command(ctx, &m_data);
-    }
-
     M* data() {
       return &m_data;
     }
@@ -117,6 +150,18 @@ namespace dxvk {
     T m_command;
     M m_data;
 
+    static void proc(DxvkCsCmd* cmd, DxvkContext* ctx, DxvkCsCmdOp op) {
+      auto self = static_cast<DxvkCsDataCmd*>(cmd);
+
+      if (op != DxvkCsCmdOp::Destroy)
+        self->m_command(ctx, &self->m_data);
+
+      if constexpr (NeedsDestroy) {
+        if (op != DxvkCsCmdOp::Execute)
+          self->~DxvkCsDataCmd();
+      }
+    }
+
   };
   
   
@@ -138,8 +183,13 @@ namespace dxvk {
    * Stores a list of commands.
    */
   class DxvkCsChunk : public RcObject {
-    constexpr static size_t MaxBlockSize = 16384;
+    
   public:
+
+    /// Block size used when there is little CS thread load
+    constexpr static size_t MinBlockSize = 16384;
+    /// Block size used when the CS thread falls behind
+    constexpr static size_t MaxBlockSize = 65536;
     
     DxvkCsChunk();
     ~DxvkCsChunk();
@@ -152,6 +202,30 @@ namespace dxvk {
       return m_commandOffset == 0;
     }
 
+    /**
+     * \brief Queries size of recorded commands
+     * \returns Number of bytes used by commands
+     */
+    size_t size() const {
+      return m_commandOffset;
+    }
+
+    /**
+     * \brief Queries block size
+     * \returns Maximum size of recorded commands
+     */
+    size_t blockSize() const {
+      return m_blockSize;
+    }
+
+    /**
+     * \brief Queries allocated storage size
+     * \returns Size of the chunk's storage
+     */
+    size_t capacity() const {
+      return m_capacity;
+    }
+
     /**
      * \brief Tries to add a command to the chunk
      * 
@@ -166,20 +240,13 @@ namespace dxvk {
     bool push(T& command) {
       using FuncType = DxvkCsTypedCmd<T>;
       
-      if (unlikely(m_commandOffset > MaxBlockSize - sizeof(FuncType)))
+      if (unlikely(m_commandOffset > m_blockSize - sizeof(FuncType)))
         return false;
       
-      DxvkCsCmd* tail = m_tail;
-      
-      m_tail = new (m_data + m_commandOffset)
-        FuncType(std::move(command));
-      
-      if (likely(tail != nullptr))
-        tail->setNext(m_tail);
-      else
-        m_head = m_tail;
-      
+      new (m_data + m_commandOffset) FuncType(std::move(command));
+
       m_commandOffset += sizeof(FuncType);
+      m_needsDestroy |= FuncType::NeedsDestroy;
       return true;
     }
 
@@ -194,27 +261,33 @@ namespace dxvk {
     M* pushCmd(T& command, Args&&... args) {
       using FuncType = DxvkCsDataCmd<T, M>;
       
-      if (unlikely(m_commandOffset > MaxBlockSize - sizeof(FuncType)))
+      if (unlikely(m_commandOffset > m_blockSize - sizeof(FuncType)))
         return nullptr;
       
       FuncType* func = new (m_data + m_commandOffset)
         FuncType(std::move(command), std::forward<Args>(args)...);
-      
-      if (likely(m_tail != nullptr))
-        m_tail->setNext(func);
-      else
-        m_head = func;
-      m_tail = func;
 
       m_commandOffset += sizeof(FuncType);
+      m_needsDestroy |= FuncType::NeedsDestroy;
       return func->data();
     }
     
     /**
      * \brief Initializes chunk for recording
+     *
+     * Grows the chunk's storage if necessary.
      * \param [in] flags Chunk flags
+     * \param [in] blockSize Block size
+     */
+    void init(DxvkCsChunkFlags flags, size_t blockSize);
+
+    /**
+     * \brief Releases storage
+     *
+     * Frees the chunk's storage if it is larger than the
+     * minimum block size. The chunk must be empty.
      */
-    void init(DxvkCsChunkFlags flags);
+    void trim();
     
     /**
      * \brief Executes all commands
@@ -237,14 +310,21 @@ namespace dxvk {
   private:
     
     size_t m_commandOffset = 0;
-    
-    DxvkCsCmd* m_head = nullptr;
-    DxvkCsCmd* m_tail = nullptr;
+    size_t m_blockSize     = 0;
+    size_t m_capacity      = 0;
+    bool   m_needsDestroy  = false;
 
     DxvkCsChunkFlags m_flags;
+
+    DxvkCsCmd* begin() {
+      return reinterpret_cast<DxvkCsCmd*>(&m_data[0]);
+    }
+
+    DxvkCsCmd* end() {
+      return reinterpret_cast<DxvkCsCmd*>(&m_data[m_commandOffset]);
+    }
     
-    alignas(64)
-    char m_data[MaxBlockSize];
+    char* m_data = nullptr;
     
   };
   
@@ -270,24 +350,38 @@ namespace dxvk {
      * \brief Allocates a chunk
      * 
      * Takes an existing chunk from the pool,
-     * or creates a new one if necessary.
+     * or creates a new one if necessary. Chunks
+     * with large storage are only handed out for
+     * allocations that request a large block size,
+     * so that chunks retained by deferred command
+     * lists only use the minimum block size.
      * \param [in] flags Chunk flags
+     * \param [in] blockSize Chunk block size
      * \returns Allocated chunk object
      */
-    DxvkCsChunk* allocChunk(DxvkCsChunkFlags flags);
+    DxvkCsChunk* allocChunk(
+            DxvkCsChunkFlags  flags,
+            size_t            blockSize = DxvkCsChunk::MinBlockSize);
     
     /**
      * \brief Releases a chunk
      * 
-     * Resets the chunk and adds it to the pool.
+     * Resets the chunk and adds it to the pool. If
+     * too many large chunks are pooled already, the
+     * chunk's storage is trimmed to the minimum size.
      * \param [in] chunk Chunk to release
      */
     void freeChunk(DxvkCsChunk* chunk);
     
   private:
+
+    /// Maximum number of pooled chunks with storage
+    /// larger than the minimum block size
+    constexpr static size_t MaxLargeChunks = 16;
     
     dxvk::mutex               m_mutex;
     std::vector<DxvkCsChunk*> m_chunks;
+    std::vector<DxvkCsChunk*> m_largeChunks;
     
   };
   
@@ -420,7 +514,29 @@ namespace dxvk {
       return m_chunksExecuted.load();
     }
 
+    /**
+     * \brief Queries preferred chunk block size
+     *
+     * Adjusted based on CS thread load. Chunks are larger
+     * while the CS thread is falling behind in order to
+     * reduce dispatch overhead, and small while the thread
+     * is idle so that work gets dispatched more quickly.
+     * \returns Block size for newly allocated chunks
+     */
+    size_t preferredChunkSize() const {
+      return m_chunkSize.load(std::memory_order_relaxed);
+    }
+
   private:
+
+    /// Number of consecutive busy or idle iterations
+    /// after which the chunk size gets adjusted
+    constexpr static int32_t ChunkSizeHysteresis = 16;
+
+    struct QueuedChunk {
+      DxvkCsChunkRef                          chunk;
+      dxvk::high_resolution_clock::time_point time;
+    };
     
     Rc<DxvkDevice>              m_device;
     Rc<DxvkContext>             m_context;
@@ -433,10 +549,16 @@ namespace dxvk {
     dxvk::mutex                 m_mutex;
     dxvk::condition_variable    m_condOnAdd;
     dxvk::condition_variable    m_condOnSync;
-    std::vector<DxvkCsChunkRef> m_chunksQueued;
+    std::vector<QueuedChunk>    m_chunksQueued;
+    std::atomic<size_t>         m_chunkSize = { DxvkCsChunk::MinBlockSize };
     dxvk::thread                m_thread;
     
     void threadFunc();
+
+    void adjustChunkSize(
+            int32_t&          load,
+            bool              idle,
+            size_t            queued);
     
   };
   
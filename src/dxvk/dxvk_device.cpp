@@ -20,7 +20,10 @@ namespace dxvk {
     m_objects           (this),
     m_queues            (queues),
     m_submissionQueue   (this, queueCallback) {
+    if (m_options.enableGpuProfiler || Profiler::isEnabled())
+      this->enableGpuProfiler();
 
+    m_statsWriter = DxvkStatsWriter::create(this);
   }
   
   
@@ -67,6 +70,21 @@ namespace dxvk {
   }
 
 
+  bool DxvkDevice::canUseHostImageCopy(VkImageLayout layout) const {
+    if (!m_features.extHostImageCopy.hostImageCopy || !m_options.enableHostImageCopy)
+      return false;
+
+    const auto& properties = m_properties.extHostImageCopy;
+
+    for (uint32_t i = 0; i < properties.copyDstLayoutCount; i++) {
+      if (properties.pCopyDstLayouts[i] == layout)
+        return true;
+    }
+
+    return false;
+  }
+
+
   bool DxvkDevice::mustTrackPipelineLifetime() const {
     switch (m_options.trackPipelineLifetime) {
       case Tristate::True:
@@ -199,6 +217,7 @@ namespace dxvk {
   DxvkStatCounters DxvkDevice::getStatCounters() {
     DxvkPipelineCount pipe = m_objects.pipelineManager().getPipelineCount();
     DxvkPipelineWorkerStats workers = m_objects.pipelineManager().getWorkerStats();
+    DxvkGpuQueryStats queries = m_objects.queryPool().getStats();
     
     DxvkStatCounters result;
     result.setCtr(DxvkStatCounter::PipeCountGraphics, pipe.numGraphicsPipelines);
@@ -207,6 +226,9 @@ namespace dxvk {
     result.setCtr(DxvkStatCounter::PipeTasksDone,     workers.tasksCompleted);
     result.setCtr(DxvkStatCounter::PipeTasksTotal,    workers.tasksTotal);
     result.setCtr(DxvkStatCounter::GpuIdleTicks,      m_submissionQueue.gpuIdleTicks());
+    result.setCtr(DxvkStatCounter::QueryPoolCount,    queries.poolCount);
+    result.setCtr(DxvkStatCounter::QueryCount,        queries.queryCount);
+    result.setCtr(DxvkStatCounter::QueryUsedCount,    queries.queriesUsed);
 
     std::lock_guard<sync::Spinlock> lock(m_statLock);
     result.merge(m_statCounters);
@@ -264,8 +286,12 @@ namespace dxvk {
     presentInfo.frameId = frameId;
     m_submissionQueue.present(presentInfo, status);
     
-    std::lock_guard<sync::Spinlock> statLock(m_statLock);
-    m_statCounters.addCtr(DxvkStatCounter::QueuePresentCount, 1);
+    { std::lock_guard<sync::Spinlock> statLock(m_statLock);
+      m_statCounters.addCtr(DxvkStatCounter::QueuePresentCount, 1);
+    }
+
+    if (m_statsWriter)
+      m_statsWriter->recordFrame();
   }
 
 
@@ -23,6 +23,7 @@
 #include "dxvk_shader.h"
 #include "dxvk_sparse.h"
 #include "dxvk_stats.h"
+#include "dxvk_stats_writer.h"
 #include "dxvk_unbound.h"
 #include "dxvk_marker.h"
 
@@ -114,6 +115,25 @@ namespace dxvk {
     const DxvkOptions& config() const {
       return m_options;
     }
+
+    /**
+     * \brief Checks whether GPU profiling is enabled
+     * \returns \c true if contexts should write timestamps
+     */
+    bool isGpuProfilerEnabled() const {
+      return m_gpuProfilerEnabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Enables GPU profiling
+     *
+     * Takes effect on the next command list
+     * recorded by each context. Used by the
+     * HUD to display GPU time per frame.
+     */
+    void enableGpuProfiler() {
+      m_gpuProfilerEnabled.store(true, std::memory_order_relaxed);
+    }
     
     /**
      * \brief Queue handles
@@ -225,6 +245,17 @@ namespace dxvk {
      */
     bool canUsePipelineCacheControl() const;
 
+    /**
+     * \brief Checks whether host image copies can be used
+     *
+     * Images still need to be created with the host transfer
+     * usage flag, which in turn requires format support.
+     * \param [in] layout Image layout during the copy
+     * \returns \c true if host copies to images in the
+     *    given layout are supported and enabled.
+     */
+    bool canUseHostImageCopy(VkImageLayout layout) const;
+
     /**
      * \brief Checks whether pipelines should be tracked
      * \returns \c true if pipelines need to be tracked
@@ -551,6 +582,8 @@ namespace dxvk {
 
     sync::Spinlock              m_statLock;
     DxvkStatCounters            m_statCounters;
+
+    std::atomic<bool>           m_gpuProfilerEnabled = { false };
     
     DxvkDeviceQueueSet          m_queues;
     
@@ -558,6 +591,8 @@ namespace dxvk {
     
     DxvkSubmissionQueue         m_submissionQueue;
 
+    std::unique_ptr<DxvkStatsWriter> m_statsWriter;
+
     DxvkDevicePerfHints getPerfHints();
     
     void recycleCommandList(
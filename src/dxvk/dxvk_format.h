@@ -33,6 +33,7 @@ namespace dxvk {
     VkSampleCountFlags          sampleCounts;
     VkDeviceSize                maxResourceSize;
     VkExternalMemoryFeatureFlags externalFeatures;
+    VkBool32                    optimalDeviceAccess;
   };
 
   /**
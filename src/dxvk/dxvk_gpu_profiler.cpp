@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <limits>
+
+#include "dxvk_device.h"
+#include "dxvk_gpu_profiler.h"
+
+namespace dxvk {
+
+  DxvkGpuProfiler::DxvkGpuProfiler(DxvkDevice* device)
+  : m_device      (device),
+    m_traceOffset (std::numeric_limits<int64_t>::max()) {
+    const auto& limits = device->properties().core.properties.limits;
+
+    m_supported = limits.timestampComputeAndGraphics;
+    m_timestampPeriod = limits.timestampPeriod;
+
+    // Timestamps may only have a limited number of valid bits,
+    // in which case the upper bits are undefined and the
+    // counter wraps around much earlier.
+    uint32_t validBits = device->adapter()->queueFamilyProperties(
+      device->queues().graphics.queueFamily).timestampValidBits;
+
+    m_supported &= validBits != 0;
+    m_timestampMask = validBits < 64
+      ? (uint64_t(1) << validBits) - 1
+      : ~uint64_t(0);
+  }
+
+
+  DxvkGpuProfiler::~DxvkGpuProfiler() {
+
+  }
+
+
+  void DxvkGpuProfiler::beginRecording() {
+    m_enabled = m_supported && m_device->isGpuProfilerEnabled();
+  }
+
+
+  void DxvkGpuProfiler::endRecording(
+    const Rc<DxvkCommandList>&  cmd,
+          DxvkGpuQueryManager&  queryManager) {
+    m_deferredType = DxvkGpuZoneType::None;
+
+    if (m_zoneType != DxvkGpuZoneType::None)
+      this->endZone(cmd, queryManager, m_zoneType);
+
+    this->processZones(cmd);
+  }
+
+
+  void DxvkGpuProfiler::beginZone(
+    const Rc<DxvkCommandList>&  cmd,
+          DxvkGpuQueryManager&  queryManager,
+          DxvkGpuZoneType       type) {
+    m_deferredType = DxvkGpuZoneType::None;
+
+    if (m_zoneType == type)
+      return;
+
+    if (m_zoneType != DxvkGpuZoneType::None)
+      this->endZone(cmd, queryManager, m_zoneType);
+
+    m_zoneType = type;
+    m_zoneBegin = this->allocQuery();
+
+    queryManager.writeTimestamp(cmd, m_zoneBegin);
+  }
+
+
+  void DxvkGpuProfiler::endZone(
+    const Rc<DxvkCommandList>&  cmd,
+          DxvkGpuQueryManager&  queryManager,
+          DxvkGpuZoneType       type) {
+    if (m_zoneType != type)
+      return;
+
+    Zone zone;
+    zone.type = m_zoneType;
+    zone.begin = std::move(m_zoneBegin);
+    zone.end = this->allocQuery();
+
+    queryManager.writeTimestamp(cmd, zone.end);
+
+    m_pending.push(std::move(zone));
+    m_zoneType = DxvkGpuZoneType::None;
+
+    if (m_deferredType != DxvkGpuZoneType::None)
+      this->beginZone(cmd, queryManager, m_deferredType);
+  }
+
+
+  DxvkStatCounter DxvkGpuProfiler::getStatCounter(
+          DxvkGpuZoneType       type) {
+    switch (type) {
+      case DxvkGpuZoneType::RenderPass: return DxvkStatCounter::GpuTimeRenderPass;
+      case DxvkGpuZoneType::Compute:    return DxvkStatCounter::GpuTimeCompute;
+      case DxvkGpuZoneType::Blit:       return DxvkStatCounter::GpuTimeBlit;
+      case DxvkGpuZoneType::Clear:      return DxvkStatCounter::GpuTimeClear;
+      case DxvkGpuZoneType::Resolve:    return DxvkStatCounter::GpuTimeResolve;
+      case DxvkGpuZoneType::Transfer:   return DxvkStatCounter::GpuTimeTransfer;
+      default:                          return DxvkStatCounter::NumCounters;
+    }
+  }
+
+
+  const char* DxvkGpuProfiler::getZoneName(
+          DxvkGpuZoneType       type) {
+    switch (type) {
+      case DxvkGpuZoneType::RenderPass: return "Render pass";
+      case DxvkGpuZoneType::Compute:    return "Compute";
+      case DxvkGpuZoneType::Blit:       return "Blit";
+      case DxvkGpuZoneType::Clear:      return "Clear";
+      case DxvkGpuZoneType::Resolve:    return "Resolve";
+      case DxvkGpuZoneType::Transfer:   return "Transfer";
+      default:                          return "Unknown";
+    }
+  }
+
+
+  Rc<DxvkGpuQuery> DxvkGpuProfiler::allocQuery() {
+    if (m_queries.empty())
+      return m_device->createGpuQuery(VK_QUERY_TYPE_TIMESTAMP, 0, 0);
+
+    Rc<DxvkGpuQuery> query = std::move(m_queries.back());
+    m_queries.pop_back();
+    return query;
+  }
+
+
+  void DxvkGpuProfiler::processZones(
+    const Rc<DxvkCommandList>&  cmd) {
+    while (!m_pending.empty()) {
+      Zone& zone = m_pending.front();
+
+      // Zones complete in order, so we can stop at the first
+      // zone whose command list has not completed yet. Only
+      // polling retired zones also ensures that the results
+      // are read from the readback buffer.
+      if (zone.end->isInUse(DxvkAccess::Write))
+        break;
+
+      DxvkQueryData begin = { };
+      DxvkQueryData end = { };
+
+      DxvkGpuQueryStatus status = zone.end->getData(end);
+
+      if (status == DxvkGpuQueryStatus::Pending)
+        break;
+
+      if (status == DxvkGpuQueryStatus::Available)
+        status = zone.begin->getData(begin);
+
+      if (status == DxvkGpuQueryStatus::Pending)
+        break;
+
+      if (status == DxvkGpuQueryStatus::Available) {
+        uint64_t beginTime = begin.timestamp.time & m_timestampMask;
+        uint64_t endTime = end.timestamp.time & m_timestampMask;
+
+        uint64_t ticks = (endTime - beginTime) & m_timestampMask;
+        uint64_t ns = uint64_t(double(ticks) * m_timestampPeriod);
+
+        cmd->addStatCtr(getStatCounter(zone.type), ns);
+
+        if (Profiler::isEnabled()) {
+          // GPU timestamps use their own time domain. Estimate the
+          // offset to CPU time from the earliest point where we saw
+          // a completed zone, which approaches the real offset as
+          // zones get processed shortly after completion.
+          int64_t gpuBegin = Profiler::nsToTicks(int64_t(double(beginTime) * m_timestampPeriod));
+          int64_t gpuEnd = gpuBegin + Profiler::nsToTicks(int64_t(ns));
+
+          m_traceOffset = std::min(m_traceOffset, Profiler::now() - gpuEnd);
+
+          Profiler::recordGpuZone("gpu", getZoneName(zone.type),
+            gpuBegin + m_traceOffset, gpuEnd + m_traceOffset);
+        }
+      }
+
+      m_queries.push_back(std::move(zone.begin));
+      m_queries.push_back(std::move(zone.end));
+      m_pending.pop();
+    }
+  }
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <array>
+#include <queue>
+#include <vector>
+
+#include "dxvk_gpu_query.h"
+#include "dxvk_stats.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief GPU profiler zone type
+   *
+   * Categories of GPU work that are timed
+   * separately. Consecutive operations of
+   * the same type share a single zone.
+   */
+  enum class DxvkGpuZoneType : uint32_t {
+    None        = 0,
+    RenderPass  = 1,
+    Compute     = 2,
+    Blit        = 3,
+    Clear       = 4,
+    Resolve     = 5,
+    Transfer    = 6,
+  };
+
+  constexpr uint32_t DxvkGpuZoneTypeCount = 7;
+
+
+  /**
+   * \brief GPU profiler
+   *
+   * Writes timestamp queries around render passes, compute
+   * dispatches and meta operations, and accumulates the GPU
+   * time spent in each type of zone in the stat counters of
+   * the command list that reads back the results. If the CPU
+   * profiler is enabled, zones are also written to the trace.
+   */
+  class DxvkGpuProfiler {
+
+  public:
+
+    DxvkGpuProfiler(DxvkDevice* device);
+
+    ~DxvkGpuProfiler();
+
+    /**
+     * \brief Checks whether zones are being recorded
+     * \returns \c true if profiling is active
+     */
+    bool isEnabled() const {
+      return m_enabled;
+    }
+
+    /**
+     * \brief Begins recording a command list
+     *
+     * Checks whether GPU profiling has been
+     * enabled on the device in the meantime.
+     */
+    void beginRecording();
+
+    /**
+     * \brief Ends recording a command list
+     *
+     * Ends the current zone and accumulates the results
+     * of all previously recorded zones that are ready.
+     * \param [in] cmd Command list
+     * \param [in] queryManager Query manager
+     */
+    void endRecording(
+      const Rc<DxvkCommandList>&  cmd,
+            DxvkGpuQueryManager&  queryManager);
+
+    /**
+     * \brief Begins a zone
+     *
+     * Ends the current zone if it has a different
+     * type, otherwise the current zone is extended.
+     * \param [in] cmd Command list
+     * \param [in] queryManager Query manager
+     * \param [in] type Zone type
+     */
+    void beginZone(
+      const Rc<DxvkCommandList>&  cmd,
+            DxvkGpuQueryManager&  queryManager,
+            DxvkGpuZoneType       type);
+
+    /**
+     * \brief Defers beginning a zone
+     *
+     * Used for operations that end the current render
+     * pass. The zone begins once the render pass zone
+     * ends, unless another zone begins before that.
+     * \param [in] type Zone type
+     */
+    void deferZone(
+            DxvkGpuZoneType       type) {
+      m_deferredType = type;
+    }
+
+    /**
+     * \brief Ends the current zone
+     *
+     * Begins the deferred zone, if any.
+     * \param [in] cmd Command list
+     * \param [in] queryManager Query manager
+     * \param [in] type Zone type to end
+     */
+    void endZone(
+      const Rc<DxvkCommandList>&  cmd,
+            DxvkGpuQueryManager&  queryManager,
+            DxvkGpuZoneType       type);
+
+    /**
+     * \brief Retrieves stat counter for a zone type
+     *
+     * \param [in] type Zone type
+     * \returns Counter storing GPU time in nanoseconds
+     */
+    static DxvkStatCounter getStatCounter(
+            DxvkGpuZoneType       type);
+
+    /**
+     * \brief Retrieves name of a zone type
+     *
+     * \param [in] type Zone type
+     * \returns Zone name
+     */
+    static const char* getZoneName(
+            DxvkGpuZoneType       type);
+
+  private:
+
+    struct Zone {
+      DxvkGpuZoneType   type;
+      Rc<DxvkGpuQuery>  begin;
+      Rc<DxvkGpuQuery>  end;
+    };
+
+    DxvkDevice*                   m_device;
+
+    bool                          m_supported = false;
+    bool                          m_enabled   = false;
+    double                        m_timestampPeriod = 0.0;
+    uint64_t                      m_timestampMask = 0;
+
+    DxvkGpuZoneType               m_zoneType  = DxvkGpuZoneType::None;
+    DxvkGpuZoneType               m_deferredType = DxvkGpuZoneType::None;
+    Rc<DxvkGpuQuery>              m_zoneBegin;
+
+    std::queue<Zone>              m_pending;
+    std::vector<Rc<DxvkGpuQuery>> m_queries;
+
+    int64_t                       m_traceOffset;
+
+    Rc<DxvkGpuQuery> allocQuery();
+
+    void processZones(
+      const Rc<DxvkCommandList>&  cmd);
+
+  };
+
+}
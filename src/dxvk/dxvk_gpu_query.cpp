@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cstring>
 
 #include "dxvk_cmdlist.h"
 #include "dxvk_device.h"
@@ -18,8 +19,7 @@ namespace dxvk {
   
   
   DxvkGpuQuery::~DxvkGpuQuery() {
-    for (size_t i = 0; i < m_handles.size(); i++)
-      m_handles[i].allocator->freeQuery(m_handles[i]);
+    this->freeQueryHandles();
   }
 
 
@@ -37,8 +37,13 @@ namespace dxvk {
     if (!m_ended.load(std::memory_order_acquire))
       return DxvkGpuQueryStatus::Invalid;
 
-    // Accumulate query data from all available queries
-    DxvkGpuQueryStatus status = this->accumulateQueryData();
+    // Accumulate query data from all available queries. If the GPU
+    // is done with the query, all results have already been copied
+    // to the readback buffers, so we can read them without having
+    // to check each individual Vulkan query.
+    DxvkGpuQueryStatus status = this->isInUse(DxvkAccess::Write)
+      ? this->accumulateQueryData()
+      : this->accumulateReadbackData();
     
     // Treat non-precise occlusion queries as available
     // if we already know the result will be non-zero
@@ -67,6 +72,7 @@ namespace dxvk {
       cmd->trackGpuQuery(m_handles[i]);
 
     m_handles.clear();
+    m_handlesAccumulated = 0;
 
     // Reset accumulated query data
     m_queryData = DxvkQueryData();
@@ -80,11 +86,9 @@ namespace dxvk {
 
 
   void DxvkGpuQuery::addQueryHandle(const DxvkGpuQueryHandle& handle) {
-    // Already accumulate available queries here in case
-    // we already allocated a large number of queries
-    if (m_handles.size() >= m_handles.MinCapacity)
-      this->accumulateQueryData();
-
+    // Handles must not be returned to the allocator before the
+    // command list using them has completed, since pending
+    // result copies may still access the Vulkan queries.
     m_handles.push_back(handle);
   }
 
@@ -103,7 +107,13 @@ namespace dxvk {
       return DxvkGpuQueryStatus::Pending;
     else if (result != VK_SUCCESS)
       return DxvkGpuQueryStatus::Failed;
-    
+
+    return this->addQueryData(tmpData);
+  }
+
+
+  DxvkGpuQueryStatus DxvkGpuQuery::addQueryData(
+    const DxvkQueryData&      tmpData) {
     // Add numbers to the destination structure
     switch (m_type) {
       case VK_QUERY_TYPE_OCCLUSION:
@@ -145,32 +155,72 @@ namespace dxvk {
   DxvkGpuQueryStatus DxvkGpuQuery::accumulateQueryData() {
     DxvkGpuQueryStatus status = DxvkGpuQueryStatus::Available;
 
-    // Process available queries and return them to the
-    // allocator if possible. This may help reduce the
-    // number of Vulkan queries in flight.
-    size_t queriesAvailable = 0;
-
-    while (queriesAvailable < m_handles.size()) {
-      status = this->accumulateQueryDataForHandle(m_handles[queriesAvailable]);
+    // Process available queries, but keep the handles around
+    // since the query may still be in use by the GPU, and the
+    // results of in-flight queries may still get copied to the
+    // readback buffer. Remember how many queries were already
+    // accumulated so we don't add their results twice.
+    while (m_handlesAccumulated < m_handles.size()) {
+      status = this->accumulateQueryDataForHandle(m_handles[m_handlesAccumulated]);
 
       if (status != DxvkGpuQueryStatus::Available)
         break;
 
-      queriesAvailable += 1;
+      m_handlesAccumulated += 1;
     }
 
-    if (queriesAvailable) {
-      for (size_t i = 0; i < queriesAvailable; i++)
-        m_handles[i].allocator->freeQuery(m_handles[i]);
+    return status;
+  }
+
+
+  DxvkGpuQueryStatus DxvkGpuQuery::accumulateReadbackData() {
+    DxvkGpuQueryStatus status = DxvkGpuQueryStatus::Available;
+
+    // Fall back to reading back each query individually
+    // if any of the readback buffers could not be created
+    bool hasReadback = true;
+
+    for (const auto& handle : m_handles)
+      hasReadback &= handle.readback != nullptr;
+
+    if (hasReadback) {
+      while (m_handlesAccumulated < m_handles.size()) {
+        const auto& handle = m_handles[m_handlesAccumulated];
+        VkDeviceSize stride = handle.allocator->readbackStride();
 
-      for (size_t i = queriesAvailable; i < m_handles.size(); i++)
-        m_handles[i - queriesAvailable] = m_handles[i];
+        DxvkQueryData tmpData = { };
+        std::memcpy(&tmpData, handle.readback->mapPtr(handle.queryId * stride), stride);
 
-      m_handles.resize(m_handles.size() - queriesAvailable);
+        status = this->addQueryData(tmpData);
+
+        if (status != DxvkGpuQueryStatus::Available)
+          break;
+
+        m_handlesAccumulated += 1;
+      }
+    } else {
+      status = this->accumulateQueryData();
     }
 
+    // The GPU is done with the query at this point, so
+    // the handles can safely be returned to the allocator
+    if (status == DxvkGpuQueryStatus::Available)
+      this->freeQueryHandles();
+
     return status;
   }
+
+
+  void DxvkGpuQuery::freeQueryHandles() {
+    // All handles of a query come from the same allocator
+    if (!m_handles.empty()) {
+      m_handles.front().allocator->freeQueries(
+        m_handles.size(), m_handles.data());
+    }
+
+    m_handles.clear();
+    m_handlesAccumulated = 0;
+  }
   
   
   
@@ -183,7 +233,27 @@ namespace dxvk {
     m_vkd           (device->vkd()),
     m_queryType     (queryType),
     m_queryPoolSize (queryPoolSize) {
+    switch (m_queryType) {
+      case VK_QUERY_TYPE_OCCLUSION:
+        m_readbackStride = sizeof(DxvkQueryOcclusionData);
+        break;
+      case VK_QUERY_TYPE_PIPELINE_STATISTICS:
+        m_readbackStride = sizeof(DxvkQueryStatisticData);
+        break;
+      case VK_QUERY_TYPE_TIMESTAMP:
+        m_readbackStride = sizeof(DxvkQueryTimestampData);
+        break;
+      case VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT:
+        m_readbackStride = sizeof(DxvkQueryXfbStreamData);
+        break;
+      default:
+        m_readbackStride = sizeof(DxvkQueryData);
+    }
 
+    // Hand out queries in small chunks so that contexts do not
+    // need to lock the allocator every time they use a query,
+    // without hoarding too many queries per context either.
+    m_slabSize = std::max(m_queryPoolSize / 64u, 1u);
   }
 
   
@@ -195,24 +265,45 @@ namespace dxvk {
   }
 
   
-  DxvkGpuQueryHandle DxvkGpuQueryAllocator::allocQuery() {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+  void DxvkGpuQueryAllocator::allocQueries(
+          std::vector<DxvkGpuQueryHandle>& handles) {
+    size_t first = handles.size();
 
-    if (m_handles.size() == 0)
-      this->createQueryPool();
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
 
-    if (m_handles.size() == 0)
-      return DxvkGpuQueryHandle();
-    
-    DxvkGpuQueryHandle result = m_handles.back();
-    m_handles.pop_back();
-    return result;
+      if (m_handles.size() == 0)
+        this->createQueryPool();
+
+      size_t count = std::min<size_t>(m_handles.size(), m_slabSize);
+      handles.insert(handles.end(), m_handles.end() - count, m_handles.end());
+
+      m_handles.resize(m_handles.size() - count);
+      m_freeCount.store(m_handles.size(), std::memory_order_relaxed);
+    }
+
+    // Resetting queries does not require the lock
+    this->resetQueries(handles.size() - first, &handles[first]);
   }
 
 
-  void DxvkGpuQueryAllocator::freeQuery(DxvkGpuQueryHandle handle) {
+  void DxvkGpuQueryAllocator::freeQueries(
+          size_t              count,
+    const DxvkGpuQueryHandle* handles) {
     std::lock_guard<dxvk::mutex> lock(m_mutex);
-    m_handles.push_back(handle);
+    m_handles.insert(m_handles.end(), handles, handles + count);
+    m_freeCount.store(m_handles.size(), std::memory_order_relaxed);
+  }
+
+
+  DxvkGpuQueryStats DxvkGpuQueryAllocator::getStats() const {
+    uint32_t poolCount = m_poolCount.load(std::memory_order_relaxed);
+    uint32_t freeCount = m_freeCount.load(std::memory_order_relaxed);
+
+    DxvkGpuQueryStats result;
+    result.poolCount = poolCount;
+    result.queryCount = poolCount * m_queryPoolSize;
+    result.queriesUsed = result.queryCount - std::min(freeCount, result.queryCount);
+    return result;
   }
 
   
@@ -243,10 +334,65 @@ namespace dxvk {
       return;
     }
 
+    Rc<DxvkBuffer> readback = createReadbackBuffer();
+
     m_pools.push_back(queryPool);
+    m_readbacks.push_back(readback);
+
+    // Push queries in reverse order so that queries get
+    // allocated in ascending order, which allows us to
+    // reset and resolve them in larger batches.
+    for (uint32_t i = m_queryPoolSize; i; i--)
+      m_handles.push_back({ this, queryPool, i - 1, readback.ptr() });
+
+    m_poolCount.store(m_pools.size(), std::memory_order_relaxed);
+  }
+
+
+  Rc<DxvkBuffer> DxvkGpuQueryAllocator::createReadbackBuffer() {
+    DxvkBufferCreateInfo info;
+    info.size   = m_queryPoolSize * m_readbackStride;
+    info.usage  = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    info.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    try {
+      return m_device->createBuffer(info,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+        VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    } catch (const DxvkError& e) {
+      // Queries will be read back individually
+      Logger::warn(str::format("DXVK: Failed to create query readback buffer: ", e.message()));
+      return nullptr;
+    }
+  }
+
+
+  void DxvkGpuQueryAllocator::resetQueries(
+          size_t              count,
+          DxvkGpuQueryHandle* handles) {
+    std::sort(handles, handles + count,
+      [] (const DxvkGpuQueryHandle& a, const DxvkGpuQueryHandle& b) {
+        if (a.queryPool != b.queryPool)
+          return a.queryPool < b.queryPool;
+        return a.queryId < b.queryId;
+      });
 
-    for (uint32_t i = 0; i < m_queryPoolSize; i++)
-      m_handles.push_back({ this, queryPool, i });
+    size_t first = 0;
+
+    for (size_t i = 1; i <= count; i++) {
+      if (i < count
+       && handles[i].queryPool == handles[first].queryPool
+       && handles[i].queryId == handles[first].queryId + (i - first))
+        continue;
+
+      m_vkd->vkResetQueryPool(m_vkd->device(),
+        handles[first].queryPool, handles[first].queryId,
+        uint32_t(i - first));
+
+      first = i;
+    }
   }
 
 
@@ -266,23 +412,48 @@ namespace dxvk {
   }
 
   
-  DxvkGpuQueryHandle DxvkGpuQueryPool::allocQuery(VkQueryType type) {
+  void DxvkGpuQueryPool::allocQueries(
+          VkQueryType         type,
+          std::vector<DxvkGpuQueryHandle>& handles) {
     switch (type) {
       case VK_QUERY_TYPE_OCCLUSION:
-        return m_occlusion.allocQuery();
+        m_occlusion.allocQueries(handles);
+        break;
       case VK_QUERY_TYPE_PIPELINE_STATISTICS:
-        return m_statistic.allocQuery();
+        m_statistic.allocQueries(handles);
+        break;
       case VK_QUERY_TYPE_TIMESTAMP:
-        return m_timestamp.allocQuery();
+        m_timestamp.allocQueries(handles);
+        break;
       case VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT:
-        return m_xfbStream.allocQuery();
+        m_xfbStream.allocQueries(handles);
+        break;
       default:
         Logger::err(str::format("DXVK: Unhandled query type: ", type));
-        return DxvkGpuQueryHandle();
     }
   }
 
 
+  DxvkGpuQueryStats DxvkGpuQueryPool::getStats() const {
+    std::array<DxvkGpuQueryStats, 4> stats = {
+      m_occlusion.getStats(),
+      m_statistic.getStats(),
+      m_timestamp.getStats(),
+      m_xfbStream.getStats(),
+    };
+
+    DxvkGpuQueryStats result = { };
+
+    for (const auto& s : stats) {
+      result.poolCount   += s.poolCount;
+      result.queryCount  += s.queryCount;
+      result.queriesUsed += s.queriesUsed;
+    }
+
+    return result;
+  }
+
+
 
 
   DxvkGpuQueryManager::DxvkGpuQueryManager(DxvkGpuQueryPool& pool)
@@ -292,7 +463,10 @@ namespace dxvk {
 
   
   DxvkGpuQueryManager::~DxvkGpuQueryManager() {
-
+    for (const auto& handles : m_freeQueries) {
+      if (!handles.empty())
+        handles.front().allocator->freeQueries(handles.size(), handles.data());
+    }
   }
 
 
@@ -329,22 +503,20 @@ namespace dxvk {
   void DxvkGpuQueryManager::writeTimestamp(
     const Rc<DxvkCommandList>&  cmd,
     const Rc<DxvkGpuQuery>&     query) {
-    DxvkGpuQueryHandle handle = m_pool->allocQuery(query->type());
+    DxvkGpuQueryHandle handle = this->allocQuery(query->type());
     
     query->begin(cmd);
     query->addQueryHandle(handle);
     query->end();
 
-    cmd->resetQuery(
-      handle.queryPool,
-      handle.queryId);
-    
     cmd->cmdWriteTimestamp(
       VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
       handle.queryPool,
       handle.queryId);
-    
-    cmd->trackResource<DxvkAccess::None>(query);
+
+    m_resolveQueries.push_back(handle);
+
+    cmd->trackResource<DxvkAccess::Write>(query);
   }
 
 
@@ -375,11 +547,7 @@ namespace dxvk {
   void DxvkGpuQueryManager::beginSingleQuery(
     const Rc<DxvkCommandList>&  cmd,
     const Rc<DxvkGpuQuery>&     query) {
-    DxvkGpuQueryHandle handle = m_pool->allocQuery(query->type());
-    
-    cmd->resetQuery(
-      handle.queryPool,
-      handle.queryId);
+    DxvkGpuQueryHandle handle = this->allocQuery(query->type());
     
     if (query->isIndexed()) {
       cmd->cmdBeginQueryIndexed(
@@ -414,10 +582,91 @@ namespace dxvk {
         handle.queryId);
     }
 
-    cmd->trackResource<DxvkAccess::None>(query);
+    m_resolveQueries.push_back(handle);
+
+    cmd->trackResource<DxvkAccess::Write>(query);
+  }
+
+
+  void DxvkGpuQueryManager::resolveQueries(
+    const Rc<DxvkCommandList>&  cmd) {
+    if (m_resolveQueries.empty())
+      return;
+
+    // Sort queries so that we can copy the results of
+    // consecutive queries from the same pool at once
+    std::sort(m_resolveQueries.begin(), m_resolveQueries.end(),
+      [] (const DxvkGpuQueryHandle& a, const DxvkGpuQueryHandle& b) {
+        if (a.queryPool != b.queryPool)
+          return a.queryPool < b.queryPool;
+        return a.queryId < b.queryId;
+      });
+
+    size_t first = 0;
+    bool needsBarrier = false;
+
+    for (size_t i = 1; i <= m_resolveQueries.size(); i++) {
+      const auto& base = m_resolveQueries[first];
+
+      if (i < m_resolveQueries.size()
+       && m_resolveQueries[i].queryPool == base.queryPool
+       && m_resolveQueries[i].queryId == base.queryId + (i - first))
+        continue;
+
+      if (base.readback) {
+        VkDeviceSize stride = base.allocator->readbackStride();
+        DxvkBufferSliceHandle slice = base.readback->getSliceHandle();
+
+        cmd->cmdCopyQueryPoolResults(base.queryPool,
+          base.queryId, uint32_t(i - first), slice.handle,
+          slice.offset + base.queryId * stride, stride,
+          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+        needsBarrier = true;
+      }
+
+      first = i;
+    }
+
+    // Make the copied results available to the host
+    if (needsBarrier) {
+      VkMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+      barrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+      barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+      barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+      barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+      VkDependencyInfo depInfo = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+      depInfo.memoryBarrierCount = 1;
+      depInfo.pMemoryBarriers = &barrier;
+
+      cmd->cmdPipelineBarrier(DxvkCmdBuffer::ExecBuffer, &depInfo);
+    }
+
+    m_resolveQueries.clear();
   }
   
   
+  DxvkGpuQueryHandle DxvkGpuQueryManager::allocQuery(
+          VkQueryType           type) {
+    auto& handles = m_freeQueries[getQueryTypeIndex(type)];
+
+    if (handles.empty()) {
+      m_pool->allocQueries(type, handles);
+
+      if (handles.empty())
+        return DxvkGpuQueryHandle();
+
+      // Hand out queries in ascending order
+      std::reverse(handles.begin(), handles.end());
+    }
+
+    DxvkGpuQueryHandle handle = handles.back();
+    handles.pop_back();
+    return handle;
+  }
+
+
   uint32_t DxvkGpuQueryManager::getQueryTypeBit(
           VkQueryType           type) {
     switch (type) {
@@ -430,6 +679,18 @@ namespace dxvk {
   }
 
 
+  uint32_t DxvkGpuQueryManager::getQueryTypeIndex(
+          VkQueryType           type) {
+    switch (type) {
+      case VK_QUERY_TYPE_OCCLUSION:                     return 0;
+      case VK_QUERY_TYPE_PIPELINE_STATISTICS:           return 1;
+      case VK_QUERY_TYPE_TIMESTAMP:                     return 2;
+      case VK_QUERY_TYPE_TRANSFORM_FEEDBACK_STREAM_EXT: return 3;
+      default:                                          return 0;
+    }
+  }
+
+
 
 
   DxvkGpuQueryTracker::DxvkGpuQueryTracker() { }
@@ -443,8 +704,18 @@ namespace dxvk {
 
 
   void DxvkGpuQueryTracker::reset() {
-    for (DxvkGpuQueryHandle handle : m_handles)
-      handle.allocator->freeQuery(handle);
+    // Return consecutive queries from the same
+    // allocator with a single call to reduce locking
+    size_t first = 0;
+
+    for (size_t i = 1; i <= m_handles.size(); i++) {
+      if (i < m_handles.size()
+       && m_handles[i].allocator == m_handles[first].allocator)
+        continue;
+
+      m_handles[first].allocator->freeQueries(i - first, &m_handles[first]);
+      first = i;
+    }
     
     m_handles.clear();
   }
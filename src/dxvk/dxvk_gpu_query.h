@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <mutex>
 #include <vector>
@@ -10,6 +11,7 @@
 
 namespace dxvk {
 
+  class DxvkBuffer;
   class DxvkCommandList;
 
   class DxvkGpuQueryPool;
@@ -29,6 +31,16 @@ namespace dxvk {
   };
 
 
+  /**
+   * \brief Query allocator statistics
+   */
+  struct DxvkGpuQueryStats {
+    uint32_t poolCount;
+    uint32_t queryCount;
+    uint32_t queriesUsed;
+  };
+
+
   /**
    * \brief Occlusion query data
    * 
@@ -99,14 +111,19 @@ namespace dxvk {
    * \brief Query handle
    * 
    * Stores the query allocator, as well as
-   * the actual pool and query index. Since
-   * query pools have to be reset on the GPU,
-   * this also comes with a reset event.
+   * the actual pool and query index. Queries
+   * are reset on the host when the allocator
+   * hands them out, so no reset event is needed.
+   *
+   * Each query pool has a host-visible readback
+   * buffer with one slot per query, into which
+   * query results are copied on the GPU.
    */
   struct DxvkGpuQueryHandle {
     DxvkGpuQueryAllocator* allocator  = nullptr;
     VkQueryPool            queryPool  = VK_NULL_HANDLE;
     uint32_t               queryId    = 0;
+    DxvkBuffer*            readback   = nullptr;
   };
 
 
@@ -233,12 +250,20 @@ namespace dxvk {
     DxvkQueryData       m_queryData = { };
 
     small_vector<DxvkGpuQueryHandle, 8> m_handles;
+    size_t                              m_handlesAccumulated = 0;
     
     DxvkGpuQueryStatus accumulateQueryDataForHandle(
       const DxvkGpuQueryHandle& handle);
 
     DxvkGpuQueryStatus accumulateQueryData();
 
+    DxvkGpuQueryStatus accumulateReadbackData();
+
+    void freeQueryHandles();
+
+    DxvkGpuQueryStatus addQueryData(
+      const DxvkQueryData&      data);
+
   };
 
 
@@ -246,7 +271,13 @@ namespace dxvk {
    * \brief Query allocator
    * 
    * Creates query pools and allocates
-   * queries for a single query type. 
+   * queries for a single query type.
+   *
+   * Free queries are kept in a single list that is
+   * protected by a mutex. Query managers only take
+   * the lock once per slab when allocating queries,
+   * but queries are returned one at a time once
+   * their results have been read.
    */
   class DxvkGpuQueryAllocator {
 
@@ -260,24 +291,53 @@ namespace dxvk {
     ~DxvkGpuQueryAllocator();
 
     /**
-     * \brief Allocates a query
+     * \brief Allocates a slab of queries
      * 
-     * If possible, this returns a free query
-     * from an existing query pool. Otherwise,
-     * a new query pool will be created.
-     * \returns Query handle
+     * Takes up to one slab worth of free queries from
+     * existing query pools, or creates a new query pool
+     * if necessary, and appends them to the given list.
+     * All returned queries will be in reset state.
+     *
+     * The allocator is only locked once per slab, and
+     * queries are reset on the host after releasing the
+     * lock, so callers should cache the returned queries.
+     * \param [out] handles Query handle list
      */
-    DxvkGpuQueryHandle allocQuery();
+    void allocQueries(
+            std::vector<DxvkGpuQueryHandle>& handles);
 
     /**
-     * \brief Recycles a query
-     * 
-     * Returns a query back to the allocator
-     * so that it can be reused. The query
-     * must not be in pending state.
-     * \param [in] handle Query to reset
+     * \brief Recycles multiple queries
+     *
+     * Returns queries back to the allocator so that they
+     * can be reused. Since queries get reset on the host
+     * when they are allocated again, the queries must not
+     * be accessed by any pending command list anymore,
+     * including any copies of the query results.
+     * All queries must belong to this allocator.
+     * \param [in] count Number of queries
+     * \param [in] handles Queries to reset
      */
-    void freeQuery(DxvkGpuQueryHandle handle);
+    void freeQueries(
+            size_t              count,
+      const DxvkGpuQueryHandle* handles);
+
+    /**
+     * \brief Queries allocator statistics
+     * \returns Pool and query counts
+     */
+    DxvkGpuQueryStats getStats() const;
+
+    /**
+     * \brief Size of a readback slot
+     *
+     * Equal to the size of the query
+     * data for the given query type.
+     * \returns Readback slot size, in bytes
+     */
+    VkDeviceSize readbackStride() const {
+      return m_readbackStride;
+    }
 
   private:
 
@@ -285,10 +345,22 @@ namespace dxvk {
     Rc<vk::DeviceFn>  m_vkd;
     VkQueryType       m_queryType;
     uint32_t          m_queryPoolSize;
+    VkDeviceSize      m_readbackStride;
+    uint32_t          m_slabSize;
+
+    std::atomic<uint32_t> m_poolCount = { 0u };
+    std::atomic<uint32_t> m_freeCount = { 0u };
     
     dxvk::mutex                     m_mutex;
     std::vector<DxvkGpuQueryHandle> m_handles;
     std::vector<VkQueryPool>        m_pools;
+    std::vector<Rc<DxvkBuffer>>     m_readbacks;
+
+    Rc<DxvkBuffer> createReadbackBuffer();
+
+    void resetQueries(
+            size_t              count,
+            DxvkGpuQueryHandle* handles);
 
     void createQueryPool();
 
@@ -310,12 +382,20 @@ namespace dxvk {
     ~DxvkGpuQueryPool();
     
     /**
-     * \brief Allocates a single query
+     * \brief Allocates a slab of queries
      * 
      * \param [in] type Query type
-     * \returns Handle to the allocated query
+     * \param [out] handles Query handle list
      */
-    DxvkGpuQueryHandle allocQuery(VkQueryType type);
+    void allocQueries(
+            VkQueryType         type,
+            std::vector<DxvkGpuQueryHandle>& handles);
+
+    /**
+     * \brief Queries allocator statistics
+     * \returns Pool and query counts for all types
+     */
+    DxvkGpuQueryStats getStats() const;
 
   private:
 
@@ -332,6 +412,9 @@ namespace dxvk {
    * 
    * Keeps track of enabled and disabled queries
    * and assigns Vulkan queries to them as needed.
+   * Queries are taken from a per-context list that
+   * is refilled one slab at a time, so that the
+   * global allocators are rarely locked.
    */
   class DxvkGpuQueryManager {
 
@@ -400,12 +483,34 @@ namespace dxvk {
       const Rc<DxvkCommandList>&  cmd,
             VkQueryType           type);
 
+    /**
+     * \brief Copies query results to readback buffers
+     *
+     * Must be called outside of a render pass at the end of a
+     * command list. Copies the results of all queries that were
+     * ended in the command list to the readback buffers of their
+     * query pools in bulk, so that they can be read on the host
+     * directly once the command list has completed execution.
+     * \param [in] cmd Command list
+     */
+    void resolveQueries(
+      const Rc<DxvkCommandList>&  cmd);
+
   private:
 
+    constexpr static uint32_t QueryTypeCount = 4;
+
     DxvkGpuQueryPool*             m_pool;
     uint32_t                      m_activeTypes;
     std::vector<Rc<DxvkGpuQuery>> m_activeQueries;
 
+    std::vector<DxvkGpuQueryHandle> m_resolveQueries;
+
+    std::array<std::vector<DxvkGpuQueryHandle>, QueryTypeCount> m_freeQueries;
+
+    DxvkGpuQueryHandle allocQuery(
+            VkQueryType           type);
+
     void beginSingleQuery(
       const Rc<DxvkCommandList>&  cmd,
       const Rc<DxvkGpuQuery>&     query);
@@ -417,6 +522,9 @@ namespace dxvk {
     static uint32_t getQueryTypeBit(
             VkQueryType           type);
 
+    static uint32_t getQueryTypeIndex(
+            VkQueryType           type);
+
   };
 
 
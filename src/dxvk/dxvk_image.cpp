@@ -209,6 +209,66 @@ namespace dxvk {
   }
 
 
+  bool DxvkImage::canHostCopy(VkImageLayout layout) const {
+    return (m_info.usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT)
+        && (m_device->canUseHostImageCopy(layout));
+  }
+
+
+  void DxvkImage::transitionLayoutOnHost(
+    const VkImageSubresourceRange&  subresources,
+          VkImageLayout             oldLayout,
+          VkImageLayout             newLayout) {
+    VkHostImageLayoutTransitionInfoEXT info = { VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT };
+    info.image            = m_image.image;
+    info.oldLayout        = oldLayout;
+    info.newLayout        = newLayout;
+    info.subresourceRange = subresources;
+
+    VkResult vr = m_vkd->vkTransitionImageLayoutEXT(m_vkd->device(), 1, &info);
+
+    if (vr != VK_SUCCESS)
+      throw DxvkError(str::format("DxvkImage: Host layout transition failed: ", vr));
+  }
+
+
+  void DxvkImage::copyMemoryToImage(
+    const VkImageSubresourceLayers& subresource,
+          VkOffset3D                offset,
+          VkExtent3D                extent,
+          VkImageLayout             layout,
+    const void*                     data,
+          VkDeviceSize              rowPitch,
+          VkDeviceSize              slicePitch) {
+    auto formatInfo = this->formatInfo();
+
+    // Host copies take the memory layout in texels rather than bytes
+    VkMemoryToImageCopyEXT region = { VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT };
+    region.pHostPointer       = data;
+    region.imageSubresource   = subresource;
+    region.imageOffset        = offset;
+    region.imageExtent        = extent;
+
+    if (rowPitch) {
+      region.memoryRowLength = uint32_t(rowPitch / formatInfo->elementSize) * formatInfo->blockSize.width;
+
+      if (slicePitch)
+        region.memoryImageHeight = uint32_t(slicePitch / rowPitch) * formatInfo->blockSize.height;
+    }
+
+    VkCopyMemoryToImageInfoEXT info = { VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT };
+    info.dstImage             = m_image.image;
+    info.dstImageLayout       = layout;
+    info.regionCount          = 1;
+    info.pRegions             = &region;
+
+    VkResult vr = m_vkd->vkCopyMemoryToImageEXT(m_vkd->device(), &info);
+
+    if (vr != VK_SUCCESS)
+      throw DxvkError(str::format("DxvkImage: Host image copy failed: ", vr));
+  }
+
+
   HANDLE DxvkImage::sharedHandle() const {
     HANDLE handle = INVALID_HANDLE_VALUE;
 
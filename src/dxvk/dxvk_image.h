@@ -325,6 +325,55 @@ namespace dxvk {
       return result;
     }
 
+    /**
+     * \brief Checks whether host copies can be used
+     *
+     * Requires the image to be created with the host transfer
+     * usage flag, and the device to support host copies to
+     * images in the given layout.
+     * \param [in] layout Image layout during the copy
+     * \returns \c true if host copies are supported
+     */
+    bool canHostCopy(VkImageLayout layout) const;
+
+    /**
+     * \brief Transitions subresources on the host
+     *
+     * Only safe to call if the image is not in use by the
+     * GPU, and if host copies to both layouts are supported.
+     * \param [in] subresources Image subresources
+     * \param [in] oldLayout Current layout
+     * \param [in] newLayout New layout
+     */
+    void transitionLayoutOnHost(
+      const VkImageSubresourceRange&  subresources,
+            VkImageLayout             oldLayout,
+            VkImageLayout             newLayout);
+
+    /**
+     * \brief Copies data from host memory to the image
+     *
+     * Writes the given region directly from the host. Only safe
+     * to call if the image is not in use by the GPU. The pitches
+     * must be multiples of the format's element size, and zero
+     * pitches indicate that the data is tightly packed.
+     * \param [in] subresource Image subresource to write
+     * \param [in] offset Image offset, in texels
+     * \param [in] extent Image extent, in texels
+     * \param [in] layout Current image layout
+     * \param [in] data Source data
+     * \param [in] rowPitch Source row pitch, in bytes
+     * \param [in] slicePitch Source slice pitch, in bytes
+     */
+    void copyMemoryToImage(
+      const VkImageSubresourceLayers& subresource,
+            VkOffset3D                offset,
+            VkExtent3D                extent,
+            VkImageLayout             layout,
+      const void*                     data,
+            VkDeviceSize              rowPitch,
+            VkDeviceSize              slicePitch);
+
     /**
      * \brief Create a new shared handle to dedicated memory backing the image
      * \returns The shared handle with the type given by DxvkSharedHandleInfo::type
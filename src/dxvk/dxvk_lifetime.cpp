@@ -2,17 +2,34 @@
 
 namespace dxvk {
   
-  DxvkLifetimeTracker:: DxvkLifetimeTracker() { }
+  std::atomic<uint64_t> DxvkLifetimeTracker::s_trackingId = { 0ull };
+
+
+  DxvkLifetimeTracker:: DxvkLifetimeTracker() {
+    nextTrackingId();
+  }
+
+
   DxvkLifetimeTracker::~DxvkLifetimeTracker() { }
   
   
   void DxvkLifetimeTracker::notify() {
     m_resources.clear();
+    nextTrackingId();
   }
 
 
   void DxvkLifetimeTracker::reset() {
     m_resources.clear();
+    nextTrackingId();
+  }
+
+
+  void DxvkLifetimeTracker::nextTrackingId() {
+    // Resources store the ID of the last command list that tracked
+    // them, so IDs must never be reused. Zero is never a valid ID.
+    m_trackingId = ++s_trackingId;
+    m_skipCount = 0;
   }
   
-}
\ No newline at end of file
+}
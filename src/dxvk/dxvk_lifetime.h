@@ -97,11 +97,35 @@ namespace dxvk {
     
     /**
      * \brief Adds a resource to track
+     *
+     * Resources that are already being tracked with
+     * the same access type are skipped, since each
+     * reference requires two atomic operations.
      * \param [in] rc The resource to track
      */
     template<DxvkAccess Access>
     void trackResource(DxvkResource* rc) {
-      m_resources.emplace_back(rc, Access);
+      if (rc->updateTrackingId(Access, m_trackingId)) {
+        m_resources.emplace_back(rc, Access);
+      } else {
+        m_skipCount += 1;
+      }
+    }
+
+    /**
+     * \brief Number of tracked resource references
+     * \returns Number of tracked references
+     */
+    size_t trackCount() const {
+      return m_resources.size();
+    }
+
+    /**
+     * \brief Number of redundant references skipped
+     * \returns Number of skipped references
+     */
+    size_t skipCount() const {
+      return m_skipCount;
     }
 
     /**
@@ -122,6 +146,13 @@ namespace dxvk {
   private:
     
     std::vector<DxvkLifetime> m_resources;
+
+    uint64_t                  m_trackingId = 0;
+    size_t                    m_skipCount  = 0;
+
+    void nextTrackingId();
+
+    static std::atomic<uint64_t> s_trackingId;
     
   };
   
@@ -24,6 +24,9 @@ namespace dxvk {
     /// Enables pipeline lifetime tracking
     Tristate trackPipelineLifetime;
 
+    /// Enables host image copies for texture uploads
+    bool enableHostImageCopy;
+
     /// Shader-related options
     Tristate useRawSsbo;
 
@@ -37,6 +40,14 @@ namespace dxvk {
     /// or FIFO_RELAXED (if false) present mode
     Tristate tearFree;
 
+    /// Delays the start of each frame in order
+    /// to keep the GPU queue as short as possible
+    bool lowLatency;
+
+    /// Records GPU timestamps around render
+    /// passes and other GPU operations
+    bool enableGpuProfiler;
+
     // Hides integrated GPUs if dedicated GPUs are
     // present. May be necessary for some games that
     // incorrectly assume monitor layouts.
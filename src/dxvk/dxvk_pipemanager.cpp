@@ -160,8 +160,10 @@ namespace dxvk {
       }
 
       if (entry.pipelineLibrary) {
+        DXVK_PROFILE_ZONE("pipeline", "Compile library");
         entry.pipelineLibrary->compilePipeline();
       } else if (entry.graphicsPipeline) {
+        DXVK_PROFILE_ZONE("pipeline", "Compile pipeline");
         entry.graphicsPipeline->compilePipeline(entry.graphicsState);
         entry.graphicsPipeline->releasePipeline();
       }
@@ -68,6 +68,9 @@ namespace dxvk {
   VkResult Presenter::presentImage(
           VkPresentModeKHR  mode,
           uint64_t          frameId) {
+    DXVK_PROFILE_ZONE("present", "Present");
+    Profiler::endFrame();
+
     PresenterSync sync = m_semaphores.at(m_frameIndex);
 
     VkPresentIdKHR presentId = { VK_STRUCTURE_TYPE_PRESENT_ID_KHR };
@@ -119,6 +122,32 @@ namespace dxvk {
     if (m_signal == nullptr || !frameId)
       return;
 
+    { std::lock_guard<dxvk::mutex> lock(m_latencyMutex);
+
+      auto& frame = getLatencyFrame(frameId);
+      frame.gpuDone = dxvk::high_resolution_clock::now();
+
+      // Estimate how long the GPU needs to finish a frame after the
+      // app has submitted it, or after the previous frame completed.
+      auto& prev = m_latencyFrames[(frameId - 1) % LatencyFrameCount];
+      auto gpuStart = frame.frameEnd;
+
+      if (prev.frameId == frameId - 1)
+        gpuStart = std::max(gpuStart, prev.gpuDone);
+
+      if (gpuStart != dxvk::high_resolution_clock::time_point()) {
+        auto gpuTime = std::chrono::duration_cast<std::chrono::microseconds>(frame.gpuDone - gpuStart);
+        m_latencyGpuUs = 0.9 * m_latencyGpuUs + 0.1 * double(std::max<int64_t>(gpuTime.count(), 0));
+      }
+
+      if (frame.frameStart != dxvk::high_resolution_clock::time_point()) {
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(frame.gpuDone - frame.frameStart);
+
+        m_device->addStatCtr(DxvkStatCounter::FrameLatencyCount, 1);
+        m_device->addStatCtr(DxvkStatCounter::FrameLatencyTicks, latency.count());
+      }
+    }
+
     if (m_device->features().khrPresentWait.presentWait) {
       std::lock_guard<dxvk::mutex> lock(m_frameMutex);
 
@@ -138,6 +167,62 @@ namespace dxvk {
   }
 
 
+  void Presenter::latencySleep(
+          uint64_t          frameId) {
+    auto t0 = dxvk::high_resolution_clock::now();
+
+    { std::lock_guard<dxvk::mutex> lock(m_latencyMutex);
+
+      auto& frame = getLatencyFrame(frameId);
+      frame.frameEnd = t0;
+
+      if (frame.frameStart != dxvk::high_resolution_clock::time_point()) {
+        auto cpuTime = std::chrono::duration_cast<std::chrono::microseconds>(frame.frameEnd - frame.frameStart);
+        m_latencyCpuUs = 0.9 * m_latencyCpuUs + 0.1 * double(cpuTime.count());
+      }
+    }
+
+    if (m_device->config().lowLatency && m_signal != nullptr && frameId > 1) {
+      // Keep at most one frame in flight on the GPU. If present wait
+      // is supported, this also waits for the previous frame to be
+      // displayed in FIFO modes.
+      m_signal->wait(frameId - 1);
+
+      auto t1 = dxvk::high_resolution_clock::now();
+      auto target = t1;
+
+      { std::lock_guard<dxvk::mutex> lock(m_latencyMutex);
+
+        // The GPU starts working on the current frame once the previous
+        // one is done, so start the next frame in such a way that its
+        // CPU work completes around the time the GPU becomes idle.
+        auto& prev = m_latencyFrames[(frameId - 1) % LatencyFrameCount];
+
+        if (prev.frameId == frameId - 1 && m_latencyGpuUs > m_latencyCpuUs) {
+          auto gpuStart = std::max(prev.gpuDone, t0);
+          target = gpuStart + std::chrono::microseconds(uint64_t(m_latencyGpuUs - m_latencyCpuUs));
+        }
+      }
+
+      if (target > t1) {
+        auto t2 = Sleep::sleepUntil(t1, target);
+
+        m_device->addStatCtr(DxvkStatCounter::FrameSleepTicks,
+          std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count());
+      }
+    }
+  }
+
+
+  void Presenter::beginFrame(
+          uint64_t          frameId) {
+    std::lock_guard<dxvk::mutex> lock(m_latencyMutex);
+
+    auto& frame = getLatencyFrame(frameId);
+    frame.frameStart = dxvk::high_resolution_clock::now();
+  }
+
+
   VkResult Presenter::recreateSurface(
     const std::function<VkResult (VkSurfaceKHR*)>& fn) {
     if (m_swapchain)
@@ -649,7 +734,35 @@ namespace dxvk {
     bool vsync = mode == VK_PRESENT_MODE_FIFO_KHR
               || mode == VK_PRESENT_MODE_FIFO_RELAXED_KHR;
 
-    m_fpsLimiter.delay(vsync);
+    static_assert(uint32_t(DxvkStatCounter::FramePacingBin6) + 1u
+      == uint32_t(DxvkStatCounter::FramePacingBin0) + FpsLimiter::ErrorBinCount);
+
+    auto result = m_fpsLimiter.delay(vsync);
+
+    if (result.late) {
+      auto us = std::chrono::duration_cast<std::chrono::microseconds>(result.error);
+
+      m_device->addStatCtr(DxvkStatCounter::FramePacingLate, 1);
+      m_device->addStatCtr(DxvkStatCounter::FramePacingLateTicks, us.count());
+    } else if (result.error >= FpsLimiter::TimerDuration::zero()) {
+      uint32_t bin = FpsLimiter::getErrorBin(result.error);
+
+      m_device->addStatCtr(DxvkStatCounter(
+        uint32_t(DxvkStatCounter::FramePacingBin0) + bin), 1);
+    }
+  }
+
+
+  PresenterLatency& Presenter::getLatencyFrame(
+          uint64_t                  frameId) {
+    auto& frame = m_latencyFrames[frameId % LatencyFrameCount];
+
+    if (frame.frameId != frameId) {
+      frame = PresenterLatency();
+      frame.frameId = frameId;
+    }
+
+    return frame;
   }
 
 
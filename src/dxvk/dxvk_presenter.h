@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <functional>
 #include <vector>
 
@@ -8,6 +9,7 @@
 #include "../util/util_error.h"
 #include "../util/util_fps_limiter.h"
 #include "../util/util_math.h"
+#include "../util/util_sleep.h"
 #include "../util/util_string.h"
 
 #include "../util/sync/sync_signal.h"
@@ -79,6 +81,19 @@ namespace dxvk {
     VkResult          result;
   };
 
+  /**
+   * \brief Frame timing info
+   *
+   * Stores CPU timestamps for a single frame, used to
+   * measure latency and for low-latency frame pacing.
+   */
+  struct PresenterLatency {
+    uint64_t                                    frameId = 0;
+    dxvk::high_resolution_clock::time_point     frameStart;
+    dxvk::high_resolution_clock::time_point     frameEnd;
+    dxvk::high_resolution_clock::time_point     gpuDone;
+  };
+
   /**
    * \brief Vulkan presenter
    * 
@@ -159,6 +174,31 @@ namespace dxvk {
             VkPresentModeKHR  mode,
             uint64_t          frameId);
 
+    /**
+     * \brief Ends CPU work for the given frame
+     *
+     * Must be called by the application thread after the frame
+     * has been submitted for presentation. Records frame timings
+     * and, if low-latency mode is enabled, waits for the previous
+     * frame to complete and delays the calling thread so that the
+     * next frame's commands reach the GPU just as it becomes idle.
+     * Any frame latency wait should be performed after this.
+     * \param [in] frameId Frame number of the submitted frame
+     */
+    void latencySleep(
+            uint64_t          frameId);
+
+    /**
+     * \brief Begins CPU work for the given frame
+     *
+     * Must be called once the application thread returns
+     * control to the application after presenting the
+     * previous frame, including any frame latency waits.
+     * \param [in] frameId Frame number of the next frame
+     */
+    void beginFrame(
+            uint64_t          frameId);
+
     /**
      * \brief Changes and takes ownership of surface
      *
@@ -256,6 +296,14 @@ namespace dxvk {
 
     std::atomic<uint64_t>       m_lastFrameId = { 0ull };
 
+    constexpr static size_t LatencyFrameCount = 16;
+
+    dxvk::mutex                 m_latencyMutex;
+    std::array<PresenterLatency, LatencyFrameCount> m_latencyFrames = { };
+
+    double                      m_latencyCpuUs = 0.0;
+    double                      m_latencyGpuUs = 0.0;
+
     VkResult recreateSwapChainInternal(
       const PresenterDesc&  desc);
 
@@ -299,6 +347,9 @@ namespace dxvk {
 
     void runFrameThread();
 
+    PresenterLatency& getLatencyFrame(
+            uint64_t                  frameId);
+
   };
 
 }
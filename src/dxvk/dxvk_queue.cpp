@@ -37,7 +37,7 @@ namespace dxvk {
     entry.status = status;
     entry.submit = std::move(submitInfo);
 
-    m_submitQueue.push(std::move(entry));
+    m_submitQueue.push_back(std::move(entry));
     m_appendCond.notify_all();
   }
 
@@ -49,7 +49,7 @@ namespace dxvk {
     entry.status  = status;
     entry.present = std::move(presentInfo);
 
-    m_submitQueue.push(std::move(entry));
+    m_submitQueue.push_back(std::move(entry));
     m_appendCond.notify_all();
   }
 
@@ -115,17 +115,28 @@ namespace dxvk {
       if (m_stopped.load())
         return;
       
-      DxvkSubmitEntry entry = std::move(m_submitQueue.front());
+      // Submit all consecutive command lists that
+      // can be batched together in one go
+      size_t batchSize = getBatchSize();
+
+      for (size_t i = 0; i < batchSize; i++)
+        m_batchEntries.push_back(std::move(m_submitQueue[i]));
+
       lock.unlock();
 
       // Submit command buffer to device
       if (m_lastError != VK_ERROR_DEVICE_LOST) {
         std::lock_guard<dxvk::mutex> lock(m_mutexQueue);
+        DXVK_PROFILE_ZONE("queue", "Submit");
 
         if (m_callback)
           m_callback(true);
 
-        if (entry.submit.cmdList != nullptr)
+        DxvkSubmitEntry& entry = m_batchEntries.front();
+
+        if (m_batchEntries.size() > 1)
+          submitBatch();
+        else if (entry.submit.cmdList != nullptr)
           entry.result = entry.submit.cmdList->submit();
         else if (entry.present.presenter != nullptr)
           entry.result = entry.present.presenter->presentImage(entry.present.presentMode, entry.present.frameId);
@@ -135,32 +146,77 @@ namespace dxvk {
       } else {
         // Don't submit anything after device loss
         // so that drivers get a chance to recover
-        entry.result = VK_ERROR_DEVICE_LOST;
+        for (auto& entry : m_batchEntries)
+          entry.result = VK_ERROR_DEVICE_LOST;
       }
 
-      if (entry.status)
-        entry.status->result = entry.result;
+      for (const auto& entry : m_batchEntries) {
+        if (entry.status)
+          entry.status->result = entry.result;
+      }
       
       // On success, pass it on to the queue thread
       lock = std::unique_lock<dxvk::mutex>(m_mutex);
 
-      bool doForward = (entry.result == VK_SUCCESS) ||
-        (entry.present.presenter != nullptr && entry.result != VK_ERROR_DEVICE_LOST);
+      for (auto& entry : m_batchEntries) {
+        bool doForward = (entry.result == VK_SUCCESS) ||
+          (entry.present.presenter != nullptr && entry.result != VK_ERROR_DEVICE_LOST);
 
-      if (doForward) {
-        m_finishQueue.push(std::move(entry));
-      } else {
-        Logger::err(str::format("DxvkSubmissionQueue: Command submission failed: ", entry.result));
-        m_lastError = entry.result;
+        if (doForward) {
+          m_finishQueue.push(std::move(entry));
+        } else {
+          Logger::err(str::format("DxvkSubmissionQueue: Command submission failed: ", entry.result));
+          m_lastError = entry.result;
 
-        if (m_lastError != VK_ERROR_DEVICE_LOST)
-          m_device->waitForIdle();
+          if (m_lastError != VK_ERROR_DEVICE_LOST)
+            m_device->waitForIdle();
+        }
+
+        m_submitQueue.pop_front();
       }
 
-      m_submitQueue.pop();
+      m_batchEntries.clear();
       m_submitCond.notify_all();
     }
   }
+
+
+  size_t DxvkSubmissionQueue::getBatchSize() const {
+    size_t count = 0;
+
+    while (count < m_submitQueue.size()) {
+      const auto& cmdList = m_submitQueue[count].submit.cmdList;
+
+      if (cmdList == nullptr || !cmdList->canBatchSubmit())
+        break;
+
+      count += 1;
+    }
+
+    return std::max<size_t>(count, 1);
+  }
+
+
+  void DxvkSubmissionQueue::submitBatch() {
+    const auto& lastCmdList = m_batchEntries.back().submit.cmdList;
+
+    // Only signal the fence of the last command list in the batch,
+    // and make all prior command lists wait on that fence instead.
+    for (auto& entry : m_batchEntries) {
+      bool isLast = entry.submit.cmdList == lastCmdList;
+
+      entry.submit.cmdList->appendSubmission(m_batch, isLast);
+
+      if (!isLast)
+        entry.fenceCmdList = lastCmdList;
+    }
+
+    VkResult vr = m_batch.submit(m_device,
+      m_device->queues().graphics.queueHandle);
+
+    for (auto& entry : m_batchEntries)
+      entry.result = vr;
+  }
   
   
   void DxvkSubmissionQueue::finishCmdLists() {
@@ -189,8 +245,11 @@ namespace dxvk {
       if (entry.submit.cmdList != nullptr) {
         VkResult status = m_lastError.load();
         
-        if (status != VK_ERROR_DEVICE_LOST)
-          status = entry.submit.cmdList->synchronizeFence();
+        if (status != VK_ERROR_DEVICE_LOST) {
+          status = entry.fenceCmdList != nullptr
+            ? entry.fenceCmdList->synchronizeFence()
+            : entry.submit.cmdList->synchronizeFence();
+        }
         
         if (status != VK_SUCCESS) {
           m_lastError = status;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <queue>
 
@@ -50,12 +51,17 @@ namespace dxvk {
 
   /**
    * \brief Submission queue entry
+   *
+   * If the command list was submitted as part of a larger
+   * batch, \c fenceCmdList points to the command list whose
+   * fence is signaled once the entire batch has completed.
    */
   struct DxvkSubmitEntry {
     VkResult            result;
     DxvkSubmitStatus*   status;
     DxvkSubmitInfo      submit;
     DxvkPresentInfo     present;
+    Rc<DxvkCommandList> fenceCmdList;
   };
 
 
@@ -191,14 +197,21 @@ namespace dxvk {
     dxvk::condition_variable    m_submitCond;
     dxvk::condition_variable    m_finishCond;
 
-    std::queue<DxvkSubmitEntry> m_submitQueue;
+    std::deque<DxvkSubmitEntry> m_submitQueue;
     std::queue<DxvkSubmitEntry> m_finishQueue;
 
+    DxvkCommandSubmission       m_batch;
+    std::vector<DxvkSubmitEntry> m_batchEntries;
+
     dxvk::thread                m_submitThread;
     dxvk::thread                m_finishThread;
 
     void submitCmdLists();
 
+    size_t getBatchSize() const;
+
+    void submitBatch();
+
     void finishCmdLists();
     
   };
@@ -7,6 +7,8 @@ namespace dxvk {
 
   DxvkResource::DxvkResource()
   : m_useCount(0ull), m_cookie(++s_cookie) {
+    for (auto& id : m_trackingIds)
+      id.store(0ull, std::memory_order_relaxed);
 
   }
 
@@ -102,12 +102,36 @@ namespace dxvk {
         mask |= RdAccessMask;
       return bool(m_useCount.load() & mask);
     }
+
+    /**
+     * \brief Updates tracking ID for the given access
+     *
+     * Used by lifetime trackers to only track the resource once
+     * per command list and access type. Since tracking IDs are
+     * unique, using the resource from multiple command lists
+     * at the same time can at worst lead to redundant tracking.
+     * \param [in] access Access type
+     * \param [in] trackingId Tracking ID of the command list
+     * \returns \c true if the resource was not yet tracked
+     *    with the given tracking ID and access type
+     */
+    bool updateTrackingId(DxvkAccess access, uint64_t trackingId) {
+      auto& id = m_trackingIds[uint32_t(access)];
+
+      if (id.load(std::memory_order_relaxed) == trackingId)
+        return false;
+
+      id.store(trackingId, std::memory_order_relaxed);
+      return true;
+    }
     
   private:
     
     std::atomic<uint64_t> m_useCount;
     uint64_t              m_cookie;
 
+    std::array<std::atomic<uint64_t>, 3> m_trackingIds;
+
     static constexpr uint64_t getIncrement(DxvkAccess access) {
       uint64_t increment = RefcountInc;
 
@@ -30,5 +30,86 @@ namespace dxvk {
     for (size_t i = 0; i < m_counters.size(); i++)
       m_counters[i] = 0;
   }
+
+  
+  const char* DxvkStatCounters::getCtrName(DxvkStatCounter ctr) {
+    switch (ctr) {
+#define CTR_NAME(name) case DxvkStatCounter::name: return #name
+      CTR_NAME(CmdDrawCalls);
+      CTR_NAME(CmdDispatchCalls);
+      CTR_NAME(CmdRenderPassCount);
+      CTR_NAME(CmdBarrierCount);
+      CTR_NAME(CmdCopyMergeCount);
+      CTR_NAME(PipeCountGraphics);
+      CTR_NAME(PipeCountLibrary);
+      CTR_NAME(PipeCountCompute);
+      CTR_NAME(PipeTasksDone);
+      CTR_NAME(PipeTasksTotal);
+      CTR_NAME(QueueSubmitCount);
+      CTR_NAME(QueueCmdListCount);
+      CTR_NAME(QueuePresentCount);
+      CTR_NAME(FrameLatencyCount);
+      CTR_NAME(FrameLatencyTicks);
+      CTR_NAME(FrameSleepTicks);
+      CTR_NAME(FramePacingBin0);
+      CTR_NAME(FramePacingBin1);
+      CTR_NAME(FramePacingBin2);
+      CTR_NAME(FramePacingBin3);
+      CTR_NAME(FramePacingBin4);
+      CTR_NAME(FramePacingBin5);
+      CTR_NAME(FramePacingBin6);
+      CTR_NAME(FramePacingLate);
+      CTR_NAME(FramePacingLateTicks);
+      CTR_NAME(GpuSyncCount);
+      CTR_NAME(GpuSyncTicks);
+      CTR_NAME(GpuIdleTicks);
+      CTR_NAME(GpuTimeRenderPass);
+      CTR_NAME(GpuTimeCompute);
+      CTR_NAME(GpuTimeBlit);
+      CTR_NAME(GpuTimeClear);
+      CTR_NAME(GpuTimeResolve);
+      CTR_NAME(GpuTimeTransfer);
+      CTR_NAME(CsSyncCount);
+      CTR_NAME(CsSyncTicks);
+      CTR_NAME(CsChunkCount);
+      CTR_NAME(CsChunkBytes);
+      CTR_NAME(CsCommandBytes);
+      CTR_NAME(CsChunkLatency);
+      CTR_NAME(CsCmdListBatchCount);
+      CTR_NAME(InitUploadBytes);
+      CTR_NAME(ImageHostCopyBytes);
+      CTR_NAME(InitTextureTicks);
+      CTR_NAME(ResourceTrackCount);
+      CTR_NAME(ResourceTrackSkipped);
+      CTR_NAME(DescriptorPoolCount);
+      CTR_NAME(DescriptorSetCount);
+      CTR_NAME(QueryPoolCount);
+      CTR_NAME(QueryCount);
+      CTR_NAME(QueryUsedCount);
+      CTR_NAME(StateBlendElided);
+      CTR_NAME(StateDepthStencilElided);
+      CTR_NAME(StateRasterizerElided);
+#undef CTR_NAME
+      default: return "Unknown";
+    }
+  }
+
+
+  bool DxvkStatCounters::isCtrAbsolute(DxvkStatCounter ctr) {
+    switch (ctr) {
+      case DxvkStatCounter::PipeCountGraphics:
+      case DxvkStatCounter::PipeCountLibrary:
+      case DxvkStatCounter::PipeCountCompute:
+      case DxvkStatCounter::DescriptorPoolCount:
+      case DxvkStatCounter::DescriptorSetCount:
+      case DxvkStatCounter::QueryPoolCount:
+      case DxvkStatCounter::QueryCount:
+      case DxvkStatCounter::QueryUsedCount:
+        return true;
+
+      default:
+        return false;
+    }
+  }
   
 }
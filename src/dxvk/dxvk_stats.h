@@ -15,21 +15,56 @@ namespace dxvk {
     CmdDispatchCalls,         ///< Number of compute calls
     CmdRenderPassCount,       ///< Number of render passes
     CmdBarrierCount,          ///< Number of pipeline barriers
+    CmdCopyMergeCount,        ///< Buffer copies merged into other copies
     PipeCountGraphics,        ///< Number of graphics pipelines
     PipeCountLibrary,         ///< Number of graphics shader libraries
     PipeCountCompute,         ///< Number of compute pipelines
     PipeTasksDone,            ///< Boolean indicating compiler activity
     PipeTasksTotal,           ///< Boolean indicating compiler activity
-    QueueSubmitCount,         ///< Number of command buffer submissions
+    QueueSubmitCount,         ///< Number of queue submissions
+    QueueCmdListCount,        ///< Number of submitted command lists
     QueuePresentCount,        ///< Number of present calls / frames
+    FrameLatencyCount,        ///< Frames with measured latency
+    FrameLatencyTicks,        ///< Frame start to GPU completion in microseconds
+    FrameSleepTicks,          ///< Time spent in low-latency frame pacing
+    FramePacingBin0,          ///< Frame limiter wakeups less than 20us late
+    FramePacingBin1,          ///< Frame limiter wakeups less than 50us late
+    FramePacingBin2,          ///< Frame limiter wakeups less than 100us late
+    FramePacingBin3,          ///< Frame limiter wakeups less than 250us late
+    FramePacingBin4,          ///< Frame limiter wakeups less than 500us late
+    FramePacingBin5,          ///< Frame limiter wakeups less than 1ms late
+    FramePacingBin6,          ///< Frame limiter wakeups at least 1ms late
+    FramePacingLate,          ///< Frames that missed their target before the limiter
+    FramePacingLateTicks,     ///< Time by which late frames missed their target, in microseconds
     GpuSyncCount,             ///< Number of GPU synchronizations
     GpuSyncTicks,             ///< Time spent waiting for GPU
     GpuIdleTicks,             ///< GPU idle time in microseconds
+    GpuTimeRenderPass,        ///< GPU time spent in render passes, in nanoseconds
+    GpuTimeCompute,           ///< GPU time spent in compute dispatches, in nanoseconds
+    GpuTimeBlit,              ///< GPU time spent in blits, in nanoseconds
+    GpuTimeClear,             ///< GPU time spent in clears, in nanoseconds
+    GpuTimeResolve,           ///< GPU time spent in resolves, in nanoseconds
+    GpuTimeTransfer,          ///< GPU time spent in copies, in nanoseconds
     CsSyncCount,              ///< CS thread synchronizations
     CsSyncTicks,              ///< Time spent waiting on CS
     CsChunkCount,             ///< Submitted CS chunks
+    CsChunkBytes,             ///< Block size of submitted CS chunks
+    CsCommandBytes,           ///< Size of commands in submitted CS chunks
+    CsChunkLatency,           ///< Time between dispatching and executing chunks
+    CsCmdListBatchCount,      ///< Command lists dispatched as one CS command
+    InitUploadBytes,          ///< Initial data uploaded via staging memory
+    ImageHostCopyBytes,       ///< Texture data written directly by the host
+    InitTextureTicks,         ///< Time spent initializing textures
+    ResourceTrackCount,       ///< Resource references held by command lists
+    ResourceTrackSkipped,     ///< Redundant resource references skipped
     DescriptorPoolCount,      ///< Descriptor pool count
     DescriptorSetCount,       ///< Descriptor sets allocated
+    QueryPoolCount,           ///< Vulkan query pool count
+    QueryCount,               ///< Vulkan queries allocated
+    QueryUsedCount,           ///< Vulkan queries in use
+    StateBlendElided,         ///< Redundant blend state changes
+    StateDepthStencilElided,  ///< Redundant depth-stencil state changes
+    StateRasterizerElided,    ///< Redundant rasterizer state changes
     NumCounters,              ///< Number of counters available
   };
   
@@ -109,6 +144,25 @@ namespace dxvk {
      * Sets all counters to zero.
      */
     void reset();
+
+    /**
+     * \brief Retrieves counter name
+     *
+     * \param [in] ctr The counter
+     * \returns Counter name
+     */
+    static const char* getCtrName(DxvkStatCounter ctr);
+
+    /**
+     * \brief Checks whether a counter stores an absolute value
+     *
+     * Absolute counters such as object counts store the current
+     * value rather than a running total, so the difference
+     * between two samples is not meaningful.
+     * \param [in] ctr The counter
+     * \returns \c true for absolute counters
+     */
+    static bool isCtrAbsolute(DxvkStatCounter ctr);
     
   private:
     
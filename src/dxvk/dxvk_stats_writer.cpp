@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <utility>
+
+#include "dxvk_device.h"
+#include "dxvk_stats_writer.h"
+
+namespace dxvk {
+
+  DxvkStatsWriter::DxvkStatsWriter(
+          DxvkDevice*           device,
+    const std::string&          fileName)
+  : m_device    (device),
+    m_heapCount (device->adapter()->memoryProperties().memoryHeapCount),
+    m_fileName  (fileName),
+    m_file      (str::topath(fileName.c_str()).c_str()) {
+    m_columns.push_back("Frame");
+    m_columns.push_back("TimeUs");
+    m_columns.push_back("FrameTimeUs");
+
+    for (uint32_t i = 0; i < uint32_t(DxvkStatCounter::NumCounters); i++)
+      m_columns.push_back(DxvkStatCounters::getCtrName(DxvkStatCounter(i)));
+
+    for (uint32_t i = 0; i < m_heapCount; i++) {
+      m_columns.push_back(str::format("Heap", i, "AllocatedMiB"));
+      m_columns.push_back(str::format("Heap", i, "UsedMiB"));
+    }
+
+    for (size_t i = 0; i < m_columns.size(); i++)
+      m_file << (i ? "," : "") << m_columns[i];
+
+    m_file << std::endl;
+
+    m_ring.resize(RingSize * m_columns.size());
+    m_samples.resize(SampleCount * m_columns.size());
+    m_minValues.resize(m_columns.size(), ~0ull);
+    m_maxValues.resize(m_columns.size(), 0ull);
+    m_sums.resize(m_columns.size(), 0.0);
+
+    m_thread = dxvk::thread([this] { runWriter(); });
+  }
+
+
+  DxvkStatsWriter::~DxvkStatsWriter() {
+    // If the process is exiting, the writer thread has already
+    // been terminated, possibly while holding the lock or while
+    // writing a row, so neither join it nor write the summary.
+    if (this_thread::isInModuleDetachment()) {
+      m_thread.detach();
+      return;
+    }
+
+    { std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_stopped.store(true);
+      m_cond.notify_one();
+    }
+
+    m_thread.join();
+
+    this->writeSummary();
+  }
+
+
+  void DxvkStatsWriter::recordFrame() {
+    auto now = dxvk::high_resolution_clock::now();
+
+    DxvkStatCounters counters = m_device->getStatCounters();
+    DxvkStatCounters diff = counters.diff(m_prevCounters);
+    m_prevCounters = counters;
+
+    // Start measuring at the first present, otherwise the first
+    // row would include all the work done during initialization
+    if (!std::exchange(m_started, true)) {
+      m_startTime = now;
+      m_lastFrame = now;
+      return;
+    }
+
+    uint64_t frameId = m_frameId++;
+
+    // Never block the calling thread on I/O,
+    // just drop the frame if the ring is full
+    uint64_t writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+    uint64_t readIndex = m_readIndex.load(std::memory_order_acquire);
+
+    if (writeIndex - readIndex >= RingSize) {
+      m_dropCount += 1;
+      m_lastFrame = now;
+      return;
+    }
+
+    uint64_t* row = &m_ring[(writeIndex % RingSize) * m_columns.size()];
+    *(row++) = frameId;
+    *(row++) = std::chrono::duration_cast<std::chrono::microseconds>(now - m_startTime).count();
+    *(row++) = std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastFrame).count();
+
+    for (uint32_t i = 0; i < uint32_t(DxvkStatCounter::NumCounters); i++) {
+      DxvkStatCounter ctr = DxvkStatCounter(i);
+
+      *(row++) = DxvkStatCounters::isCtrAbsolute(ctr)
+        ? counters.getCtr(ctr)
+        : diff.getCtr(ctr);
+    }
+
+    for (uint32_t i = 0; i < m_heapCount; i++) {
+      DxvkMemoryStats stats = m_device->getMemoryStats(i);
+      *(row++) = stats.memoryAllocated >> 20;
+      *(row++) = stats.memoryUsed >> 20;
+    }
+
+    m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+    m_lastFrame = now;
+  }
+
+
+  std::unique_ptr<DxvkStatsWriter> DxvkStatsWriter::create(
+          DxvkDevice*           device) {
+    static std::atomic<uint32_t> s_streamCount = { 0u };
+
+    std::string path = env::getEnvVar("DXVK_STATS_PATH");
+
+    if (path.empty())
+      return nullptr;
+
+    if (*path.rbegin() != '/')
+      path += '/';
+
+    uint32_t index = s_streamCount++;
+
+    std::string fileName = str::format(path, env::getExeBaseName(), "_stats",
+      index ? str::format("_", index) : std::string(), ".csv");
+
+    auto result = std::make_unique<DxvkStatsWriter>(device, fileName);
+
+    if (!result->m_file) {
+      Logger::err(str::format("DXVK: Failed to open ", fileName));
+      return nullptr;
+    }
+
+    Logger::info(str::format("DXVK: Writing stats to ", fileName));
+    return result;
+  }
+
+
+  void DxvkStatsWriter::runWriter() {
+    env::setThreadName("dxvk-stats");
+
+    bool stopped = false;
+
+    while (!stopped) {
+      { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+        // Frames are not signaled individually, polling
+        // keeps the present path free of any locking
+        m_cond.wait_for(lock, std::chrono::milliseconds(100), [this] {
+          return m_stopped.load();
+        });
+
+        stopped = m_stopped.load();
+      }
+
+      uint64_t readIndex = m_readIndex.load(std::memory_order_relaxed);
+      uint64_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+
+      for (uint64_t i = readIndex; i < writeIndex; i++) {
+        this->writeRow(&m_ring[(i % RingSize) * m_columns.size()]);
+        m_readIndex.store(i + 1, std::memory_order_release);
+      }
+
+      if (readIndex != writeIndex)
+        m_file.flush();
+    }
+  }
+
+
+  void DxvkStatsWriter::writeRow(
+    const uint64_t*             row) {
+    for (size_t i = 0; i < m_columns.size(); i++) {
+      m_file << (i ? "," : "") << row[i];
+
+      m_minValues[i] = std::min(m_minValues[i], row[i]);
+      m_maxValues[i] = std::max(m_maxValues[i], row[i]);
+      m_sums[i] += double(row[i]);
+    }
+
+    m_file << "\n";
+
+    // Reservoir sampling, so that each row has
+    // the same probability of being sampled
+    uint64_t sampleIndex = m_rowCount < SampleCount
+      ? m_rowCount : m_random() % (m_rowCount + 1);
+
+    if (sampleIndex < SampleCount) {
+      std::copy(row, row + m_columns.size(),
+        &m_samples[sampleIndex * m_columns.size()]);
+    }
+
+    m_rowCount += 1;
+  }
+
+
+  void DxvkStatsWriter::writeSummary() {
+    if (!m_rowCount)
+      return;
+
+    std::string fileName = m_fileName;
+    size_t ext = env::matchFileExtension(fileName, "csv");
+
+    if (ext != std::string::npos)
+      fileName.erase(ext);
+
+    fileName += "_summary.csv";
+
+    std::ofstream file(str::topath(fileName.c_str()).c_str());
+
+    if (!file) {
+      Logger::err(str::format("DXVK: Failed to open ", fileName));
+      return;
+    }
+
+    file << "Column,Mean,Min,P50,P90,P99,Max" << std::endl;
+
+    size_t sampleCount = std::min<uint64_t>(m_rowCount, SampleCount);
+    std::vector<uint64_t> values(sampleCount);
+
+    // Skip frame index and timestamp columns
+    for (size_t i = 2; i < m_columns.size(); i++) {
+      for (size_t j = 0; j < sampleCount; j++)
+        values[j] = m_samples[j * m_columns.size() + i];
+
+      std::sort(values.begin(), values.end());
+
+      auto percentile = [&values] (uint32_t p) {
+        return values[(values.size() - 1) * p / 100];
+      };
+
+      file << m_columns[i] << ","
+           << m_sums[i] / double(m_rowCount) << ","
+           << m_minValues[i] << ","
+           << percentile(50) << ","
+           << percentile(90) << ","
+           << percentile(99) << ","
+           << m_maxValues[i] << std::endl;
+    }
+
+    Logger::info(str::format("DXVK: Wrote stats for ", m_rowCount, " frames (",
+      m_dropCount.load(), " dropped) to ", fileName));
+  }
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "dxvk_stats.h"
+
+#include "../util/thread.h"
+#include "../util/util_time.h"
+
+namespace dxvk {
+
+  class DxvkDevice;
+
+  /**
+   * \brief Stat counter stream
+   *
+   * Writes one CSV row per presented frame, containing the frame
+   * time, the per-frame change of all stat counters, the current
+   * value of absolute counters, and memory usage per heap. Times
+   * are measured from the first present, which does not produce
+   * a row of its own. Rows are queued in a fixed-size ring
+   * buffer and written to disk by a background thread, so that
+   * presenting a frame never waits for I/O. If the ring buffer
+   * is full, rows are dropped.
+   *
+   * When the stream is closed, a summary with the mean, minimum,
+   * maximum and percentiles of every column is written to a
+   * separate file. Percentiles are computed from a uniformly
+   * sampled subset of rows in order to bound memory usage.
+   */
+  class DxvkStatsWriter {
+    constexpr static size_t RingSize    = 1024;
+    constexpr static size_t SampleCount = 8192;
+  public:
+
+    DxvkStatsWriter(
+            DxvkDevice*           device,
+      const std::string&          fileName);
+
+    ~DxvkStatsWriter();
+
+    /**
+     * \brief Records stats for the current frame
+     *
+     * Must be called once per presented frame.
+     */
+    void recordFrame();
+
+    /**
+     * \brief Creates stat stream if requested
+     *
+     * Checks whether \c DXVK_STATS_PATH is set.
+     * \param [in] device The device
+     * \returns Stat stream, or \c nullptr
+     */
+    static std::unique_ptr<DxvkStatsWriter> create(
+            DxvkDevice*           device);
+
+  private:
+
+    DxvkDevice*                 m_device;
+    uint32_t                    m_heapCount = 0;
+
+    std::string                 m_fileName;
+    std::ofstream               m_file;
+
+    std::vector<std::string>    m_columns;
+
+    dxvk::high_resolution_clock::time_point m_startTime;
+    dxvk::high_resolution_clock::time_point m_lastFrame;
+
+    DxvkStatCounters            m_prevCounters;
+    uint64_t                    m_frameId = 0;
+    bool                        m_started = false;
+
+    std::vector<uint64_t>       m_ring;
+    std::atomic<uint64_t>       m_writeIndex  = { 0u };
+    std::atomic<uint64_t>       m_readIndex   = { 0u };
+    std::atomic<uint64_t>       m_dropCount   = { 0u };
+    std::atomic<bool>           m_stopped     = { false };
+
+    dxvk::mutex                 m_mutex;
+    dxvk::condition_variable    m_cond;
+
+    uint64_t                    m_rowCount    = 0;
+    std::vector<uint64_t>       m_samples;
+    std::vector<uint64_t>       m_minValues;
+    std::vector<uint64_t>       m_maxValues;
+    std::vector<double>         m_sums;
+    std::mt19937_64             m_random;
+
+    dxvk::thread                m_thread;
+
+    void runWriter();
+
+    void writeRow(
+      const uint64_t*             row);
+
+    void writeSummary();
+
+  };
+
+}
@@ -46,13 +46,18 @@ namespace dxvk::hud {
     addItem<HudDeviceInfoItem>("devinfo", -1, m_device);
     addItem<HudFpsItem>("fps", -1);
     addItem<HudFrameTimeItem>("frametimes", -1);
+    addItem<HudLatencyItem>("latency", -1, device);
+    addItem<HudFramePacingItem>("pacing", -1, device);
     addItem<HudSubmissionStatsItem>("submissions", -1, device);
     addItem<HudDrawCallStatsItem>("drawcalls", -1, device);
+    addItem<HudRedundantStateItem>("states", -1, device);
     addItem<HudPipelineStatsItem>("pipelines", -1, device);
     addItem<HudDescriptorStatsItem>("descriptors", -1, device);
+    addItem<HudQueryStatsItem>("queries", -1, device);
     addItem<HudMemoryStatsItem>("memory", -1, device);
     addItem<HudCsThreadItem>("cs", -1, device);
     addItem<HudGpuLoadItem>("gpuload", -1, device);
+    addItem<HudGpuTimeItem>("gputime", -1, device);
     addItem<HudCompilerActivityItem>("compiler", -1, device);
   }
   
@@ -295,6 +295,233 @@ namespace dxvk::hud {
   }
 
 
+  HudLatencyItem::HudLatencyItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudLatencyItem::~HudLatencyItem() {
+
+  }
+
+
+  void HudLatencyItem::update(dxvk::high_resolution_clock::time_point time) {
+    DxvkStatCounters counters = m_device->getStatCounters();
+    auto diffCounters = counters.diff(m_prevCounters);
+
+    // Latency is only known once the GPU has finished a frame,
+    // so repeat the previous data point if no frame completed.
+    uint64_t frameCount = diffCounters.getCtr(DxvkStatCounter::FrameLatencyCount);
+    uint64_t frameTicks = diffCounters.getCtr(DxvkStatCounter::FrameLatencyTicks);
+
+    float prevUs = m_dataPoints[(m_dataPointId + NumDataPoints - 1) % NumDataPoints];
+
+    m_dataPoints[m_dataPointId] = frameCount ? float(frameTicks) / float(frameCount) : prevUs;
+    m_dataPointId = (m_dataPointId + 1) % NumDataPoints;
+
+    m_sleepFrames += diffCounters.getCtr(DxvkStatCounter::QueuePresentCount);
+    m_sleepTicks += diffCounters.getCtr(DxvkStatCounter::FrameSleepTicks);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    if (elapsed.count() >= UpdateInterval) {
+      m_sleepUs = m_sleepFrames ? m_sleepTicks / m_sleepFrames : 0;
+      m_sleepFrames = 0;
+      m_sleepTicks = 0;
+
+      m_lastUpdate = time;
+    }
+
+    m_prevCounters = counters;
+  }
+
+
+  HudPos HudLatencyItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    std::array<HudGraphPoint, NumDataPoints> points;
+
+    // Anything below one 60 FPS frame is fine, 100ms is worst
+    const float targetUs =  16'666.6f;
+    const float maxUs    = 100'000.0f;
+
+    uint32_t minMs = 0xFFFFFFFFu;
+    uint32_t maxMs = 0x00000000u;
+
+    for (uint32_t i = 0; i < NumDataPoints; i++) {
+      float us = m_dataPoints[(m_dataPointId + i) % NumDataPoints];
+
+      minMs = std::min(minMs, uint32_t(us / 100.0f));
+      maxMs = std::max(maxMs, uint32_t(us / 100.0f));
+
+      float r = std::min(std::max(-1.0f + us / targetUs, 0.0f), 1.0f);
+      float g = std::min(std::max( 3.0f - us / targetUs, 0.0f), 1.0f);
+      float l = std::sqrt(r * r + g * g);
+
+      HudNormColor color = {
+        uint8_t(255.0f * (r / l)),
+        uint8_t(255.0f * (g / l)),
+        uint8_t(0), uint8_t(255) };
+
+      float hVal = std::log2(us / targetUs + 1.0f)
+                 / std::log2(maxUs / targetUs + 1.0f);
+
+      points[i].value = std::min(std::max(hVal, 1.0f / 40.0f), 1.0f);
+      points[i].color = color;
+    }
+
+    position.y += 16.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.5f, 0.25f, 1.0f },
+      "Latency:");
+
+    position.y += 8.0f;
+
+    renderer.drawGraph(position,
+      HudPos { float(NumDataPoints), 40.0f },
+      points.size(), points.data());
+
+    position.y += 58.0f;
+
+    renderer.drawText(12.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 0.25f, 1.0f },
+      "min:");
+
+    renderer.drawText(12.0f,
+      { position.x + 45.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(minMs / 10, ".", minMs % 10));
+
+    renderer.drawText(12.0f,
+      { position.x + 150.0f, position.y },
+      { 1.0f, 0.25f, 0.25f, 1.0f },
+      "max:");
+
+    renderer.drawText(12.0f,
+      { position.x + 195.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(maxMs / 10, ".", maxMs % 10));
+
+    position.y += 20.0f;
+
+    renderer.drawText(12.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 0.25f, 1.0f },
+      "sleep:");
+
+    renderer.drawText(12.0f,
+      { position.x + 60.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_sleepUs / 1000, ".", (m_sleepUs / 100) % 10, " ms"));
+
+    position.y += 4.0f;
+    return position;
+  }
+
+
+  HudFramePacingItem::HudFramePacingItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudFramePacingItem::~HudFramePacingItem() {
+
+  }
+
+
+  void HudFramePacingItem::update(dxvk::high_resolution_clock::time_point time) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    if (elapsed.count() >= UpdateInterval) {
+      DxvkStatCounters counters = m_device->getStatCounters();
+      auto diffCounters = counters.diff(m_prevCounters);
+
+      m_frameCount = 0;
+
+      for (uint32_t i = 0; i < m_bins.size(); i++) {
+        m_bins[i] = diffCounters.getCtr(DxvkStatCounter(uint32_t(DxvkStatCounter::FramePacingBin0) + i));
+        m_frameCount += m_bins[i];
+      }
+
+      m_lateCount = diffCounters.getCtr(DxvkStatCounter::FramePacingLate);
+      m_lateTicks = diffCounters.getCtr(DxvkStatCounter::FramePacingLateTicks);
+      m_frameCount += m_lateCount;
+
+      m_prevCounters = counters;
+      m_lastUpdate = time;
+    }
+  }
+
+
+  HudPos HudFramePacingItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.5f, 0.25f, 1.0f },
+      "Frame pacing:");
+
+    if (!m_frameCount) {
+      position.y += 20.0f;
+
+      renderer.drawText(12.0f,
+        { position.x, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        "Limiter inactive");
+
+      position.y += 4.0f;
+      return position;
+    }
+
+    for (uint32_t i = 0; i < m_bins.size(); i++) {
+      std::string label = i < FpsLimiter::ErrorBinLimits.size()
+        ? str::format("< ", FpsLimiter::ErrorBinLimits[i], " us:")
+        : str::format(">= ", FpsLimiter::ErrorBinLimits.back(), " us:");
+
+      uint64_t permille = (1000 * m_bins[i]) / m_frameCount;
+
+      position.y += 16.0f;
+
+      renderer.drawText(12.0f,
+        { position.x, position.y },
+        { 1.0f, 0.5f, 0.25f, 1.0f },
+        label);
+
+      renderer.drawText(12.0f,
+        { position.x + 96.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        str::format(permille / 10, ".", permille % 10, "%"));
+    }
+
+    // Frames that missed their target before reaching the
+    // limiter, along with how late they were on average
+    uint64_t latePermille = (1000 * m_lateCount) / m_frameCount;
+    uint64_t lateUs = m_lateCount ? m_lateTicks / m_lateCount : 0;
+
+    position.y += 16.0f;
+
+    renderer.drawText(12.0f,
+      { position.x, position.y },
+      { 1.0f, 0.5f, 0.25f, 1.0f },
+      "late:");
+
+    renderer.drawText(12.0f,
+      { position.x + 96.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(latePermille / 10, ".", latePermille % 10, "% (avg ", lateUs / 1000, ".", (lateUs / 100) % 10, " ms)"));
+
+    position.y += 4.0f;
+    return position;
+  }
+
+
   HudSubmissionStatsItem::HudSubmissionStatsItem(const Rc<DxvkDevice>& device)
   : m_device(device) {
 
@@ -310,14 +537,17 @@ namespace dxvk::hud {
     DxvkStatCounters counters = m_device->getStatCounters();
     
     uint64_t currSubmitCount = counters.getCtr(DxvkStatCounter::QueueSubmitCount);
+    uint64_t currCmdListCount = counters.getCtr(DxvkStatCounter::QueueCmdListCount);
     uint64_t currSyncCount = counters.getCtr(DxvkStatCounter::GpuSyncCount);
     uint64_t currSyncTicks = counters.getCtr(DxvkStatCounter::GpuSyncTicks);
 
     m_maxSubmitCount = std::max(m_maxSubmitCount, currSubmitCount - m_prevSubmitCount);
+    m_maxCmdListCount = std::max(m_maxCmdListCount, currCmdListCount - m_prevCmdListCount);
     m_maxSyncCount = std::max(m_maxSyncCount, currSyncCount - m_prevSyncCount);
     m_maxSyncTicks = std::max(m_maxSyncTicks, currSyncTicks - m_prevSyncTicks);
 
     m_prevSubmitCount = currSubmitCount;
+    m_prevCmdListCount = currCmdListCount;
     m_prevSyncCount = currSyncCount;
     m_prevSyncTicks = currSyncTicks;
 
@@ -325,6 +555,7 @@ namespace dxvk::hud {
 
     if (elapsed.count() >= UpdateInterval) {
       m_submitString = str::format(m_maxSubmitCount);
+      m_cmdListString = str::format(m_maxCmdListCount);
 
       uint64_t syncTicks = m_maxSyncTicks / 100;
 
@@ -333,6 +564,7 @@ namespace dxvk::hud {
         : str::format(m_maxSyncCount);
 
       m_maxSubmitCount = 0;
+      m_maxCmdListCount = 0;
       m_maxSyncCount = 0;
       m_maxSyncTicks = 0;
 
@@ -356,6 +588,17 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       m_submitString);
 
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.5f, 0.25f, 1.0f },
+      "Command lists:");
+
+    renderer.drawText(16.0f,
+      { position.x + 228.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_cmdListString);
+
     position.y += 20.0f;
     renderer.drawText(16.0f,
       { position.x, position.y },
@@ -394,6 +637,7 @@ namespace dxvk::hud {
       m_cpCount = diffCounters.getCtr(DxvkStatCounter::CmdDispatchCalls);
       m_rpCount = diffCounters.getCtr(DxvkStatCounter::CmdRenderPassCount);
       m_pbCount = diffCounters.getCtr(DxvkStatCounter::CmdBarrierCount);
+      m_rtCount = diffCounters.getCtr(DxvkStatCounter::ResourceTrackCount);
 
       m_lastUpdate = time;
     }
@@ -449,6 +693,90 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       str::format(m_pbCount));
     
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 0.5f, 1.0f, 1.0f },
+      "Tracked resources:");
+    
+    renderer.drawText(16.0f,
+      { position.x + 192.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_rtCount));
+    
+    position.y += 8.0f;
+    return position;
+  }
+
+
+  HudRedundantStateItem::HudRedundantStateItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudRedundantStateItem::~HudRedundantStateItem() {
+
+  }
+
+
+  void HudRedundantStateItem::update(dxvk::high_resolution_clock::time_point time) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate);
+
+    m_updateCount++;
+
+    if (elapsed.count() >= UpdateInterval) {
+      DxvkStatCounters counters = m_device->getStatCounters();
+      auto diffCounters = counters.diff(m_prevCounters);
+
+      // Average over all frames since the last update
+      m_cbCount = diffCounters.getCtr(DxvkStatCounter::StateBlendElided) / m_updateCount;
+      m_dsCount = diffCounters.getCtr(DxvkStatCounter::StateDepthStencilElided) / m_updateCount;
+      m_rsCount = diffCounters.getCtr(DxvkStatCounter::StateRasterizerElided) / m_updateCount;
+
+      m_prevCounters = counters;
+      m_updateCount = 0;
+      m_lastUpdate = time;
+    }
+  }
+
+
+  HudPos HudRedundantStateItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 0.5f, 1.0f, 1.0f },
+      "Skipped blend:");
+
+    renderer.drawText(16.0f,
+      { position.x + 192.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_cbCount));
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 0.5f, 1.0f, 1.0f },
+      "Skipped depth:");
+
+    renderer.drawText(16.0f,
+      { position.x + 192.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_dsCount));
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 0.5f, 1.0f, 1.0f },
+      "Skipped raster:");
+
+    renderer.drawText(16.0f,
+      { position.x + 192.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_rsCount));
+
     position.y += 8.0f;
     return position;
   }
@@ -566,6 +894,56 @@ namespace dxvk::hud {
   }
 
 
+  HudQueryStatsItem::HudQueryStatsItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+
+  }
+
+
+  HudQueryStatsItem::~HudQueryStatsItem() {
+
+  }
+
+
+  void HudQueryStatsItem::update(dxvk::high_resolution_clock::time_point time) {
+    DxvkStatCounters counters = m_device->getStatCounters();
+
+    m_queryPoolCount = counters.getCtr(DxvkStatCounter::QueryPoolCount);
+    m_queryCount     = counters.getCtr(DxvkStatCounter::QueryCount);
+    m_queryUsedCount = counters.getCtr(DxvkStatCounter::QueryUsedCount);
+  }
+
+
+  HudPos HudQueryStatsItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    position.y += 16.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 0.5f, 1.0f },
+      "Query pools:");
+
+    renderer.drawText(16.0f,
+      { position.x + 216.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_queryPoolCount));
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 1.0f, 0.25f, 0.5f, 1.0f },
+      "Queries used:");
+
+    renderer.drawText(16.0f,
+      { position.x + 216.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      str::format(m_queryUsedCount, " / ", m_queryCount));
+
+    position.y += 8.0f;
+    return position;
+  }
+
+
   HudMemoryStatsItem::HudMemoryStatsItem(const Rc<DxvkDevice>& device)
   : m_device(device), m_memory(device->adapter()->memoryProperties()) {
 
@@ -645,12 +1023,25 @@ namespace dxvk::hud {
 
     if (ticks >= UpdateInterval) {
       uint64_t currCsChunks = counters.getCtr(DxvkStatCounter::CsChunkCount);
-      uint64_t diffCsChunks = (currCsChunks - m_prevCsChunks) / m_updateCount;
+      uint64_t currCsBytes = counters.getCtr(DxvkStatCounter::CsChunkBytes);
+      uint64_t currCsLatency = counters.getCtr(DxvkStatCounter::CsChunkLatency);
+
+      uint64_t totalCsChunks = currCsChunks - m_prevCsChunks;
+      uint64_t diffCsChunks = totalCsChunks / m_updateCount;
+
+      // Report average block size and dispatch latency per chunk
+      uint64_t avgCsBytes = totalCsChunks ? (currCsBytes - m_prevCsBytes) / totalCsChunks : 0;
+      uint64_t avgCsLatency = totalCsChunks ? (currCsLatency - m_prevCsLatency) / totalCsChunks : 0;
+
       m_prevCsChunks = currCsChunks;
+      m_prevCsBytes = currCsBytes;
+      m_prevCsLatency = currCsLatency;
 
       uint64_t syncTicks = m_maxCsSyncTicks / 100;
 
       m_csChunkString = str::format(diffCsChunks);
+      m_csSizeString = str::format(avgCsBytes >> 10, " kB");
+      m_csLatencyString = str::format(avgCsLatency / 1000, ".", (avgCsLatency / 100) % 10, " ms");
       m_csSyncString = m_maxCsSyncCount
         ? str::format(m_maxCsSyncCount, " (", (syncTicks / 10), ".", (syncTicks % 10), " ms)")
         : str::format(m_maxCsSyncCount);
@@ -678,6 +1069,28 @@ namespace dxvk::hud {
       { 1.0f, 1.0f, 1.0f, 1.0f },
       m_csChunkString);
 
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 1.0f, 0.25f, 1.0f },
+      "CS size:");
+
+    renderer.drawText(16.0f,
+      { position.x + 132.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_csSizeString);
+
+    position.y += 20.0f;
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 1.0f, 0.25f, 1.0f },
+      "CS latency:");
+
+    renderer.drawText(16.0f,
+      { position.x + 132.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_csLatencyString);
+
     position.y += 20.0f;
     renderer.drawText(16.0f,
       { position.x, position.y },
@@ -745,6 +1158,79 @@ namespace dxvk::hud {
   }
 
 
+  HudGpuTimeItem::HudGpuTimeItem(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+    m_device->enableGpuProfiler();
+  }
+
+
+  HudGpuTimeItem::~HudGpuTimeItem() {
+
+  }
+
+
+  void HudGpuTimeItem::update(dxvk::high_resolution_clock::time_point time) {
+    uint64_t ticks = std::chrono::duration_cast<std::chrono::microseconds>(time - m_lastUpdate).count();
+
+    if (ticks >= UpdateInterval) {
+      DxvkStatCounters counters = m_device->getStatCounters();
+      DxvkStatCounters diffCounters = counters.diff(m_prevCounters);
+
+      uint64_t frameCount = std::max<uint64_t>(diffCounters.getCtr(DxvkStatCounter::QueuePresentCount), 1u);
+      uint64_t totalNs = 0;
+
+      for (uint32_t i = 1; i < DxvkGpuZoneTypeCount; i++) {
+        auto counter = DxvkGpuProfiler::getStatCounter(DxvkGpuZoneType(i));
+        uint64_t ns = diffCounters.getCtr(counter);
+        uint64_t us = ns / (frameCount * 1000u);
+
+        m_zoneStrings[i] = str::format(us / 1000, ".", (us / 100) % 10, " ms");
+        totalNs += ns;
+      }
+
+      uint64_t totalUs = totalNs / (frameCount * 1000u);
+      m_totalString = str::format(totalUs / 1000, ".", (totalUs / 100) % 10, " ms");
+
+      m_prevCounters = counters;
+      m_lastUpdate = time;
+    }
+  }
+
+
+  HudPos HudGpuTimeItem::render(
+          HudRenderer&      renderer,
+          HudPos            position) {
+    for (uint32_t i = 1; i < DxvkGpuZoneTypeCount; i++) {
+      position.y += 20.0f;
+
+      renderer.drawText(16.0f,
+        { position.x, position.y },
+        { 0.25f, 0.5f, 0.25f, 1.0f },
+        str::format(DxvkGpuProfiler::getZoneName(DxvkGpuZoneType(i)), ":"));
+
+      renderer.drawText(16.0f,
+        { position.x + 156.0f, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        m_zoneStrings[i]);
+    }
+
+    position.y += 20.0f;
+
+    renderer.drawText(16.0f,
+      { position.x, position.y },
+      { 0.25f, 0.5f, 0.25f, 1.0f },
+      "GPU time:");
+
+    renderer.drawText(16.0f,
+      { position.x + 156.0f, position.y },
+      { 1.0f, 1.0f, 1.0f, 1.0f },
+      m_totalString);
+
+    position.y += 8.0f;
+    return position;
+  }
+
+
   HudCompilerActivityItem::HudCompilerActivityItem(const Rc<DxvkDevice>& device)
   : m_device(device) {
 
@@ -5,6 +5,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "../../util/util_fps_limiter.h"
 #include "../../util/util_time.h"
 
 #include "dxvk_hud_renderer.h"
@@ -237,6 +238,84 @@ namespace dxvk::hud {
   };
 
 
+  /**
+   * \brief HUD item to display frame latency
+   *
+   * Shows a graph of the time between the application starting
+   * a frame on the CPU and the GPU completing that frame, as well
+   * as time spent in low-latency frame pacing.
+   */
+  class HudLatencyItem : public HudItem {
+    constexpr static size_t NumDataPoints = 304;
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudLatencyItem(const Rc<DxvkDevice>& device);
+
+    ~HudLatencyItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice>                    m_device;
+
+    DxvkStatCounters                  m_prevCounters;
+
+    std::array<float, NumDataPoints>  m_dataPoints  = {};
+    uint32_t                          m_dataPointId = 0;
+
+    uint64_t                          m_sleepUs     = 0;
+    uint64_t                          m_sleepFrames = 0;
+    uint64_t                          m_sleepTicks  = 0;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
+
+  /**
+   * \brief HUD item to display frame limiter accuracy
+   *
+   * Shows a histogram of how late the frame rate
+   * limiter woke up relative to the target time.
+   */
+  class HudFramePacingItem : public HudItem {
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudFramePacingItem(const Rc<DxvkDevice>& device);
+
+    ~HudFramePacingItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice>    m_device;
+
+    DxvkStatCounters  m_prevCounters;
+
+    std::array<uint64_t, FpsLimiter::ErrorBinCount> m_bins = { };
+    uint64_t          m_lateCount  = 0;
+    uint64_t          m_lateTicks  = 0;
+    uint64_t          m_frameCount = 0;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
+
   /**
    * \brief HUD item to display queue statistics
    */
@@ -258,15 +337,18 @@ namespace dxvk::hud {
 
     Rc<DxvkDevice>  m_device;
 
-    uint64_t        m_prevSubmitCount = 0;
-    uint64_t        m_prevSyncCount   = 0;
-    uint64_t        m_prevSyncTicks   = 0;
+    uint64_t        m_prevSubmitCount   = 0;
+    uint64_t        m_prevCmdListCount  = 0;
+    uint64_t        m_prevSyncCount     = 0;
+    uint64_t        m_prevSyncTicks     = 0;
 
-    uint64_t        m_maxSubmitCount  = 0;
-    uint64_t        m_maxSyncCount    = 0;
-    uint64_t        m_maxSyncTicks    = 0;
+    uint64_t        m_maxSubmitCount    = 0;
+    uint64_t        m_maxCmdListCount   = 0;
+    uint64_t        m_maxSyncCount      = 0;
+    uint64_t        m_maxSyncTicks      = 0;
 
     std::string     m_submitString;
+    std::string     m_cmdListString;
     std::string     m_syncString;
 
     dxvk::high_resolution_clock::time_point m_lastUpdate
@@ -302,6 +384,45 @@ namespace dxvk::hud {
     uint64_t          m_cpCount = 0;
     uint64_t          m_rpCount = 0;
     uint64_t          m_pbCount = 0;
+    uint64_t          m_rtCount = 0;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
+
+  /**
+   * \brief HUD item to display redundant state changes
+   *
+   * Shows the number of state changes per frame
+   * that were filtered out before being emitted.
+   */
+  class HudRedundantStateItem : public HudItem {
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudRedundantStateItem(const Rc<DxvkDevice>& device);
+
+    ~HudRedundantStateItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice>    m_device;
+
+    DxvkStatCounters  m_prevCounters;
+
+    uint64_t          m_updateCount = 0;
+
+    uint64_t          m_cbCount = 0;
+    uint64_t          m_dsCount = 0;
+    uint64_t          m_rsCount = 0;
 
     dxvk::high_resolution_clock::time_point m_lastUpdate
       = dxvk::high_resolution_clock::now();
@@ -364,6 +485,34 @@ namespace dxvk::hud {
   };
 
 
+  /**
+   * \brief HUD item to display query pool usage
+   */
+  class HudQueryStatsItem : public HudItem {
+
+  public:
+
+    HudQueryStatsItem(const Rc<DxvkDevice>& device);
+
+    ~HudQueryStatsItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice> m_device;
+
+    uint64_t m_queryPoolCount = 0;
+    uint64_t m_queryCount     = 0;
+    uint64_t m_queryUsedCount = 0;
+
+  };
+
+
   /**
    * \brief HUD item to display memory usage
    */
@@ -414,6 +563,8 @@ namespace dxvk::hud {
     uint64_t m_prevCsSyncCount  = 0;
     uint64_t m_prevCsSyncTicks  = 0;
     uint64_t m_prevCsChunks     = 0;
+    uint64_t m_prevCsBytes      = 0;
+    uint64_t m_prevCsLatency    = 0;
 
     uint64_t m_maxCsSyncCount   = 0;
     uint64_t m_maxCsSyncTicks   = 0;
@@ -422,6 +573,8 @@ namespace dxvk::hud {
 
     std::string m_csSyncString;
     std::string m_csChunkString;
+    std::string m_csSizeString;
+    std::string m_csLatencyString;
 
     dxvk::high_resolution_clock::time_point m_lastUpdate
       = dxvk::high_resolution_clock::now();
@@ -461,6 +614,42 @@ namespace dxvk::hud {
   };
 
 
+  /**
+   * \brief HUD item to display GPU time per zone type
+   *
+   * Enables GPU profiling on the device and shows
+   * the average GPU time per frame spent in render
+   * passes, compute dispatches and meta operations.
+   */
+  class HudGpuTimeItem : public HudItem {
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+
+    HudGpuTimeItem(const Rc<DxvkDevice>& device);
+
+    ~HudGpuTimeItem();
+
+    void update(dxvk::high_resolution_clock::time_point time);
+
+    HudPos render(
+            HudRenderer&      renderer,
+            HudPos            position);
+
+  private:
+
+    Rc<DxvkDevice>    m_device;
+
+    DxvkStatCounters  m_prevCounters;
+
+    std::array<std::string, DxvkGpuZoneTypeCount> m_zoneStrings;
+    std::string       m_totalString;
+
+    dxvk::high_resolution_clock::time_point m_lastUpdate
+      = dxvk::high_resolution_clock::now();
+
+  };
+
+
   /**
    * \brief HUD item to display pipeline compiler activity
    */
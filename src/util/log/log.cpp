@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <utility>
 
 #include "log.h"
@@ -7,12 +9,38 @@
 namespace dxvk {
   
   Logger::Logger(const std::string& fileName)
-  : m_minLevel(getMinLogLevel()), m_fileName(fileName) {
+  : m_minLevel(getMinLogLevel()), m_fileName(fileName), m_async(getAsyncMode()) {
+    if (m_async) {
+      m_queue = std::make_unique<LogEntry[]>(QueueSize);
 
+      for (size_t i = 0; i < QueueSize; i++)
+        m_queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
   }
   
   
-  Logger::~Logger() { }
+  Logger::~Logger() {
+    if (!m_threadStarted.load())
+      return;
+
+    { std::lock_guard<dxvk::mutex> lock(m_threadMutex);
+      m_threadStopped.store(true);
+      m_threadCond.notify_one();
+    }
+
+    // If the process is exiting, the log thread has already been
+    // terminated and may have done so while holding the lock, so
+    // we cannot safely write any remaining messages.
+    if (this_thread::isInModuleDetachment()) {
+      m_thread.detach();
+      return;
+    }
+
+    m_thread.join();
+
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+    this->drainQueue();
+  }
   
   
   void Logger::trace(const std::string& message) {
@@ -46,46 +74,177 @@ namespace dxvk {
   
   
   void Logger::emitMsg(LogLevel level, const std::string& message) {
-    if (level >= m_minLevel) {
+    if (level < m_minLevel)
+      return;
+
+    if (m_async) {
+      // Start the thread on first use rather than in the
+      // constructor, since the logger is a static object
+      // which may get initialized while the loader lock
+      // is held on Windows.
+      if (!m_threadStarted.load(std::memory_order_acquire)) {
+        std::lock_guard<dxvk::mutex> lock(m_threadMutex);
+
+        if (!m_threadStarted.load(std::memory_order_relaxed)) {
+          m_thread = dxvk::thread([this] { runLogThread(); });
+          m_threadStarted.store(true, std::memory_order_release);
+        }
+      }
+
+      this->enqueueMsg(level, message);
+    } else {
       std::lock_guard<dxvk::mutex> lock(m_mutex);
-      
-      static std::array<const char*, 5> s_prefixes
-        = {{ "trace: ", "debug: ", "info:  ", "warn:  ", "err:   " }};
-      
-      const char* prefix = s_prefixes.at(static_cast<uint32_t>(level));
+      this->writeMsg(level, message);
+    }
+  }
 
-      if (!std::exchange(m_initialized, true)) {
+
+  void Logger::writeMsg(LogLevel level, const std::string& message) {
+    static std::array<const char*, 5> s_prefixes
+      = {{ "trace: ", "debug: ", "info:  ", "warn:  ", "err:   " }};
+    
+    const char* prefix = s_prefixes.at(static_cast<uint32_t>(level));
+
+    if (!std::exchange(m_initialized, true)) {
 #ifdef _WIN32
-        HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+      HMODULE ntdll = GetModuleHandleA("ntdll.dll");
 
-        if (ntdll)
-          m_wineLogOutput = reinterpret_cast<PFN_wineLogOutput>(GetProcAddress(ntdll, "__wine_dbg_output"));
+      if (ntdll)
+        m_wineLogOutput = reinterpret_cast<PFN_wineLogOutput>(GetProcAddress(ntdll, "__wine_dbg_output"));
 #endif
-        auto path = getFileName(m_fileName);
+      auto path = getFileName(m_fileName);
+
+      if (!path.empty())
+        m_fileStream = std::ofstream(str::topath(path.c_str()).c_str());
+    }
+
+    std::stringstream stream(message);
+    std::string line;
+
+    while (std::getline(stream, line, '\n')) {
+      std::stringstream outstream;
+      outstream << prefix << line << std::endl;
+
+      std::string adjusted = outstream.str();
 
-        if (!path.empty())
-          m_fileStream = std::ofstream(str::topath(path.c_str()).c_str());
+      if (!adjusted.empty()) {
+        if (m_wineLogOutput)
+          m_wineLogOutput(adjusted.c_str());
+        else
+          std::cerr << adjusted;
       }
 
-      std::stringstream stream(message);
-      std::string line;
+      if (m_fileStream)
+        m_fileStream << adjusted;
+    }
+  }
+
+
+  void Logger::enqueueMsg(LogLevel level, const std::string& message) {
+    // Bounded MPSC queue. Each slot stores the position at which
+    // it can next be written, so that producers only need to
+    // claim a position and never have to wait for each other.
+    uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
 
-      while (std::getline(stream, line, '\n')) {
-        std::stringstream outstream;
-        outstream << prefix << line << std::endl;
+    while (true) {
+      LogEntry& entry = m_queue[pos % QueueSize];
 
-        std::string adjusted = outstream.str();
+      uint64_t seq = entry.sequence.load(std::memory_order_acquire);
+      int64_t diff = int64_t(seq - pos);
 
-        if (!adjusted.empty()) {
-          if (m_wineLogOutput)
-            m_wineLogOutput(adjusted.c_str());
-          else
-            std::cerr << adjusted;
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          // Copy the message into the slot, truncating it
+          // if necessary, so that we never allocate here
+          size_t length = std::min(message.size(), MessageSize);
+          std::memcpy(entry.message.data(), message.data(), length);
+
+          if (length < message.size())
+            std::memcpy(&entry.message[length - 3], "...", 3);
+
+          entry.level = level;
+          entry.length = uint32_t(length);
+          entry.sequence.store(pos + 1, std::memory_order_release);
+          break;
+        }
+      } else if (diff < 0) {
+        // Queue is full. Errors are too important to drop, so write
+        // them synchronously after any queued messages, otherwise
+        // drop the message rather than blocking the calling thread.
+        if (level >= LogLevel::Error) {
+          std::lock_guard<dxvk::mutex> lock(m_mutex);
+          this->drainQueue();
+          this->writeMsg(level, message);
+        } else {
+          m_dropCount.fetch_add(1, std::memory_order_relaxed);
         }
+        return;
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    m_threadCond.notify_one();
+  }
+
+
+  bool Logger::dequeueMsg(LogLevel& level, std::string& message) {
+    uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    LogEntry& entry = m_queue[pos % QueueSize];
+
+    if (entry.sequence.load(std::memory_order_acquire) != pos + 1)
+      return false;
+
+    level = entry.level;
+    message.assign(entry.message.data(), entry.length);
+
+    entry.sequence.store(pos + QueueSize, std::memory_order_release);
+
+    m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+
+  void Logger::drainQueue() {
+    LogLevel level;
+    std::string message;
+
+    while (this->dequeueMsg(level, message))
+      this->writeMsg(level, message);
+
+    uint64_t dropCount = m_dropCount.load(std::memory_order_relaxed);
 
-        if (m_fileStream)
-          m_fileStream << adjusted;
+    if (dropCount != m_dropsReported) {
+      this->writeMsg(LogLevel::Warn, std::to_string(dropCount - m_dropsReported)
+        + " log messages dropped");
+      m_dropsReported = dropCount;
+    }
+  }
+
+
+  void Logger::runLogThread() {
+    env::setThreadName("dxvk-log");
+
+    bool stopped = false;
+
+    while (!stopped) {
+      { std::unique_lock<dxvk::mutex> lock(m_threadMutex);
+
+        // Producers notify without taking the lock, so a wakeup
+        // may be missed. Use a timeout to bound the latency.
+        m_threadCond.wait_for(lock, std::chrono::milliseconds(10), [this] {
+          uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+          return m_threadStopped.load()
+              || m_queue[pos % QueueSize].sequence.load(
+                   std::memory_order_acquire) == pos + 1;
+        });
+
+        stopped = m_threadStopped.load();
       }
+
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      this->drainQueue();
     }
   }
   
@@ -128,5 +287,10 @@ namespace dxvk {
     
     return LogLevel::Info;
   }
+
+
+  bool Logger::getAsyncMode() {
+    return env::getEnvVar("DXVK_LOG_ASYNC") == "1";
+  }
   
 }
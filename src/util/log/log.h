@@ -1,8 +1,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "../thread.h"
@@ -25,6 +27,15 @@ namespace dxvk {
    * 
    * Logger for one DLL. Creates a text file and
    * writes all log messages to that file.
+   *
+   * If \c DXVK_LOG_ASYNC is set, messages are copied into
+   * a bounded lock-free queue instead, and a background
+   * thread formats and writes them. Queue slots have a
+   * fixed size so that logging does not allocate memory,
+   * and longer messages are truncated. If the queue is full,
+   * errors are written synchronously, and all other messages
+   * are dropped. The number of dropped messages is reported
+   * in the log.
    */
   class Logger {
     
@@ -43,13 +54,34 @@ namespace dxvk {
     static LogLevel logLevel() {
       return s_instance.m_minLevel;
     }
+
+    /**
+     * \brief Queries number of dropped messages
+     *
+     * Only messages logged in async mode can be dropped.
+     * \returns Total number of dropped messages
+     */
+    static uint64_t dropCount() {
+      return s_instance.m_dropCount.load(std::memory_order_relaxed);
+    }
     
   private:
+
+    constexpr static size_t QueueSize   = 2048;
+    constexpr static size_t MessageSize = 512;
+
+    struct LogEntry {
+      std::atomic<uint64_t>           sequence = { 0u };
+      LogLevel                        level    = LogLevel::Info;
+      uint32_t                        length   = 0u;
+      std::array<char, MessageSize>   message;
+    };
     
     static Logger     s_instance;
     
     const LogLevel    m_minLevel;
     const std::string m_fileName;
+    const bool        m_async;
     
     dxvk::mutex       m_mutex;
     std::ofstream     m_fileStream;
@@ -57,13 +89,37 @@ namespace dxvk {
     bool              m_initialized = false;
     PFN_wineLogOutput m_wineLogOutput = nullptr;
 
+    std::unique_ptr<LogEntry[]> m_queue;
+    std::atomic<uint64_t>       m_enqueuePos    = { 0u };
+    std::atomic<uint64_t>       m_dequeuePos    = { 0u };
+    std::atomic<uint64_t>       m_dropCount     = { 0u };
+    uint64_t                    m_dropsReported = 0u;
+
+    dxvk::mutex                 m_threadMutex;
+    dxvk::condition_variable    m_threadCond;
+    std::atomic<bool>           m_threadStarted = { false };
+    std::atomic<bool>           m_threadStopped = { false };
+    dxvk::thread                m_thread;
+
     void emitMsg(LogLevel level, const std::string& message);
+
+    void writeMsg(LogLevel level, const std::string& message);
+
+    void enqueueMsg(LogLevel level, const std::string& message);
+
+    bool dequeueMsg(LogLevel& level, std::string& message);
+
+    void drainQueue();
+
+    void runLogThread();
     
     std::string getFileName(
       const std::string& base);
 
     static LogLevel getMinLogLevel();
 
+    static bool getAsyncMode();
+
   };
   
 }
@@ -9,6 +9,7 @@
 #endif
 
 #include "util_env.h"
+#include "util_profiler.h"
 
 #include "./com/com_include.h"
 
@@ -110,6 +111,8 @@ namespace dxvk::env {
     dxvk::str::strlcpy(posixName.data(), name.c_str(), 16);
     ::pthread_setname_np(pthread_self(), posixName.data());
 #endif
+
+    Profiler::setThreadName(name);
   }
 
 
@@ -45,41 +45,57 @@ namespace dxvk {
   }
 
 
-  void FpsLimiter::delay(bool vsyncEnabled) {
-    std::lock_guard<dxvk::mutex> lock(m_mutex);
+  FpsLimiter::PacingResult FpsLimiter::delay(bool vsyncEnabled) {
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    PacingResult result;
 
     if (!isEnabled())
-      return;
+      return result;
 
-    auto t0 = m_lastFrame;
     auto t1 = dxvk::high_resolution_clock::now();
+    auto target = m_nextFrame;
+
+    if (t1 >= target) {
+      // If the frame is only slightly late, keep the current cadence
+      // so that the next frame makes up for it. Do not compensate for
+      // slow frames though, since that would lead to stutter.
+      m_nextFrame = (t1 - target) * 16 < m_targetInterval
+        ? target + m_targetInterval
+        : t1 + m_targetInterval;
+
+      result.error = std::chrono::duration_cast<TimerDuration>(t1 - target);
+      result.late = true;
+      return result;
+    }
+
+    m_nextFrame = target + m_targetInterval;
+
+    // Don't hold the lock while sleeping so that changing
+    // the target frame rate does not stall the caller.
+    lock.unlock();
+
+    t1 = Sleep::sleepUntil(t1, target);
+
+    result.error = std::chrono::duration_cast<TimerDuration>(t1 - target);
+    return result;
+  }
+
+
+  uint32_t FpsLimiter::getErrorBin(TimerDuration error) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(error).count();
 
-    auto frameTime = std::chrono::duration_cast<TimerDuration>(t1 - t0);
-
-    if (frameTime * 100 > m_targetInterval * 103 - m_deviation * 100) {
-      // If we have a slow frame, reset the deviation since we
-      // do not want to compensate for low performance later on
-      m_deviation = TimerDuration::zero();
-    } else {
-      // Don't call sleep if the amount of time to sleep is shorter
-      // than the time the function calls are likely going to take
-      TimerDuration sleepDuration = m_targetInterval - m_deviation - frameTime;
-      t1 = Sleep::sleepFor(t1, sleepDuration);
-
-      // Compensate for any sleep inaccuracies in the next frame, and
-      // limit cumulative deviation in order to avoid stutter in case we
-      // have a number of slow frames immediately followed by a fast one.
-      frameTime = std::chrono::duration_cast<TimerDuration>(t1 - t0);
-      m_deviation += frameTime - m_targetInterval;
-      m_deviation = std::min(m_deviation, m_targetInterval / 16);
+    for (uint32_t i = 0; i < ErrorBinLimits.size(); i++) {
+      if (us < int64_t(ErrorBinLimits[i]))
+        return i;
     }
 
-    m_lastFrame = t1;
+    return ErrorBinCount - 1;
   }
 
 
   void FpsLimiter::initialize() {
-    m_lastFrame = dxvk::high_resolution_clock::now();
+    m_nextFrame = dxvk::high_resolution_clock::now();
     m_initialized = true;
   }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+
 #include "thread.h"
 #include "util_time.h"
 
@@ -15,6 +17,29 @@ namespace dxvk {
 
   public:
 
+    using TimePoint = dxvk::high_resolution_clock::time_point;
+    using TimerDuration = std::chrono::nanoseconds;
+
+    /// Number of histogram bins for pacing errors
+    constexpr static uint32_t ErrorBinCount = 7;
+
+    /// Upper bounds of all but the last histogram bin, in microseconds
+    constexpr static std::array<uint32_t, ErrorBinCount - 1> ErrorBinLimits = {
+      20, 50, 100, 250, 500, 1000 };
+
+    /**
+     * \brief Pacing result of a single frame
+     *
+     * For frames that were delayed, the error is the time between
+     * the target time and the end of the delay. For frames that
+     * were already late, it is the time by which they missed the
+     * target, and \c late is set.
+     */
+    struct PacingResult {
+      TimerDuration error = TimerDuration(-1);
+      bool          late  = false;
+    };
+
     /**
      * \brief Creates frame rate limiter
      */
@@ -33,10 +58,24 @@ namespace dxvk {
      *
      * Blocks the calling thread if the limiter is enabled
      * and the time since the last call to \ref delay is
-     * shorter than the target interval.
+     * shorter than the target interval. Frames are paced
+     * against absolute target times, so that any sleep
+     * inaccuracy does not accumulate over time.
      * \param [in] vsyncEnabled \c true if vsync is enabled
+     * \returns Pacing result. The error is negative only
+     *    if the frame rate limiter is disabled.
+     */
+    PacingResult delay(bool vsyncEnabled);
+
+    /**
+     * \brief Computes histogram bin for a pacing error
+     *
+     * Only meaningful for frames that were delayed,
+     * late frames are counted separately.
+     * \param [in] error Pacing error returned by \ref delay
+     * \returns Histogram bin index
      */
-    void delay(bool vsyncEnabled);
+    static uint32_t getErrorBin(TimerDuration error);
 
     /**
      * \brief Checks whether the frame rate limiter is enabled
@@ -48,14 +87,10 @@ namespace dxvk {
 
   private:
 
-    using TimePoint = dxvk::high_resolution_clock::time_point;
-    using TimerDuration = std::chrono::nanoseconds;
-
     dxvk::mutex     m_mutex;
 
     TimerDuration   m_targetInterval  = TimerDuration::zero();
-    TimerDuration   m_deviation       = TimerDuration::zero();
-    TimePoint       m_lastFrame;
+    TimePoint       m_nextFrame;
 
     bool            m_initialized     = false;
     bool            m_envOverride     = false;
@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+#include "util_env.h"
+#include "util_profiler.h"
+#include "util_string.h"
+
+#include "log/log.h"
+
+namespace dxvk {
+
+  Profiler Profiler::s_instance;
+
+
+  Profiler::Profiler() {
+#ifdef DXVK_PROFILER
+    std::string frameStr = env::getEnvVar("DXVK_PROFILE_FRAME");
+
+    if (!frameStr.empty()) {
+      try {
+        m_traceFrame = std::stoull(frameStr);
+      } catch (const std::invalid_argument&) {
+        // no-op
+      }
+    }
+
+    m_enabled = env::getEnvVar("DXVK_PROFILE") == "1" || m_traceFrame;
+    m_tracePath = env::getEnvVar("DXVK_PROFILE_PATH");
+    m_startTime = now();
+#endif
+  }
+
+
+  Profiler::~Profiler() {
+    { std::lock_guard<dxvk::mutex> lock(m_writeMutex);
+      m_writeStopped = true;
+      m_writeCond.notify_one();
+    }
+
+    if (m_writeThread.joinable()) {
+      // If the process is exiting, the writer thread has
+      // already been terminated and must not be joined.
+      // Leak the track data in case it was still in use.
+      if (this_thread::isInModuleDetachment()) {
+        m_writeThread.detach();
+        return;
+      }
+
+      m_writeThread.join();
+    }
+
+    for (auto& entry : m_threads)
+      delete entry.data.load();
+  }
+
+
+  void Profiler::recordZone(
+    const char*                 category,
+    const char*                 name,
+          int64_t               start,
+          int64_t               end) {
+    ProfilerThreadData* data = s_instance.getThreadData();
+
+    if (data)
+      writeEvent(data, category, name, start, end);
+  }
+
+
+  void Profiler::recordGpuZone(
+    const char*                 category,
+    const char*                 name,
+          int64_t               start,
+          int64_t               end) {
+    // Multiple devices may record GPU zones, so
+    // the GPU track needs to be locked. This is
+    // fine since it is only written on flush.
+    std::lock_guard<sync::Spinlock> lock(s_instance.m_gpuLock);
+
+    if (!s_instance.m_gpuTrack)
+      s_instance.m_gpuTrack = s_instance.createTrack(~0u, "GPU");
+
+    if (s_instance.m_gpuTrack)
+      writeEvent(s_instance.m_gpuTrack, category, name, start, end);
+  }
+
+
+  void Profiler::setThreadName(
+    const std::string&          name) {
+    if (!isEnabled())
+      return;
+
+    ProfilerThreadData* data = s_instance.getThreadData();
+
+    if (data)
+      str::strlcpy(data->threadName.data(), name.c_str(), data->threadName.size());
+  }
+
+
+  void Profiler::endFrame() {
+    if (!isEnabled())
+      return;
+
+    static std::atomic<int64_t> s_lastFrame = { 0 };
+
+    int64_t t = now();
+    int64_t t0 = s_lastFrame.exchange(t, std::memory_order_relaxed);
+
+    if (t0)
+      recordZone("frame", "Frame", t0, t);
+
+    uint64_t frameId = ++s_instance.m_frameId;
+
+    bool writeTrace = s_instance.isTraceKeyPressed();
+
+    if (frameId == s_instance.m_traceFrame)
+      writeTrace = true;
+
+    if (writeTrace)
+      s_instance.requestTrace(t);
+  }
+
+
+  ProfilerThreadData* Profiler::getThreadData() {
+    return createTrack(dxvk::this_thread::get_id(), nullptr);
+  }
+
+
+  ProfilerThreadData* Profiler::createTrack(
+          uint32_t              trackId,
+    const char*                 name) {
+    // Open addressing with linear probing. Entries are
+    // never removed, so the lookup does not need a lock.
+    size_t index = (trackId * 2654435761u) % MaxThreadCount;
+
+    for (size_t i = 0; i < MaxThreadCount; i++) {
+      auto& entry = m_threads[(index + i) % MaxThreadCount];
+
+      uint32_t entryId = entry.threadId.load(std::memory_order_acquire);
+
+      if (entryId == trackId)
+        return entry.data.load(std::memory_order_acquire);
+
+      if (!entryId && entry.threadId.compare_exchange_strong(
+          entryId, trackId, std::memory_order_acquire)) {
+        auto data = new ProfilerThreadData();
+        data->threadId = ++m_threadCount;
+
+        std::string trackName = name ? std::string(name)
+          : str::format("Thread ", data->threadId);
+        str::strlcpy(data->threadName.data(), trackName.c_str(), data->threadName.size());
+
+        entry.data.store(data, std::memory_order_release);
+        return data;
+      }
+    }
+
+    // Too many threads, drop the event
+    return nullptr;
+  }
+
+
+  void Profiler::writeEvent(
+          ProfilerThreadData*   data,
+    const char*                 category,
+    const char*                 name,
+          int64_t               start,
+          int64_t               end) {
+    uint64_t index = data->writeIndex.load(std::memory_order_relaxed);
+
+    auto& e = data->events[index % ProfilerThreadData::EventCount];
+    e.category = category;
+    e.name = name;
+    e.start = start;
+    e.end = end;
+
+    data->writeIndex.store(index + 1, std::memory_order_release);
+  }
+
+
+  bool Profiler::isTraceKeyPressed() {
+#ifdef _WIN32
+    using GetAsyncKeyStateProc = SHORT (WINAPI *) (int);
+
+    static auto GetAsyncKeyState = reinterpret_cast<GetAsyncKeyStateProc>(
+      ::GetProcAddress(::GetModuleHandleW(L"user32.dll"), "GetAsyncKeyState"));
+
+    if (!GetAsyncKeyState)
+      return false;
+
+    bool keyDown = (GetAsyncKeyState(VK_SHIFT) & 0x8000)
+                && (GetAsyncKeyState(VK_F11) & 0x8000);
+
+    // Only write one trace per key press
+    bool pressed = keyDown && !m_keyDown;
+    m_keyDown = keyDown;
+    return pressed;
+#else
+    return false;
+#endif
+  }
+
+
+  void Profiler::requestTrace(
+          int64_t               time) {
+    std::lock_guard<dxvk::mutex> lock(m_writeMutex);
+
+    // Start the thread on first use since the profiler
+    // is a static object, same as the logger.
+    if (!m_writeThread.joinable())
+      m_writeThread = dxvk::thread([this] { runWriteThread(); });
+
+    m_writeQueue.push(time);
+    m_writeCond.notify_one();
+  }
+
+
+  void Profiler::runWriteThread() {
+    env::setThreadName("dxvk-profiler");
+
+    std::unique_lock<dxvk::mutex> lock(m_writeMutex);
+
+    while (true) {
+      m_writeCond.wait(lock, [this] {
+        return m_writeStopped || !m_writeQueue.empty();
+      });
+
+      if (m_writeStopped)
+        break;
+
+      int64_t time = m_writeQueue.front();
+      m_writeQueue.pop();
+
+      lock.unlock();
+      this->writeTrace(time);
+      lock.lock();
+    }
+  }
+
+
+  void Profiler::writeTrace(
+          int64_t               time) {
+    std::string fileName = getTraceFileName();
+    std::ofstream file(str::topath(fileName.c_str()).c_str());
+
+    if (!file) {
+      Logger::err(str::format("Profiler: Failed to write ", fileName));
+      return;
+    }
+
+    auto toUs = [this] (int64_t t) {
+      return double(t - m_startTime) * 1.0e6
+        * double(high_resolution_clock::period::num)
+        / double(high_resolution_clock::period::den);
+    };
+
+    file << "{\"traceEvents\":[" << std::endl;
+    file << std::fixed << std::setprecision(3);
+
+    bool first = true;
+
+    std::vector<ProfilerEvent> events;
+
+    for (const auto& entry : m_threads) {
+      const ProfilerThreadData* data = entry.data.load(std::memory_order_acquire);
+
+      if (!data)
+        continue;
+
+      file << (first ? "" : ",\n")
+           << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << data->threadId
+           << ",\"args\":{\"name\":\"" << data->threadName.data() << "\"}}";
+      first = false;
+
+      // Copy the ring buffer first, then check how far the
+      // owning thread has advanced in the meantime. Any event
+      // in a slot that may have been written to during the
+      // copy is discarded, since it may be torn.
+      uint64_t end = data->writeIndex.load(std::memory_order_acquire);
+      uint64_t copyBegin = end > ProfilerThreadData::EventCount
+        ? end - ProfilerThreadData::EventCount : 0u;
+
+      events.resize(end - copyBegin);
+
+      for (uint64_t i = copyBegin; i < end; i++)
+        events[i - copyBegin] = data->events[i % ProfilerThreadData::EventCount];
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint64_t newEnd = data->writeIndex.load(std::memory_order_relaxed);
+
+      uint64_t begin = copyBegin;
+
+      if (newEnd >= ProfilerThreadData::EventCount)
+        begin = std::max(begin, newEnd - ProfilerThreadData::EventCount + 1u);
+
+      for (uint64_t i = begin; i < end; i++) {
+        const ProfilerEvent& e = events[i - copyBegin];
+
+        if (!e.name || e.start < m_startTime || e.start > time)
+          continue;
+
+        file << ",\n{\"ph\":\"X\",\"cat\":\"" << e.category
+             << "\",\"name\":\"" << e.name
+             << "\",\"pid\":1,\"tid\":" << data->threadId
+             << ",\"ts\":" << toUs(e.start)
+             << ",\"dur\":" << toUs(e.end) - toUs(e.start) << "}";
+      }
+    }
+
+    file << "\n]}" << std::endl;
+
+    Logger::info(str::format("Profiler: Wrote ", fileName));
+  }
+
+
+  std::string Profiler::getTraceFileName() {
+    std::string path = m_tracePath;
+
+    if (!path.empty() && *path.rbegin() != '/')
+      path += '/';
+
+    return str::format(path, env::getExeBaseName(),
+      "_trace_", ++m_traceCount, ".json");
+  }
+
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <queue>
+#include <string>
+
+#include "thread.h"
+#include "util_time.h"
+
+#include "sync/sync_spinlock.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Recorded profiler zone
+   *
+   * Category and name must be string
+   * literals or otherwise outlive the
+   * profiler itself.
+   */
+  struct ProfilerEvent {
+    const char* category;
+    const char* name;
+    int64_t     start;
+    int64_t     end;
+  };
+
+
+  /**
+   * \brief Per-thread profiler data
+   *
+   * Ring buffer of recorded zones. Only the owning thread
+   * writes events, so the write index is only atomic in
+   * order to let the trace writer read it safely.
+   */
+  struct ProfilerThreadData {
+    constexpr static size_t EventCount = 1u << 15;
+
+    uint32_t                          threadId = 0u;
+    std::array<char, 32>              threadName = { };
+    std::atomic<uint64_t>             writeIndex = { 0u };
+    std::array<ProfilerEvent, EventCount> events = { };
+  };
+
+
+  /**
+   * \brief CPU profiler
+   *
+   * Records timing zones on all threads into lock-free
+   * per-thread ring buffers and writes them out as a
+   * Chrome trace, which can be opened in chrome://tracing
+   * or Perfetto.
+   *
+   * Recording is enabled with \c DXVK_PROFILE=1. A trace
+   * is written whenever Shift+F11 is pressed on Windows,
+   * or automatically after the frame number given in
+   * \c DXVK_PROFILE_FRAME has been presented. Traces are
+   * written to \c DXVK_PROFILE_PATH, if set.
+   *
+   * Traces are written by a dedicated thread, so that
+   * presentation is not stalled by file I/O. Events that
+   * are recorded after the trace was requested are not
+   * included in the trace.
+   */
+  class Profiler {
+
+  public:
+
+    Profiler();
+    ~Profiler();
+
+    /**
+     * \brief Checks whether profiling is enabled
+     * \returns \c true if zones are recorded
+     */
+    static bool isEnabled() {
+      return s_instance.m_enabled;
+    }
+
+    /**
+     * \brief Queries current timestamp
+     * \returns Current time in clock ticks
+     */
+    static int64_t now() {
+      return high_resolution_clock::now().time_since_epoch().count();
+    }
+
+    /**
+     * \brief Records a zone on the calling thread
+     *
+     * \param [in] category Zone category
+     * \param [in] name Zone name
+     * \param [in] start Start timestamp
+     * \param [in] end End timestamp
+     */
+    static void recordZone(
+      const char*                 category,
+      const char*                 name,
+            int64_t               start,
+            int64_t               end);
+
+    /**
+     * \brief Records a GPU zone
+     *
+     * GPU zones are written to a dedicated track. Since
+     * GPU and CPU timestamps use different time domains,
+     * callers must convert GPU timestamps to clock ticks.
+     * \param [in] category Zone category
+     * \param [in] name Zone name
+     * \param [in] start Start timestamp
+     * \param [in] end End timestamp
+     */
+    static void recordGpuZone(
+      const char*                 category,
+      const char*                 name,
+            int64_t               start,
+            int64_t               end);
+
+    /**
+     * \brief Converts nanoseconds to clock ticks
+     *
+     * \param [in] ns Time in nanoseconds
+     * \returns Time in clock ticks
+     */
+    static int64_t nsToTicks(int64_t ns) {
+      return std::chrono::duration_cast<high_resolution_clock::duration>(
+        std::chrono::nanoseconds(ns)).count();
+    }
+
+    /**
+     * \brief Sets name of the calling thread
+     *
+     * Called when threads are created so
+     * that traces show meaningful names.
+     * \param [in] name Thread name
+     */
+    static void setThreadName(
+      const std::string&          name);
+
+    /**
+     * \brief Marks the end of a frame
+     *
+     * Called once per presented frame. Checks whether a
+     * trace was requested and hands it off to the writer
+     * thread if necessary.
+     */
+    static void endFrame();
+
+  private:
+
+    constexpr static size_t MaxThreadCount = 256;
+
+    struct ThreadEntry {
+      std::atomic<uint32_t>             threadId = { 0u };
+      std::atomic<ProfilerThreadData*>  data     = { nullptr };
+    };
+
+    static Profiler s_instance;
+
+    bool                      m_enabled     = false;
+    uint64_t                  m_traceFrame  = 0u;
+    std::string               m_tracePath;
+
+    int64_t                   m_startTime   = 0;
+
+    std::atomic<uint64_t>     m_frameId     = { 0u };
+    std::atomic<uint32_t>     m_traceCount  = { 0u };
+    std::atomic<uint32_t>     m_threadCount = { 0u };
+    bool                      m_keyDown     = false;
+
+    dxvk::mutex               m_writeMutex;
+    dxvk::condition_variable  m_writeCond;
+    std::queue<int64_t>       m_writeQueue;
+    bool                      m_writeStopped = false;
+    dxvk::thread              m_writeThread;
+
+    sync::Spinlock            m_gpuLock;
+    ProfilerThreadData*       m_gpuTrack    = nullptr;
+
+    std::array<ThreadEntry, MaxThreadCount> m_threads;
+
+    ProfilerThreadData* getThreadData();
+
+    ProfilerThreadData* createTrack(
+            uint32_t              trackId,
+      const char*                 name);
+
+    static void writeEvent(
+            ProfilerThreadData*   data,
+      const char*                 category,
+      const char*                 name,
+            int64_t               start,
+            int64_t               end);
+
+    bool isTraceKeyPressed();
+
+    void requestTrace(
+            int64_t               time);
+
+    void runWriteThread();
+
+    void writeTrace(
+            int64_t               time);
+
+    std::string getTraceFileName();
+
+  };
+
+
+  /**
+   * \brief Scoped profiler zone
+   *
+   * Records the time between construction
+   * and destruction of the object.
+   */
+  class ProfilerZone {
+
+  public:
+
+    ProfilerZone(const char* category, const char* name)
+    : m_category(category), m_name(name),
+      m_start(Profiler::isEnabled() ? Profiler::now() : 0) { }
+
+    ~ProfilerZone() {
+      if (m_start)
+        Profiler::recordZone(m_category, m_name, m_start, Profiler::now());
+    }
+
+    ProfilerZone             (const ProfilerZone&) = delete;
+    ProfilerZone& operator = (const ProfilerZone&) = delete;
+
+  private:
+
+    const char* m_category;
+    const char* m_name;
+    int64_t     m_start;
+
+  };
+
+}
+
+#define DXVK_PROFILE_CONCAT_(a, b) a ## b
+#define DXVK_PROFILE_CONCAT(a, b) DXVK_PROFILE_CONCAT_(a, b)
+
+#ifdef DXVK_PROFILER
+#define DXVK_PROFILE_ZONE(category, name) \
+  ::dxvk::ProfilerZone DXVK_PROFILE_CONCAT(profilerZone, __LINE__)(category, name)
+#else
+#define DXVK_PROFILE_ZONE(category, name) do { } while (0)
+#endif
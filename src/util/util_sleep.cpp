@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "util_sleep.h"
 #include "util_string.h"
 
@@ -28,6 +30,7 @@ namespace dxvk {
 
     initializePlatformSpecifics();
     m_sleepThreshold = 4 * m_sleepGranularity;
+    m_sleepOvershoot.store(m_sleepGranularity.count(), std::memory_order_relaxed);
 
     m_initialized.store(true, std::memory_order_release);
   }
@@ -76,12 +79,9 @@ namespace dxvk {
     if (!m_initialized.load(std::memory_order_acquire))
       initialize();
 
-    // Busy-wait for the last couple of milliseconds since sleeping
-    // on Windows is highly inaccurate and inconsistent.
-    TimerDuration sleepThreshold = m_sleepThreshold;
-
-    if (m_sleepGranularity != TimerDuration::zero())
-      sleepThreshold += duration / 6;
+    // Busy-wait for the last part of the interval since system
+    // sleep functions tend to be inaccurate, especially under load.
+    TimerDuration sleepThreshold = computeSleepThreshold(duration);
 
     TimerDuration remaining = duration;
     TimePoint t1 = t0;
@@ -92,7 +92,11 @@ namespace dxvk {
       systemSleep(sleepDuration);
 
       t1 = dxvk::high_resolution_clock::now();
-      remaining -= std::chrono::duration_cast<TimerDuration>(t1 - t0);
+
+      TimerDuration elapsed = std::chrono::duration_cast<TimerDuration>(t1 - t0);
+      updateSleepOvershoot(elapsed - sleepDuration);
+
+      remaining -= elapsed;
       t0 = t1;
     }
 
@@ -107,6 +111,35 @@ namespace dxvk {
   }
 
 
+  Sleep::TimerDuration Sleep::computeSleepThreshold(TimerDuration duration) const {
+    // Spin for somewhat longer than the typical amount of time
+    // the system oversleeps, but never less than the granularity
+    // of the system timer, and never for longer than the static
+    // threshold that we previously used unconditionally.
+    TimerDuration overshoot(m_sleepOvershoot.load(std::memory_order_relaxed));
+
+    TimerDuration minThreshold = m_sleepGranularity;
+    TimerDuration maxThreshold = m_sleepThreshold + duration / 6;
+
+    return std::clamp(overshoot + overshoot / 2, minThreshold, maxThreshold);
+  }
+
+
+  void Sleep::updateSleepOvershoot(TimerDuration overshoot) {
+    // React to increasing overshoot quickly, but only
+    // decrease the estimate slowly in order to avoid
+    // missing deadlines on a system under heavy load.
+    TimerDuration estimate(m_sleepOvershoot.load(std::memory_order_relaxed));
+    overshoot = std::max(overshoot, TimerDuration::zero());
+
+    estimate += overshoot > estimate
+      ? (overshoot - estimate) / 2
+      : (overshoot - estimate) / 16;
+
+    m_sleepOvershoot.store(estimate.count(), std::memory_order_relaxed);
+  }
+
+
   void Sleep::systemSleep(TimerDuration duration) {
 #ifdef _WIN32
     if (NtDelayExecution) {
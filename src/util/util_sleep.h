@@ -63,6 +63,8 @@ namespace dxvk {
     TimerDuration m_sleepGranularity = TimerDuration::zero();
     TimerDuration m_sleepThreshold   = TimerDuration::zero();
 
+    std::atomic<TimerDuration::rep> m_sleepOvershoot = { 0 };
+
     Sleep();
 
     void initialize();
@@ -73,6 +75,10 @@ namespace dxvk {
 
     void systemSleep(TimerDuration duration);
 
+    TimerDuration computeSleepThreshold(TimerDuration duration) const;
+
+    void updateSleepOvershoot(TimerDuration overshoot);
+
   };
 
 }
@@ -399,6 +399,11 @@ namespace dxvk::vk {
     VULKAN_FN(vkSetHdrMetadataEXT);
     #endif
 
+    #ifdef VK_EXT_host_image_copy
+    VULKAN_FN(vkCopyMemoryToImageEXT);
+    VULKAN_FN(vkTransitionImageLayoutEXT);
+    #endif
+
     #ifdef VK_EXT_shader_module_identifier
     VULKAN_FN(vkGetShaderModuleCreateInfoIdentifierEXT);
     VULKAN_FN(vkGetShaderModuleIdentifierEXT);
@@ -0,0 +1,271 @@
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Redundant state replay benchmark
+ *
+ * Replays a synthetic frame in which every draw sets its render
+ * states and then changes and restores some of them again before
+ * drawing, which is a common pattern in middleware. The frame is
+ * replayed once with \c d3d11.deferRenderState disabled and once
+ * with it enabled, and the CS command bytes and elided state
+ * changes are read back from the DXVK stat stream.
+ *
+ * The stat stream is only written on present, so this needs a
+ * window and a swap chain, and only runs on Windows.
+ *
+ * Usage: bench-d3d11-state-replay [frames] [draws per frame]
+ */
+
+struct ReplayStates {
+  Com<ID3D11BlendState>         blend[2];
+  Com<ID3D11DepthStencilState>  depthStencil[2];
+  Com<ID3D11RasterizerState>    rasterizer[2];
+};
+
+
+struct ReplayResult {
+  double    cpuUsPerFrame = 0.0;
+  uint64_t  frames        = 0;
+  uint64_t  commandBytes  = 0;
+  uint64_t  chunks        = 0;
+  uint64_t  elided        = 0;
+};
+
+
+HWND createWindow() {
+  WNDCLASSEXA wc = { };
+  wc.cbSize         = sizeof(wc);
+  wc.lpfnWndProc    = DefWindowProcA;
+  wc.hInstance      = GetModuleHandleA(nullptr);
+  wc.lpszClassName  = "bench-d3d11-state-replay";
+  RegisterClassExA(&wc);
+
+  return CreateWindowExA(0, wc.lpszClassName, wc.lpszClassName,
+    WS_OVERLAPPEDWINDOW, 0, 0, 256, 256, nullptr, nullptr, wc.hInstance, nullptr);
+}
+
+
+bool createStates(ID3D11Device* device, ReplayStates* states) {
+  for (uint32_t i = 0; i < 2; i++) {
+    D3D11_BLEND_DESC blendDesc = { };
+    blendDesc.RenderTarget[0].BlendEnable           = i;
+    blendDesc.RenderTarget[0].SrcBlend              = D3D11_BLEND_SRC_ALPHA;
+    blendDesc.RenderTarget[0].DestBlend             = D3D11_BLEND_INV_SRC_ALPHA;
+    blendDesc.RenderTarget[0].BlendOp               = D3D11_BLEND_OP_ADD;
+    blendDesc.RenderTarget[0].SrcBlendAlpha         = D3D11_BLEND_ONE;
+    blendDesc.RenderTarget[0].DestBlendAlpha        = D3D11_BLEND_ZERO;
+    blendDesc.RenderTarget[0].BlendOpAlpha          = D3D11_BLEND_OP_ADD;
+    blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+    D3D11_DEPTH_STENCIL_DESC dsDesc = { };
+    dsDesc.DepthEnable    = i;
+    dsDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    dsDesc.DepthFunc      = D3D11_COMPARISON_LESS_EQUAL;
+
+    D3D11_RASTERIZER_DESC rsDesc = { };
+    rsDesc.FillMode        = D3D11_FILL_SOLID;
+    rsDesc.CullMode        = i ? D3D11_CULL_BACK : D3D11_CULL_NONE;
+    rsDesc.DepthClipEnable = TRUE;
+
+    if (FAILED(device->CreateBlendState(&blendDesc, &states->blend[i]))
+     || FAILED(device->CreateDepthStencilState(&dsDesc, &states->depthStencil[i]))
+     || FAILED(device->CreateRasterizerState(&rsDesc, &states->rasterizer[i])))
+      return false;
+  }
+
+  return true;
+}
+
+
+/**
+ * \brief Records one frame
+ *
+ * Each draw uses one of two materials. Before drawing, the
+ * blend and rasterizer states are temporarily switched and
+ * restored, and the blend factor is set to its current value.
+ */
+void recordFrame(ID3D11DeviceContext* context, const ReplayStates& states, uint32_t drawCount) {
+  static const FLOAT blendFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+  for (uint32_t i = 0; i < drawCount; i++) {
+    uint32_t material = (i / 8) & 1;
+
+    context->OMSetBlendState(states.blend[material].ptr(), blendFactor, ~0u);
+    context->OMSetDepthStencilState(states.depthStencil[material].ptr(), 0);
+    context->RSSetState(states.rasterizer[material].ptr());
+
+    context->OMSetBlendState(states.blend[material ^ 1].ptr(), blendFactor, ~0u);
+    context->RSSetState(states.rasterizer[material ^ 1].ptr());
+
+    context->OMSetBlendState(states.blend[material].ptr(), blendFactor, ~0u);
+    context->RSSetState(states.rasterizer[material].ptr());
+
+    context->Draw(3, 0);
+  }
+}
+
+
+/**
+ * \brief Sums up columns of a stat stream
+ */
+bool readStats(const std::string& fileName, ReplayResult* result) {
+  std::ifstream file(fileName);
+  std::string line;
+
+  if (!std::getline(file, line))
+    return false;
+
+  std::vector<std::string> columns;
+  std::stringstream header(line);
+
+  for (std::string column; std::getline(header, column, ','); )
+    columns.push_back(column);
+
+  while (std::getline(file, line)) {
+    std::stringstream row(line);
+    std::string value;
+
+    for (size_t i = 0; i < columns.size() && std::getline(row, value, ','); i++) {
+      uint64_t number = std::strtoull(value.c_str(), nullptr, 10);
+
+      if (columns[i] == "CsCommandBytes")
+        result->commandBytes += number;
+      else if (columns[i] == "CsChunkCount")
+        result->chunks += number;
+      else if (columns[i] == "StateBlendElided"
+            || columns[i] == "StateDepthStencilElided"
+            || columns[i] == "StateRasterizerElided")
+        result->elided += number;
+    }
+
+    result->frames += 1;
+  }
+
+  return result->frames != 0;
+}
+
+
+bool runReplay(HWND window, bool deferRenderState, uint32_t frameCount, uint32_t drawCount, ReplayResult* result) {
+  SetEnvironmentVariableA("DXVK_CONFIG", deferRenderState
+    ? "d3d11.deferRenderState = True"
+    : "d3d11.deferRenderState = False");
+
+  DXGI_SWAP_CHAIN_DESC scDesc = { };
+  scDesc.BufferDesc.Width   = 256;
+  scDesc.BufferDesc.Height  = 256;
+  scDesc.BufferDesc.Format  = DXGI_FORMAT_R8G8B8A8_UNORM;
+  scDesc.SampleDesc.Count   = 1;
+  scDesc.BufferUsage        = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+  scDesc.BufferCount        = 2;
+  scDesc.OutputWindow       = window;
+  scDesc.Windowed           = TRUE;
+  scDesc.SwapEffect         = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+
+  D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+
+  Com<ID3D11Device> device;
+  Com<ID3D11DeviceContext> context;
+  Com<IDXGISwapChain> swapChain;
+
+  if (FAILED(D3D11CreateDeviceAndSwapChain(nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, 0,
+      &featureLevel, 1, D3D11_SDK_VERSION, &scDesc, &swapChain, &device, nullptr, &context)))
+    return false;
+
+  ReplayStates states;
+
+  if (!createStates(device.ptr(), &states))
+    return false;
+
+  Com<ID3D11Texture2D> backBuffer;
+  Com<ID3D11RenderTargetView> rtv;
+
+  if (FAILED(swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&backBuffer)))
+   || FAILED(device->CreateRenderTargetView(backBuffer.ptr(), nullptr, &rtv)))
+    return false;
+
+  D3D11_VIEWPORT viewport = { 0.0f, 0.0f, 256.0f, 256.0f, 0.0f, 1.0f };
+
+  double cpuUs = 0.0;
+
+  // The first present only starts the stat stream
+  swapChain->Present(0, 0);
+
+  for (uint32_t i = 0; i < frameCount; i++) {
+    d3d11test::Timer timer;
+
+    context->OMSetRenderTargets(1, &rtv, nullptr);
+    context->RSSetViewports(1, &viewport);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    recordFrame(context.ptr(), states, drawCount);
+    context->Flush();
+
+    cpuUs += timer.elapsedUs();
+
+    swapChain->Present(0, 0);
+  }
+
+  result->cpuUsPerFrame = cpuUs / double(frameCount);
+  return true;
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t frameCount = argc > 1 ? uint32_t(std::atoi(argv[1])) : 200u;
+  uint32_t drawCount  = argc > 2 ? uint32_t(std::atoi(argv[2])) : 1000u;
+
+  char tempPath[MAX_PATH];
+  GetTempPathA(MAX_PATH, tempPath);
+
+  std::string statsPath = std::string(tempPath) + "dxvk-bench-state-replay\\";
+  CreateDirectoryA(statsPath.c_str(), nullptr);
+  SetEnvironmentVariableA("DXVK_STATS_PATH", statsPath.c_str());
+
+  HWND window = createWindow();
+
+  ReplayResult results[2];
+
+  // Each device writes its own stat stream, numbered in the
+  // order in which they were created by this process. The
+  // stream is written out when the device is destroyed.
+  for (uint32_t i = 0; i < 2; i++) {
+    if (!runReplay(window, i != 0, frameCount, drawCount, &results[i])) {
+      std::fprintf(stderr, "Failed to run replay\n");
+      return 77;
+    }
+
+    std::string fileName = statsPath + "bench-d3d11-state-replay_stats"
+      + (i ? "_" + std::to_string(i) : std::string()) + ".csv";
+
+    if (!readStats(fileName, &results[i])) {
+      std::fprintf(stderr, "Failed to read %s, is DXVK in use?\n", fileName.c_str());
+      return 77;
+    }
+  }
+
+  DestroyWindow(window);
+
+  std::printf("%-10s %14s %16s %14s %14s\n", "Mode", "CPU (us/frame)", "CS bytes/frame", "Chunks/frame", "Elided/frame");
+
+  for (uint32_t i = 0; i < 2; i++) {
+    double frames = double(results[i].frames);
+
+    std::printf("%-10s %14.2f %16.0f %14.2f %14.0f\n", i ? "deferred" : "immediate",
+      results[i].cpuUsPerFrame,
+      double(results[i].commandBytes) / frames,
+      double(results[i].chunks) / frames,
+      double(results[i].elided) / frames);
+  }
+
+  double bytesImmediate = double(results[0].commandBytes) / double(results[0].frames);
+  double bytesDeferred  = double(results[1].commandBytes) / double(results[1].frames);
+
+  std::printf("CS bytes saved per frame: %.0f (%.1f%%)\n", bytesImmediate - bytesDeferred,
+    bytesImmediate > 0.0 ? 100.0 * (bytesImmediate - bytesDeferred) / bytesImmediate : 0.0);
+  return 0;
+}
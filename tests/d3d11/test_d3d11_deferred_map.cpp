@@ -0,0 +1,158 @@
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Deferred context map test
+ *
+ * Maps many dynamic buffers on a deferred context, first with
+ * WRITE_DISCARD and then repeatedly with WRITE_NO_OVERWRITE, and
+ * checks the contents after executing the command list. With
+ * \c --bench, measures the cost of Map calls on a deferred context
+ * for an increasing number of buffers instead.
+ */
+
+constexpr UINT BufferSize = 256;
+
+uint32_t getValue(uint32_t buffer, uint32_t index) {
+  return (buffer << 16) | index;
+}
+
+
+std::vector<Com<ID3D11Buffer>> createBuffers(ID3D11Device* device, uint32_t count) {
+  std::vector<Com<ID3D11Buffer>> buffers(count);
+
+  for (uint32_t i = 0; i < count; i++) {
+    buffers[i] = d3d11test::createBuffer(device, BufferSize, D3D11_USAGE_DYNAMIC,
+      D3D11_BIND_VERTEX_BUFFER, D3D11_CPU_ACCESS_WRITE);
+  }
+
+  return buffers;
+}
+
+
+/**
+ * \brief Records maps into a deferred context
+ *
+ * Each buffer is discarded once, and then written
+ * in chunks with one no-overwrite map per chunk.
+ */
+bool recordMaps(ID3D11DeviceContext* context,
+    const std::vector<Com<ID3D11Buffer>>& buffers, uint32_t chunks) {
+  constexpr uint32_t ValueCount = BufferSize / sizeof(uint32_t);
+  const uint32_t chunkSize = ValueCount / chunks;
+
+  for (uint32_t i = 0; i < buffers.size(); i++) {
+    D3D11_MAPPED_SUBRESOURCE sr = { };
+
+    if (FAILED(context->Map(buffers[i].ptr(), 0, D3D11_MAP_WRITE_DISCARD, 0, &sr)))
+      return false;
+
+    std::memset(sr.pData, 0, BufferSize);
+    context->Unmap(buffers[i].ptr(), 0);
+  }
+
+  for (uint32_t c = 0; c < chunks; c++) {
+    // Interleave buffers so that lookups cannot
+    // benefit from the most recent map entry
+    for (uint32_t i = 0; i < buffers.size(); i++) {
+      D3D11_MAPPED_SUBRESOURCE sr = { };
+
+      if (FAILED(context->Map(buffers[i].ptr(), 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &sr)))
+        return false;
+
+      auto data = reinterpret_cast<uint32_t*>(sr.pData);
+
+      for (uint32_t j = c * chunkSize; j < (c + 1) * chunkSize; j++)
+        data[j] = getValue(i, j);
+
+      context->Unmap(buffers[i].ptr(), 0);
+    }
+  }
+
+  return true;
+}
+
+
+int runTest(ID3D11Device* device, ID3D11DeviceContext* context) {
+  Com<ID3D11DeviceContext> deferred;
+
+  if (FAILED(device->CreateDeferredContext(0, &deferred)))
+    return 77;
+
+  auto buffers = createBuffers(device, 512);
+
+  if (!recordMaps(deferred.ptr(), buffers, 8)) {
+    std::fprintf(stderr, "Map failed\n");
+    return 1;
+  }
+
+  Com<ID3D11CommandList> commandList;
+  deferred->FinishCommandList(FALSE, &commandList);
+  context->ExecuteCommandList(commandList.ptr(), FALSE);
+
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < buffers.size(); i++) {
+    auto data = d3d11test::readBuffer(device, context, buffers[i].ptr());
+
+    for (uint32_t j = 0; j < data.size(); j++) {
+      if (data[j] != getValue(i, j) && errors++ < 16) {
+        std::fprintf(stderr, "Buffer %u, index %u: got %08x, expected %08x\n",
+          i, j, data[j], getValue(i, j));
+      }
+    }
+  }
+
+  std::printf("%u errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+
+int runBenchmark(ID3D11Device* device, ID3D11DeviceContext* context) {
+  Com<ID3D11DeviceContext> deferred;
+
+  if (FAILED(device->CreateDeferredContext(0, &deferred)))
+    return 77;
+
+  std::printf("%8s %14s\n", "Buffers", "ns per Map");
+
+  for (uint32_t count = 16; count <= 4096; count *= 4) {
+    auto buffers = createBuffers(device, count);
+
+    constexpr uint32_t Chunks = 8;
+    constexpr uint32_t Iterations = 8;
+
+    double totalUs = 0.0;
+
+    for (uint32_t i = 0; i < Iterations; i++) {
+      d3d11test::Timer timer;
+      recordMaps(deferred.ptr(), buffers, Chunks);
+      totalUs += timer.elapsedUs();
+
+      Com<ID3D11CommandList> commandList;
+      deferred->FinishCommandList(FALSE, &commandList);
+      context->ExecuteCommandList(commandList.ptr(), FALSE);
+    }
+
+    double mapCount = double(count * (Chunks + 1) * Iterations);
+    std::printf("%8u %14.1f\n", count, totalUs * 1000.0 / mapCount);
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  Com<ID3D11Device> device;
+  Com<ID3D11DeviceContext> context;
+
+  if (!d3d11test::createDevice(&device, &context)) {
+    std::fprintf(stderr, "Failed to create device\n");
+    return 77;
+  }
+
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  return bench
+    ? runBenchmark(device.ptr(), context.ptr())
+    : runTest(device.ptr(), context.ptr());
+}
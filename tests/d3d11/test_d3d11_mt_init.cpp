@@ -0,0 +1,223 @@
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Multi-threaded resource initialization test
+ *
+ * Creates textures and buffers with initial data from several
+ * threads at once and checks their contents. With \c --bench,
+ * measures initialization throughput for an increasing number
+ * of threads. Host image copies are disabled so that texture
+ * uploads go through the initialization contexts.
+ */
+
+constexpr uint32_t TextureSize = 64;
+constexpr uint32_t BufferSize  = 4096;
+
+const char* InitConfig = "dxvk.enableHostImageCopy = False";
+
+
+uint32_t getValue(uint32_t resource, uint32_t index) {
+  return (resource << 16) | (index & 0xffff);
+}
+
+
+struct InitData {
+  std::vector<uint32_t> texels;
+  std::vector<uint32_t> buffer;
+};
+
+
+InitData createInitData(uint32_t resource) {
+  InitData result;
+  result.texels.resize(TextureSize * TextureSize);
+  result.buffer.resize(BufferSize / sizeof(uint32_t));
+
+  for (uint32_t i = 0; i < result.texels.size(); i++)
+    result.texels[i] = getValue(resource, i);
+
+  for (uint32_t i = 0; i < result.buffer.size(); i++)
+    result.buffer[i] = getValue(resource, i) ^ 0x8000u;
+
+  return result;
+}
+
+
+D3D11_TEXTURE2D_DESC getTextureDesc(D3D11_USAGE usage) {
+  D3D11_TEXTURE2D_DESC desc = { };
+  desc.Width            = TextureSize;
+  desc.Height           = TextureSize;
+  desc.MipLevels        = 1;
+  desc.ArraySize        = 1;
+  desc.Format           = DXGI_FORMAT_R32_UINT;
+  desc.SampleDesc.Count = 1;
+  desc.Usage            = usage;
+  desc.BindFlags        = usage == D3D11_USAGE_STAGING ? 0 : D3D11_BIND_SHADER_RESOURCE;
+  desc.CPUAccessFlags   = usage == D3D11_USAGE_STAGING ? D3D11_CPU_ACCESS_READ : 0;
+  return desc;
+}
+
+
+struct Resources {
+  std::vector<Com<ID3D11Texture2D>> textures;
+  std::vector<Com<ID3D11Buffer>>    buffers;
+};
+
+
+/**
+ * \brief Creates resources from multiple threads
+ *
+ * Each thread creates a contiguous range of resources.
+ * \returns Number of resources that failed to create
+ */
+uint32_t createResources(ID3D11Device* device, uint32_t threadCount, uint32_t resourceCount, Resources* resources) {
+  resources->textures.resize(resourceCount);
+  resources->buffers.resize(resourceCount);
+
+  std::vector<uint32_t> failures(threadCount);
+
+  d3d11test::runThreads(threadCount, [&] (uint32_t thread) {
+    uint32_t first = (resourceCount * thread) / threadCount;
+    uint32_t last  = (resourceCount * (thread + 1)) / threadCount;
+
+    D3D11_TEXTURE2D_DESC textureDesc = getTextureDesc(D3D11_USAGE_IMMUTABLE);
+
+    D3D11_BUFFER_DESC bufferDesc = { };
+    bufferDesc.ByteWidth = BufferSize;
+    bufferDesc.Usage     = D3D11_USAGE_DEFAULT;
+    bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    for (uint32_t i = first; i < last; i++) {
+      InitData data = createInitData(i);
+
+      D3D11_SUBRESOURCE_DATA textureData = { };
+      textureData.pSysMem     = data.texels.data();
+      textureData.SysMemPitch = TextureSize * sizeof(uint32_t);
+
+      D3D11_SUBRESOURCE_DATA bufferData = { };
+      bufferData.pSysMem = data.buffer.data();
+
+      if (FAILED(device->CreateTexture2D(&textureDesc, &textureData, &resources->textures[i])))
+        failures[thread] += 1;
+
+      if (FAILED(device->CreateBuffer(&bufferDesc, &bufferData, &resources->buffers[i])))
+        failures[thread] += 1;
+    }
+  });
+
+  uint32_t result = 0;
+
+  for (uint32_t count : failures)
+    result += count;
+
+  return result;
+}
+
+
+uint32_t checkResource(ID3D11Device* device, ID3D11DeviceContext* context, const Resources& resources, uint32_t index) {
+  InitData expected = createInitData(index);
+  uint32_t errors = 0;
+
+  D3D11_TEXTURE2D_DESC desc = getTextureDesc(D3D11_USAGE_STAGING);
+  Com<ID3D11Texture2D> staging;
+
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, &staging)))
+    return 1;
+
+  context->CopyResource(staging.ptr(), resources.textures[index].ptr());
+
+  D3D11_MAPPED_SUBRESOURCE sr = { };
+
+  if (FAILED(context->Map(staging.ptr(), 0, D3D11_MAP_READ, 0, &sr)))
+    return 1;
+
+  for (uint32_t y = 0; y < TextureSize; y++) {
+    auto row = reinterpret_cast<const uint32_t*>(
+      reinterpret_cast<const char*>(sr.pData) + y * sr.RowPitch);
+
+    for (uint32_t x = 0; x < TextureSize; x++) {
+      if (row[x] != expected.texels[y * TextureSize + x])
+        errors += 1;
+    }
+  }
+
+  context->Unmap(staging.ptr(), 0);
+
+  auto buffer = d3d11test::readBuffer(device, context, resources.buffers[index].ptr());
+
+  for (uint32_t i = 0; i < buffer.size(); i++) {
+    if (buffer[i] != expected.buffer[i])
+      errors += 1;
+  }
+
+  if (errors)
+    std::fprintf(stderr, "Resource %u: %u errors\n", index, errors);
+
+  return errors;
+}
+
+
+int runTest(ID3D11Device* device, ID3D11DeviceContext* context) {
+  constexpr uint32_t ThreadCount   = 8;
+  constexpr uint32_t ResourceCount = 1024;
+
+  Resources resources;
+  uint32_t errors = createResources(device, ThreadCount, ResourceCount, &resources);
+
+  if (errors)
+    std::fprintf(stderr, "Failed to create %u resources\n", errors);
+
+  // Check a subset of resources from every thread,
+  // including the first and last of each range
+  for (uint32_t i = 0; i < ResourceCount; i++) {
+    if (i % 17 == 0 || (i + 1) % (ResourceCount / ThreadCount) <= 1) {
+      if (resources.textures[i] != nullptr && resources.buffers[i] != nullptr)
+        errors += checkResource(device, context, resources, i);
+    }
+  }
+
+  std::printf("%u errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+
+int runBenchmark(ID3D11Device* device, ID3D11DeviceContext* context) {
+  constexpr uint32_t ResourceCount = 8192;
+
+  std::printf("%-8s %14s %14s %16s\n", "Threads", "Create (ms)", "Idle (ms)", "Resources/s");
+
+  for (uint32_t threadCount = 1; threadCount <= 16; threadCount *= 2) {
+    Resources resources;
+
+    d3d11test::Timer timer;
+
+    createResources(device, threadCount, ResourceCount, &resources);
+
+    double createUs = timer.elapsedUs();
+
+    d3d11test::waitForIdle(device, context);
+
+    double idleUs = timer.elapsedUs();
+
+    std::printf("%-8u %14.2f %14.2f %16.0f\n", threadCount,
+      createUs / 1000.0, idleUs / 1000.0, double(ResourceCount) / (idleUs / 1000000.0));
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  Com<ID3D11Device> device;
+  Com<ID3D11DeviceContext> context;
+
+  if (!d3d11test::createDevice(&device, &context, InitConfig)) {
+    std::fprintf(stderr, "Failed to create device\n");
+    return 77;
+  }
+
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  return bench
+    ? runBenchmark(device.ptr(), context.ptr())
+    : runTest(device.ptr(), context.ptr());
+}
@@ -0,0 +1,163 @@
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Nested command list test
+ *
+ * Builds a chain of command lists where each one executes the
+ * previous one and then writes to the same buffer, and checks
+ * that all writes happen in order. With \c --bench, measures
+ * the cost of building and executing deep and wide nestings.
+ */
+
+constexpr uint32_t MaxDepth = 64;
+
+
+void writeValue(ID3D11DeviceContext* context, ID3D11Buffer* buffer, uint32_t index, uint32_t value) {
+  D3D11_BOX box = { };
+  box.left   = index * sizeof(uint32_t);
+  box.right  = box.left + sizeof(uint32_t);
+  box.bottom = 1;
+  box.back   = 1;
+
+  context->UpdateSubresource(buffer, 0, &box, &value, 0, 0);
+}
+
+
+/**
+ * \brief Builds a chain of nested command lists
+ *
+ * Level \c i executes level \c i-1, writes its own index
+ * to slot \c i and then overwrites slot 0, so that slot 0
+ * holds the index of the last level that ran.
+ */
+Com<ID3D11CommandList> buildChain(ID3D11DeviceContext* deferred, ID3D11Buffer* buffer, uint32_t depth) {
+  Com<ID3D11CommandList> commandList;
+
+  for (uint32_t i = 1; i <= depth; i++) {
+    if (commandList != nullptr)
+      deferred->ExecuteCommandList(commandList.ptr(), FALSE);
+
+    writeValue(deferred, buffer, i, i);
+    writeValue(deferred, buffer, 0, i);
+
+    Com<ID3D11CommandList> next;
+    deferred->FinishCommandList(FALSE, &next);
+    commandList = std::move(next);
+  }
+
+  return commandList;
+}
+
+
+/**
+ * \brief Builds a wide nesting
+ *
+ * Executes the same child list many times from one parent.
+ */
+Com<ID3D11CommandList> buildWide(ID3D11DeviceContext* deferred, ID3D11Buffer* buffer, uint32_t width) {
+  writeValue(deferred, buffer, 1, 1);
+
+  Com<ID3D11CommandList> child;
+  deferred->FinishCommandList(FALSE, &child);
+
+  for (uint32_t i = 0; i < width; i++)
+    deferred->ExecuteCommandList(child.ptr(), FALSE);
+
+  Com<ID3D11CommandList> parent;
+  deferred->FinishCommandList(FALSE, &parent);
+  return parent;
+}
+
+
+int runTest(ID3D11Device* device, ID3D11DeviceContext* context) {
+  Com<ID3D11DeviceContext> deferred;
+
+  if (FAILED(device->CreateDeferredContext(0, &deferred)))
+    return 77;
+
+  Com<ID3D11Buffer> buffer = d3d11test::createBuffer(device,
+    (MaxDepth + 1) * sizeof(uint32_t), D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0);
+
+  Com<ID3D11CommandList> chain = buildChain(deferred.ptr(), buffer.ptr(), MaxDepth);
+
+  // Executing the list twice must produce the same result
+  for (uint32_t i = 0; i < 2; i++) {
+    std::vector<uint32_t> zero(MaxDepth + 1, 0u);
+    context->UpdateSubresource(buffer.ptr(), 0, nullptr, zero.data(), 0, 0);
+    context->ExecuteCommandList(chain.ptr(), FALSE);
+  }
+
+  auto data = d3d11test::readBuffer(device, context, buffer.ptr());
+
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i <= MaxDepth; i++) {
+    uint32_t expected = i ? i : MaxDepth;
+
+    if (data[i] != expected && errors++ < 16)
+      std::fprintf(stderr, "Slot %u: got %u, expected %u\n", i, data[i], expected);
+  }
+
+  std::printf("%u errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+
+int runBenchmark(ID3D11Device* device, ID3D11DeviceContext* context) {
+  Com<ID3D11DeviceContext> deferred;
+
+  if (FAILED(device->CreateDeferredContext(0, &deferred)))
+    return 77;
+
+  Com<ID3D11Buffer> buffer = d3d11test::createBuffer(device,
+    (MaxDepth + 1) * sizeof(uint32_t), D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0);
+
+  constexpr uint32_t Iterations = 64;
+
+  std::printf("%-6s %6s %14s %14s\n", "Shape", "Size", "Build (us)", "Execute (us)");
+
+  for (uint32_t wide = 0; wide < 2; wide++) {
+    for (uint32_t size = 4; size <= (wide ? 4096u : MaxDepth); size *= 4) {
+      double buildUs = 0.0;
+      double executeUs = 0.0;
+
+      for (uint32_t i = 0; i < Iterations; i++) {
+        d3d11test::Timer buildTimer;
+
+        Com<ID3D11CommandList> commandList = wide
+          ? buildWide(deferred.ptr(), buffer.ptr(), size)
+          : buildChain(deferred.ptr(), buffer.ptr(), size);
+
+        buildUs += buildTimer.elapsedUs();
+
+        d3d11test::Timer executeTimer;
+        context->ExecuteCommandList(commandList.ptr(), FALSE);
+        executeUs += executeTimer.elapsedUs();
+      }
+
+      context->Flush();
+
+      std::printf("%-6s %6u %14.2f %14.2f\n", wide ? "Wide" : "Deep", size,
+        buildUs / double(Iterations), executeUs / double(Iterations));
+    }
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  Com<ID3D11Device> device;
+  Com<ID3D11DeviceContext> context;
+
+  if (!d3d11test::createDevice(&device, &context)) {
+    std::fprintf(stderr, "Failed to create device\n");
+    return 77;
+  }
+
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  return bench
+    ? runBenchmark(device.ptr(), context.ptr())
+    : runTest(device.ptr(), context.ptr());
+}
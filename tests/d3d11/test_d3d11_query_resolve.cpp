@@ -0,0 +1,189 @@
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Occlusion query resolve test
+ *
+ * Issues many occlusion queries per frame, in the way engines do
+ * for occlusion culling, and reads the results back a few frames
+ * later. Checks that all queries become available and report no
+ * samples, since no shaders are bound. With \c --bench, measures
+ * the CPU time spent per frame issuing queries and reading back
+ * their results for an increasing number of queries.
+ */
+
+constexpr uint32_t FrameLatency = 2;
+
+
+struct QueryFrame {
+  std::vector<Com<ID3D11Query>> occlusion;
+  std::vector<Com<ID3D11Query>> predicates;
+};
+
+
+bool createQueries(ID3D11Device* device, uint32_t count, QueryFrame* frame) {
+  frame->occlusion.resize(count);
+  frame->predicates.resize(count);
+
+  for (uint32_t i = 0; i < count; i++) {
+    D3D11_QUERY_DESC occlusionDesc = { D3D11_QUERY_OCCLUSION, 0 };
+    D3D11_QUERY_DESC predicateDesc = { D3D11_QUERY_OCCLUSION_PREDICATE, 0 };
+
+    if (FAILED(device->CreateQuery(&occlusionDesc, &frame->occlusion[i]))
+     || FAILED(device->CreateQuery(&predicateDesc, &frame->predicates[i])))
+      return false;
+  }
+
+  return true;
+}
+
+
+/**
+ * \brief Issues all queries of a frame
+ *
+ * Each query wraps one proxy draw. Every fourth
+ * query is an occlusion predicate.
+ */
+void issueQueries(ID3D11DeviceContext* context, const QueryFrame& frame) {
+  context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+  for (uint32_t i = 0; i < frame.occlusion.size(); i++) {
+    ID3D11Query* query = (i & 3) == 3
+      ? frame.predicates[i].ptr()
+      : frame.occlusion[i].ptr();
+
+    context->Begin(query);
+    context->Draw(36, 0);
+    context->End(query);
+  }
+}
+
+
+/**
+ * \brief Reads back all query results of a frame
+ *
+ * Spins until every query is available, without flushing.
+ * \returns Number of queries with unexpected results
+ */
+uint32_t readQueries(ID3D11DeviceContext* context, const QueryFrame& frame) {
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < frame.occlusion.size(); i++) {
+    HRESULT hr;
+
+    if ((i & 3) == 3) {
+      BOOL visible = TRUE;
+
+      while ((hr = context->GetData(frame.predicates[i].ptr(), &visible,
+          sizeof(visible), D3D11_ASYNC_GETDATA_DONOTFLUSH)) == S_FALSE)
+        continue;
+
+      if (FAILED(hr) || visible)
+        errors += 1;
+    } else {
+      UINT64 samples = ~0ull;
+
+      while ((hr = context->GetData(frame.occlusion[i].ptr(), &samples,
+          sizeof(samples), D3D11_ASYNC_GETDATA_DONOTFLUSH)) == S_FALSE)
+        continue;
+
+      if (FAILED(hr) || samples)
+        errors += 1;
+    }
+  }
+
+  return errors;
+}
+
+
+int runTest(ID3D11Device* device, ID3D11DeviceContext* context) {
+  constexpr uint32_t FrameCount = 16;
+  constexpr uint32_t QueryCount = 512;
+
+  QueryFrame frames[FrameLatency + 1];
+
+  for (auto& frame : frames) {
+    if (!createQueries(device, QueryCount, &frame))
+      return 77;
+  }
+
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < FrameCount; i++) {
+    issueQueries(context, frames[i % (FrameLatency + 1)]);
+    context->Flush();
+
+    if (i >= FrameLatency)
+      errors += readQueries(context, frames[(i - FrameLatency) % (FrameLatency + 1)]);
+  }
+
+  d3d11test::waitForIdle(device, context);
+
+  for (uint32_t i = FrameCount - FrameLatency; i < FrameCount; i++)
+    errors += readQueries(context, frames[i % (FrameLatency + 1)]);
+
+  std::printf("%u errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+
+int runBenchmark(ID3D11Device* device, ID3D11DeviceContext* context) {
+  constexpr uint32_t FrameCount = 200;
+
+  std::printf("%-8s %14s %14s %14s\n", "Queries", "Issue (us)", "Resolve (us)", "Frame (us)");
+
+  for (uint32_t queryCount = 256; queryCount <= 8192; queryCount *= 2) {
+    QueryFrame frames[FrameLatency + 1];
+
+    for (auto& frame : frames) {
+      if (!createQueries(device, queryCount, &frame))
+        return 77;
+    }
+
+    double issueUs = 0.0;
+    double resolveUs = 0.0;
+    double frameUs = 0.0;
+
+    for (uint32_t i = 0; i < FrameCount; i++) {
+      d3d11test::Timer frameTimer;
+
+      issueQueries(context, frames[i % (FrameLatency + 1)]);
+      context->Flush();
+
+      issueUs += frameTimer.elapsedUs();
+
+      if (i >= FrameLatency) {
+        d3d11test::Timer resolveTimer;
+        readQueries(context, frames[(i - FrameLatency) % (FrameLatency + 1)]);
+        resolveUs += resolveTimer.elapsedUs();
+      }
+
+      frameUs += frameTimer.elapsedUs();
+    }
+
+    d3d11test::waitForIdle(device, context);
+
+    std::printf("%-8u %14.2f %14.2f %14.2f\n", queryCount,
+      issueUs / double(FrameCount),
+      resolveUs / double(FrameCount - FrameLatency),
+      frameUs / double(FrameCount));
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  Com<ID3D11Device> device;
+  Com<ID3D11DeviceContext> context;
+
+  if (!d3d11test::createDevice(&device, &context)) {
+    std::fprintf(stderr, "Failed to create device\n");
+    return 77;
+  }
+
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  return bench
+    ? runBenchmark(device.ptr(), context.ptr())
+    : runTest(device.ptr(), context.ptr());
+}
@@ -0,0 +1,228 @@
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Texture initialization test
+ *
+ * Creates immutable and default textures with initial data, with
+ * host image copies enabled and disabled, and checks the contents
+ * of every subresource. With \c --bench, measures how long it takes
+ * to create and upload a large number of textures in both modes.
+ */
+
+const char* HostCopyConfigs[] = {
+  "dxvk.enableHostImageCopy = False",
+  "dxvk.enableHostImageCopy = True",
+};
+
+
+uint32_t getTexel(uint32_t level, uint32_t x, uint32_t y) {
+  return (level << 24) | ((y & 0xfff) << 12) | (x & 0xfff);
+}
+
+
+/**
+ * \brief Initial data for a full mip chain
+ */
+struct TextureData {
+  std::vector<std::vector<uint32_t>>  levels;
+  std::vector<D3D11_SUBRESOURCE_DATA> subresources;
+};
+
+
+TextureData createTextureData(uint32_t size, uint32_t levelCount) {
+  TextureData result;
+  result.levels.resize(levelCount);
+  result.subresources.resize(levelCount);
+
+  for (uint32_t i = 0; i < levelCount; i++) {
+    uint32_t levelSize = std::max(size >> i, 1u);
+    result.levels[i].resize(levelSize * levelSize);
+
+    for (uint32_t y = 0; y < levelSize; y++) {
+      for (uint32_t x = 0; x < levelSize; x++)
+        result.levels[i][y * levelSize + x] = getTexel(i, x, y);
+    }
+
+    result.subresources[i].pSysMem = result.levels[i].data();
+    result.subresources[i].SysMemPitch = levelSize * sizeof(uint32_t);
+  }
+
+  return result;
+}
+
+
+D3D11_TEXTURE2D_DESC getTextureDesc(uint32_t size, uint32_t levelCount, D3D11_USAGE usage) {
+  D3D11_TEXTURE2D_DESC desc = { };
+  desc.Width            = size;
+  desc.Height           = size;
+  desc.MipLevels        = levelCount;
+  desc.ArraySize        = 1;
+  desc.Format           = DXGI_FORMAT_R8G8B8A8_UNORM;
+  desc.SampleDesc.Count = 1;
+  desc.Usage            = usage;
+  desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE;
+  return desc;
+}
+
+
+uint32_t getLevelCount(uint32_t size) {
+  uint32_t count = 1;
+
+  while (size > 1) {
+    size >>= 1;
+    count += 1;
+  }
+
+  return count;
+}
+
+
+uint32_t checkTexture(ID3D11Device* device, ID3D11DeviceContext* context,
+    ID3D11Texture2D* texture, uint32_t size, uint32_t levelCount) {
+  D3D11_TEXTURE2D_DESC desc = getTextureDesc(size, levelCount, D3D11_USAGE_STAGING);
+  desc.BindFlags      = 0;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+  Com<ID3D11Texture2D> staging;
+
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, &staging)))
+    return 1;
+
+  context->CopyResource(staging.ptr(), texture);
+
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < levelCount; i++) {
+    uint32_t levelSize = std::max(size >> i, 1u);
+
+    D3D11_MAPPED_SUBRESOURCE sr = { };
+
+    if (FAILED(context->Map(staging.ptr(), i, D3D11_MAP_READ, 0, &sr)))
+      return errors + 1;
+
+    for (uint32_t y = 0; y < levelSize; y++) {
+      auto row = reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const char*>(sr.pData) + y * sr.RowPitch);
+
+      for (uint32_t x = 0; x < levelSize; x++) {
+        uint32_t expected = getTexel(i, x, y);
+
+        if (row[x] != expected && errors++ < 16) {
+          std::fprintf(stderr, "Level %u, (%u,%u): got %08x, expected %08x\n",
+            i, x, y, row[x], expected);
+        }
+      }
+    }
+
+    context->Unmap(staging.ptr(), i);
+  }
+
+  return errors;
+}
+
+
+int runTest() {
+  constexpr uint32_t Size = 128;
+
+  uint32_t levelCount = getLevelCount(Size);
+  TextureData data = createTextureData(Size, levelCount);
+
+  uint32_t errors = 0;
+
+  for (const char* config : HostCopyConfigs) {
+    Com<ID3D11Device> device;
+    Com<ID3D11DeviceContext> context;
+
+    if (!d3d11test::createDevice(&device, &context, config))
+      return 77;
+
+    for (D3D11_USAGE usage : { D3D11_USAGE_IMMUTABLE, D3D11_USAGE_DEFAULT }) {
+      D3D11_TEXTURE2D_DESC desc = getTextureDesc(Size, levelCount, usage);
+
+      Com<ID3D11Texture2D> texture;
+
+      if (FAILED(device->CreateTexture2D(&desc, data.subresources.data(), &texture))) {
+        std::fprintf(stderr, "%s: Failed to create texture\n", config);
+        errors += 1;
+        continue;
+      }
+
+      uint32_t textureErrors = checkTexture(device.ptr(), context.ptr(), texture.ptr(), Size, levelCount);
+
+      if (textureErrors) {
+        std::fprintf(stderr, "%s: %u errors in %s texture\n", config, textureErrors,
+          usage == D3D11_USAGE_IMMUTABLE ? "immutable" : "default");
+      }
+
+      errors += textureErrors;
+    }
+  }
+
+  std::printf("%u errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+
+int runBenchmark() {
+  struct BenchCase {
+    uint32_t size;
+    uint32_t count;
+  };
+
+  constexpr BenchCase Cases[] = {
+    {   64, 4096 },
+    {  256, 1024 },
+    { 1024,   32 },
+  };
+
+  std::printf("%-10s %6s %6s %14s %14s %12s\n", "Host copy", "Size", "Count", "Create (ms)", "Idle (ms)", "MB/s");
+
+  for (uint32_t hostCopy = 0; hostCopy < 2; hostCopy++) {
+    Com<ID3D11Device> device;
+    Com<ID3D11DeviceContext> context;
+
+    if (!d3d11test::createDevice(&device, &context, HostCopyConfigs[hostCopy]))
+      return 77;
+
+    for (const auto& c : Cases) {
+      uint32_t levelCount = getLevelCount(c.size);
+      TextureData data = createTextureData(c.size, levelCount);
+      D3D11_TEXTURE2D_DESC desc = getTextureDesc(c.size, levelCount, D3D11_USAGE_IMMUTABLE);
+
+      size_t dataSize = 0;
+
+      for (const auto& level : data.levels)
+        dataSize += level.size() * sizeof(uint32_t);
+
+      std::vector<Com<ID3D11Texture2D>> textures(c.count);
+
+      d3d11test::Timer timer;
+
+      for (uint32_t i = 0; i < c.count; i++)
+        device->CreateTexture2D(&desc, data.subresources.data(), &textures[i]);
+
+      double createUs = timer.elapsedUs();
+
+      // Initialization may be done asynchronously on the GPU,
+      // so include the time until it has actually completed
+      d3d11test::waitForIdle(device.ptr(), context.ptr());
+
+      double idleUs = timer.elapsedUs();
+      double totalMb = double(dataSize) * double(c.count) / double(1u << 20);
+
+      std::printf("%-10s %6u %6u %14.2f %14.2f %12.1f\n", hostCopy ? "on" : "off",
+        c.size, c.count, createUs / 1000.0, idleUs / 1000.0, totalMb / (idleUs / 1000000.0));
+    }
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  return bench
+    ? runBenchmark()
+    : runTest();
+}
@@ -0,0 +1,244 @@
+#include "test_d3d11_utils.h"
+
+/**
+ * \brief Timestamp query test
+ *
+ * Records clears, copies and mip generation between two timestamp
+ * queries with the GPU profiler enabled, so that profiler zones get
+ * written around them. Checks that timestamps are not disjoint, are
+ * ordered and cover a plausible amount of time, which also catches
+ * drivers reporting bogus timestamp periods or valid bits, as well
+ * as the rendered results. With \c --bench, measures the CPU time
+ * per frame with the GPU profiler disabled and enabled.
+ */
+
+const char* ProfilerConfigs[] = {
+  "dxvk.enableGpuProfiler = False",
+  "dxvk.enableGpuProfiler = True",
+};
+
+constexpr uint32_t TextureSize = 256;
+constexpr uint32_t ClearColor  = 0xff0000ffu;
+
+
+struct FrameResources {
+  Com<ID3D11Texture2D>            renderTarget;
+  Com<ID3D11RenderTargetView>     rtv;
+  Com<ID3D11Texture2D>            mipTexture;
+  Com<ID3D11ShaderResourceView>   mipSrv;
+  Com<ID3D11Texture2D>            flatTexture;
+  Com<ID3D11ShaderResourceView>   flatSrv;
+  Com<ID3D11Buffer>               buffer;
+  Com<ID3D11UnorderedAccessView>  bufferUav;
+  Com<ID3D11Texture2D>            staging;
+};
+
+
+bool createTexture(ID3D11Device* device, uint32_t levelCount,
+    Com<ID3D11Texture2D>* texture, Com<ID3D11ShaderResourceView>* srv) {
+  D3D11_TEXTURE2D_DESC desc = { };
+  desc.Width            = TextureSize;
+  desc.Height           = TextureSize;
+  desc.MipLevels        = levelCount;
+  desc.ArraySize        = 1;
+  desc.Format           = DXGI_FORMAT_R8G8B8A8_UNORM;
+  desc.SampleDesc.Count = 1;
+  desc.Usage            = D3D11_USAGE_DEFAULT;
+  desc.BindFlags        = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+  desc.MiscFlags        = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+  return SUCCEEDED(device->CreateTexture2D(&desc, nullptr, &(*texture)))
+      && SUCCEEDED(device->CreateShaderResourceView(texture->ptr(), nullptr, &(*srv)));
+}
+
+
+bool createResources(ID3D11Device* device, FrameResources* res) {
+  D3D11_TEXTURE2D_DESC desc = { };
+  desc.Width            = TextureSize;
+  desc.Height           = TextureSize;
+  desc.MipLevels        = 1;
+  desc.ArraySize        = 1;
+  desc.Format           = DXGI_FORMAT_R8G8B8A8_UNORM;
+  desc.SampleDesc.Count = 1;
+  desc.Usage            = D3D11_USAGE_DEFAULT;
+  desc.BindFlags        = D3D11_BIND_RENDER_TARGET;
+
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, &res->renderTarget))
+   || FAILED(device->CreateRenderTargetView(res->renderTarget.ptr(), nullptr, &res->rtv)))
+    return false;
+
+  desc.Usage          = D3D11_USAGE_STAGING;
+  desc.BindFlags      = 0;
+  desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+  if (FAILED(device->CreateTexture2D(&desc, nullptr, &res->staging)))
+    return false;
+
+  if (!createTexture(device, 0, &res->mipTexture, &res->mipSrv)
+   || !createTexture(device, 1, &res->flatTexture, &res->flatSrv))
+    return false;
+
+  res->buffer = d3d11test::createBuffer(device, 1u << 16,
+    D3D11_USAGE_DEFAULT, D3D11_BIND_UNORDERED_ACCESS, 0);
+
+  if (res->buffer == nullptr)
+    return false;
+
+  D3D11_UNORDERED_ACCESS_VIEW_DESC uavDesc = { };
+  uavDesc.Format              = DXGI_FORMAT_R32_UINT;
+  uavDesc.ViewDimension       = D3D11_UAV_DIMENSION_BUFFER;
+  uavDesc.Buffer.NumElements  = (1u << 16) / sizeof(uint32_t);
+
+  return SUCCEEDED(device->CreateUnorderedAccessView(res->buffer.ptr(), &uavDesc, &res->bufferUav));
+}
+
+
+/**
+ * \brief Records the operations of one frame
+ *
+ * The single-level mip generation is a no-op and must
+ * not open a profiler zone. The render target clear may
+ * be recorded inside the render pass, everything else
+ * ends it.
+ */
+void recordFrame(ID3D11DeviceContext* context, const FrameResources& res) {
+  const FLOAT color[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+  const UINT zero[4] = { };
+
+  ID3D11RenderTargetView* rtv = res.rtv.ptr();
+  context->OMSetRenderTargets(1, &rtv, nullptr);
+
+  context->ClearRenderTargetView(res.rtv.ptr(), color);
+  context->GenerateMips(res.flatSrv.ptr());
+  context->ClearUnorderedAccessViewUint(res.bufferUav.ptr(), zero);
+  context->GenerateMips(res.mipSrv.ptr());
+  context->CopyResource(res.staging.ptr(), res.renderTarget.ptr());
+
+  context->OMSetRenderTargets(0, nullptr, nullptr);
+}
+
+
+int runTest() {
+  constexpr uint32_t FrameCount = 16;
+
+  Com<ID3D11Device> device;
+  Com<ID3D11DeviceContext> context;
+
+  if (!d3d11test::createDevice(&device, &context, ProfilerConfigs[1])) {
+    std::fprintf(stderr, "Failed to create device\n");
+    return 77;
+  }
+
+  FrameResources res;
+
+  if (!createResources(device.ptr(), &res))
+    return 77;
+
+  D3D11_QUERY_DESC disjointDesc = { D3D11_QUERY_TIMESTAMP_DISJOINT, 0 };
+  D3D11_QUERY_DESC timestampDesc = { D3D11_QUERY_TIMESTAMP, 0 };
+
+  Com<ID3D11Query> disjoint;
+  Com<ID3D11Query> timestamps[2];
+
+  if (FAILED(device->CreateQuery(&disjointDesc, &disjoint))
+   || FAILED(device->CreateQuery(&timestampDesc, &timestamps[0]))
+   || FAILED(device->CreateQuery(&timestampDesc, &timestamps[1])))
+    return 77;
+
+  uint32_t errors = 0;
+
+  for (uint32_t i = 0; i < FrameCount; i++) {
+    context->Begin(disjoint.ptr());
+    context->End(timestamps[0].ptr());
+
+    recordFrame(context.ptr(), res);
+
+    context->End(timestamps[1].ptr());
+    context->End(disjoint.ptr());
+
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData = { };
+    UINT64 t[2] = { };
+
+    while (context->GetData(disjoint.ptr(), &disjointData, sizeof(disjointData), 0) == S_FALSE)
+      continue;
+
+    for (uint32_t j = 0; j < 2; j++) {
+      while (context->GetData(timestamps[j].ptr(), &t[j], sizeof(t[j]), 0) == S_FALSE)
+        continue;
+    }
+
+    if (disjointData.Disjoint || !disjointData.Frequency) {
+      std::fprintf(stderr, "Frame %u: disjoint %u, frequency %llu\n", i,
+        disjointData.Disjoint, (unsigned long long)disjointData.Frequency);
+      errors += 1;
+      continue;
+    }
+
+    // Anything above a second for a handful of small
+    // operations means that timestamps are garbage.
+    if (t[1] < t[0] || t[1] - t[0] > disjointData.Frequency) {
+      std::fprintf(stderr, "Frame %u: bad timestamps %llu, %llu\n", i,
+        (unsigned long long)t[0], (unsigned long long)t[1]);
+      errors += 1;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE sr = { };
+
+    if (FAILED(context->Map(res.staging.ptr(), 0, D3D11_MAP_READ, 0, &sr))) {
+      errors += 1;
+      continue;
+    }
+
+    uint32_t texel = *reinterpret_cast<const uint32_t*>(sr.pData);
+
+    if (texel != ClearColor) {
+      std::fprintf(stderr, "Frame %u: got %08x, expected %08x\n", i, texel, ClearColor);
+      errors += 1;
+    }
+
+    context->Unmap(res.staging.ptr(), 0);
+  }
+
+  std::printf("%u errors\n", errors);
+  return errors ? 1 : 0;
+}
+
+
+int runBenchmark() {
+  constexpr uint32_t FrameCount = 1000;
+
+  std::printf("%-10s %14s\n", "Profiler", "Frame (us)");
+
+  for (uint32_t profiler = 0; profiler < 2; profiler++) {
+    Com<ID3D11Device> device;
+    Com<ID3D11DeviceContext> context;
+
+    if (!d3d11test::createDevice(&device, &context, ProfilerConfigs[profiler]))
+      return 77;
+
+    FrameResources res;
+
+    if (!createResources(device.ptr(), &res))
+      return 77;
+
+    d3d11test::Timer timer;
+
+    for (uint32_t i = 0; i < FrameCount; i++) {
+      recordFrame(context.ptr(), res);
+      context->Flush();
+    }
+
+    d3d11test::waitForIdle(device.ptr(), context.ptr());
+
+    std::printf("%-10s %14.2f\n", profiler ? "enabled" : "disabled",
+      timer.elapsedUs() / double(FrameCount));
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+  return bench ? runBenchmark() : runTest();
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <d3d11.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#ifndef _WIN32
+#include <thread>
+#endif
+
+#include "../../src/util/com/com_pointer.h"
+
+using namespace dxvk;
+
+/**
+ * \brief D3D11 test helpers
+ *
+ * Tests do not present, so no window is needed
+ * and they also run on native builds. The DXVK
+ * configuration can be overridden per device,
+ * since it is read whenever a device is created.
+ */
+namespace d3d11test {
+
+  inline void setConfig(const char* config) {
+#ifdef _WIN32
+    SetEnvironmentVariableA("DXVK_CONFIG", config);
+#else
+    setenv("DXVK_CONFIG", config, 1);
+#endif
+  }
+
+
+  inline bool createDevice(
+          ID3D11Device**        device,
+          ID3D11DeviceContext** context,
+    const char*                 config = nullptr) {
+    D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+
+    if (config)
+      setConfig(config);
+
+    return SUCCEEDED(D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_HARDWARE,
+      nullptr, 0, &featureLevel, 1, D3D11_SDK_VERSION, device, nullptr, context));
+  }
+
+
+  inline Com<ID3D11Buffer> createBuffer(
+          ID3D11Device*         device,
+          UINT                  size,
+          D3D11_USAGE           usage,
+          UINT                  bindFlags,
+          UINT                  cpuFlags) {
+    D3D11_BUFFER_DESC desc = { };
+    desc.ByteWidth      = size;
+    desc.Usage          = usage;
+    desc.BindFlags      = bindFlags;
+    desc.CPUAccessFlags = cpuFlags;
+
+    Com<ID3D11Buffer> buffer;
+
+    if (FAILED(device->CreateBuffer(&desc, nullptr, &buffer)))
+      return nullptr;
+
+    return buffer;
+  }
+
+
+  /**
+   * \brief Reads back buffer contents
+   *
+   * Copies the buffer to a staging buffer on
+   * the immediate context and maps that.
+   */
+  inline std::vector<uint32_t> readBuffer(
+          ID3D11Device*         device,
+          ID3D11DeviceContext*  context,
+          ID3D11Buffer*         buffer) {
+    D3D11_BUFFER_DESC desc = { };
+    buffer->GetDesc(&desc);
+
+    Com<ID3D11Buffer> staging = createBuffer(device, desc.ByteWidth,
+      D3D11_USAGE_STAGING, 0, D3D11_CPU_ACCESS_READ);
+
+    std::vector<uint32_t> result(desc.ByteWidth / sizeof(uint32_t));
+
+    if (staging == nullptr)
+      return result;
+
+    context->CopyResource(staging.ptr(), buffer);
+
+    D3D11_MAPPED_SUBRESOURCE sr = { };
+
+    if (SUCCEEDED(context->Map(staging.ptr(), 0, D3D11_MAP_READ, 0, &sr))) {
+      std::memcpy(result.data(), sr.pData, desc.ByteWidth);
+      context->Unmap(staging.ptr(), 0);
+    }
+
+    return result;
+  }
+
+
+  /**
+   * \brief Waits for submitted work to complete
+   *
+   * Uses an event query, which also flushes
+   * the immediate context.
+   */
+  inline void waitForIdle(
+          ID3D11Device*         device,
+          ID3D11DeviceContext*  context) {
+    D3D11_QUERY_DESC desc = { };
+    desc.Query = D3D11_QUERY_EVENT;
+
+    Com<ID3D11Query> query;
+
+    if (FAILED(device->CreateQuery(&desc, &query)))
+      return;
+
+    context->End(query.ptr());
+
+    BOOL done = FALSE;
+
+    while (context->GetData(query.ptr(), &done, sizeof(done), 0) == S_FALSE)
+      continue;
+  }
+
+
+#ifdef _WIN32
+  struct ThreadArgs {
+    const std::function<void (uint32_t)>* proc;
+    uint32_t index;
+  };
+
+  inline DWORD WINAPI threadProc(void* arg) {
+    auto args = reinterpret_cast<const ThreadArgs*>(arg);
+    (*args->proc)(args->index);
+    return 0;
+  }
+#endif
+
+
+  /**
+   * \brief Runs a function on multiple threads
+   *
+   * Uses native threads on Windows, since MinGW
+   * builds may not support \c std::thread.
+   * \param [in] count Number of threads
+   * \param [in] proc Function taking the thread index
+   */
+  inline void runThreads(uint32_t count, const std::function<void (uint32_t)>& proc) {
+#ifdef _WIN32
+    std::vector<ThreadArgs> args(count);
+    std::vector<HANDLE> threads(count);
+
+    for (uint32_t i = 0; i < count; i++) {
+      args[i] = { &proc, i };
+      threads[i] = CreateThread(nullptr, 0, &threadProc, &args[i], 0, nullptr);
+    }
+
+    WaitForMultipleObjects(count, threads.data(), TRUE, INFINITE);
+
+    for (HANDLE thread : threads)
+      CloseHandle(thread);
+#else
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < count; i++)
+      threads.emplace_back(proc, i);
+
+    for (auto& thread : threads)
+      thread.join();
+#endif
+  }
+
+
+  /**
+   * \brief Simple wall clock timer
+   */
+  class Timer {
+
+  public:
+
+    Timer()
+    : m_start(std::chrono::high_resolution_clock::now()) { }
+
+    double elapsedUs() const {
+      return std::chrono::duration<double, std::micro>(
+        std::chrono::high_resolution_clock::now() - m_start).count();
+    }
+
+  private:
+
+    std::chrono::high_resolution_clock::time_point m_start;
+
+  };
+
+}
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <vector>
+
+#include "test_d3d9_utils.h"
+
+/**
+ * \brief State block test
+ *
+ * Checks that full and sparse state blocks restore exactly the
+ * captured state when applied, including constant ranges, and
+ * leave all other state alone. With \c --bench, measures the
+ * time taken to apply full and sparse state blocks instead.
+ */
+
+constexpr uint32_t VsConstCount = 256;
+constexpr uint32_t PsConstCount = 224;
+
+struct ConstantState {
+  std::vector<float> vs = std::vector<float>(VsConstCount * 4);
+  std::vector<float> ps = std::vector<float>(PsConstCount * 4);
+};
+
+
+void fillConstants(ConstantState& state, float base) {
+  for (size_t i = 0; i < state.vs.size(); i++)
+    state.vs[i] = base + float(i);
+
+  for (size_t i = 0; i < state.ps.size(); i++)
+    state.ps[i] = base - float(i);
+}
+
+
+void setConstants(IDirect3DDevice9* device, const ConstantState& state) {
+  device->SetVertexShaderConstantF(0, state.vs.data(), VsConstCount);
+  device->SetPixelShaderConstantF(0, state.ps.data(), PsConstCount);
+}
+
+
+void getConstants(IDirect3DDevice9* device, ConstantState& state) {
+  device->GetVertexShaderConstantF(0, state.vs.data(), VsConstCount);
+  device->GetPixelShaderConstantF(0, state.ps.data(), PsConstCount);
+}
+
+
+bool checkRange(const char* name, const std::vector<float>& actual,
+    const std::vector<float>& expected, uint32_t first, uint32_t count) {
+  for (uint32_t i = first * 4; i < (first + count) * 4; i++) {
+    if (actual[i] != expected[i]) {
+      std::fprintf(stderr, "%s constant %u.%u: got %g, expected %g\n",
+        name, i / 4, i % 4, double(actual[i]), double(expected[i]));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+Com<IDirect3DStateBlock9> createSparseStateBlock(IDirect3DDevice9* device, const ConstantState& state) {
+  Com<IDirect3DStateBlock9> stateBlock;
+
+  device->BeginStateBlock();
+  device->SetVertexShaderConstantF(10, &state.vs[10 * 4], 3);
+  device->SetVertexShaderConstantF(100, &state.vs[100 * 4], 1);
+  device->SetVertexShaderConstantF(250, &state.vs[250 * 4], 6);
+  device->SetPixelShaderConstantF(5, &state.ps[5 * 4], 2);
+  device->SetRenderState(D3DRS_ZENABLE, D3DZB_FALSE);
+  device->SetRenderState(D3DRS_CULLMODE, D3DCULL_CW);
+  device->SetSamplerState(3, D3DSAMP_MAXANISOTROPY, 4);
+  device->EndStateBlock(&stateBlock);
+
+  return stateBlock;
+}
+
+
+int runTest(IDirect3DDevice9* device) {
+  ConstantState stateA, stateB, result;
+  fillConstants(stateA, 1000.0f);
+  fillConstants(stateB, -1000.0f);
+
+  bool success = true;
+
+  // Full state block captured from state A
+  setConstants(device, stateA);
+  device->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
+
+  Com<IDirect3DStateBlock9> fullBlock;
+  device->CreateStateBlock(D3DSBT_ALL, &fullBlock);
+
+  setConstants(device, stateB);
+  device->SetRenderState(D3DRS_ZENABLE, D3DZB_FALSE);
+
+  fullBlock->Apply();
+  getConstants(device, result);
+
+  success &= checkRange("Full VS", result.vs, stateA.vs, 0, VsConstCount);
+  success &= checkRange("Full PS", result.ps, stateA.ps, 0, PsConstCount);
+
+  DWORD value = 0;
+  device->GetRenderState(D3DRS_ZENABLE, &value);
+
+  if (value != D3DZB_TRUE) {
+    std::fprintf(stderr, "Full: D3DRS_ZENABLE not restored\n");
+    success = false;
+  }
+
+  // Sparse state block recorded with state A values, applied
+  // on top of state B. Only the recorded ranges may change.
+  setConstants(device, stateB);
+  device->SetRenderState(D3DRS_CULLMODE, D3DCULL_CCW);
+
+  Com<IDirect3DStateBlock9> sparseBlock = createSparseStateBlock(device, stateA);
+
+  setConstants(device, stateB);
+  device->SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
+  device->SetRenderState(D3DRS_CULLMODE, D3DCULL_CCW);
+  device->SetRenderState(D3DRS_LIGHTING, FALSE);
+
+  sparseBlock->Apply();
+  getConstants(device, result);
+
+  ConstantState expected = stateB;
+
+  for (uint32_t i : { 10u, 11u, 12u, 100u, 250u, 251u, 252u, 253u, 254u, 255u })
+    std::copy(&stateA.vs[i * 4], &stateA.vs[i * 4 + 4], &expected.vs[i * 4]);
+
+  for (uint32_t i : { 5u, 6u })
+    std::copy(&stateA.ps[i * 4], &stateA.ps[i * 4 + 4], &expected.ps[i * 4]);
+
+  success &= checkRange("Sparse VS", result.vs, expected.vs, 0, VsConstCount);
+  success &= checkRange("Sparse PS", result.ps, expected.ps, 0, PsConstCount);
+
+  device->GetRenderState(D3DRS_CULLMODE, &value);
+
+  if (value != D3DCULL_CW) {
+    std::fprintf(stderr, "Sparse: D3DRS_CULLMODE not applied\n");
+    success = false;
+  }
+
+  device->GetRenderState(D3DRS_LIGHTING, &value);
+
+  if (value != FALSE) {
+    std::fprintf(stderr, "Sparse: D3DRS_LIGHTING was modified\n");
+    success = false;
+  }
+
+  // Capture only updates the states recorded in the block
+  device->SetVertexShaderConstantF(11, &stateB.vs[11 * 4], 1);
+  sparseBlock->Capture();
+
+  setConstants(device, stateA);
+  sparseBlock->Apply();
+  getConstants(device, result);
+
+  expected = stateA;
+  std::copy(&stateB.vs[11 * 4], &stateB.vs[11 * 4 + 4], &expected.vs[11 * 4]);
+
+  success &= checkRange("Capture VS", result.vs, expected.vs, 0, VsConstCount);
+
+  std::printf("%s\n", success ? "Passed" : "Failed");
+  return success ? 0 : 1;
+}
+
+
+int runBenchmark(IDirect3DDevice9* device) {
+  ConstantState state;
+  fillConstants(state, 1.0f);
+  setConstants(device, state);
+
+  Com<IDirect3DStateBlock9> fullBlock;
+  device->CreateStateBlock(D3DSBT_ALL, &fullBlock);
+
+  Com<IDirect3DStateBlock9> sparseBlock = createSparseStateBlock(device, state);
+
+  constexpr uint32_t Iterations = 20000;
+
+  for (auto block : { std::make_pair("Full", fullBlock.ptr()),
+                      std::make_pair("Sparse", sparseBlock.ptr()) }) {
+    d3d9test::Timer timer;
+
+    for (uint32_t i = 0; i < Iterations; i++)
+      block.second->Apply();
+
+    std::printf("%-8s %8.3f us per Apply\n", block.first,
+      timer.elapsedUs() / double(Iterations));
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  HWND window = d3d9test::createWindow("d3d9-stateblock");
+
+  Com<IDirect3DDevice9> device = d3d9test::createDevice(
+    window, D3DCREATE_HARDWARE_VERTEXPROCESSING, nullptr);
+
+  if (device == nullptr) {
+    std::fprintf(stderr, "Failed to create device\n");
+    return 77;
+  }
+
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  int status = bench
+    ? runBenchmark(device.ptr())
+    : runTest(device.ptr());
+
+  device = nullptr;
+  DestroyWindow(window);
+  return status;
+}
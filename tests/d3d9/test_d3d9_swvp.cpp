@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "test_d3d9_utils.h"
+
+/**
+ * \brief ProcessVertices CPU path test
+ *
+ * Runs the same vertex shader through ProcessVertices once with
+ * the CPU interpreter and once with the GPU emulation path, and
+ * compares the results. With \c --bench, measures the time taken
+ * by both paths for a range of batch sizes instead.
+ */
+
+const char* g_vsCode = R"(
+float4x4 mvp    : register(c0);
+float4   params : register(c4);
+
+struct VS_IN {
+  float4 pos : POSITION;
+  float4 nrm : NORMAL;
+};
+
+struct VS_OUT {
+  float4 pos : POSITION;
+  float4 t0  : TEXCOORD0;
+  float4 t1  : TEXCOORD1;
+};
+
+VS_OUT main(VS_IN i) {
+  VS_OUT o;
+  o.pos = mul(i.pos, mvp);
+  o.t0 = float4(normalize(i.nrm.xyz), rsqrt(abs(i.nrm.w) + 1.0f));
+  o.t1.xyz = cross(i.pos.xyz, i.nrm.xyz) * params.x + lerp(i.pos.xyz, i.nrm.xyz, params.y);
+  o.t1.w = exp2(params.z) + log2(abs(i.pos.x) + 1.0f) + max(i.pos.y, i.nrm.y) * i.nrm.w;
+  return o;
+})";
+
+struct InputVertex {
+  float pos[4];
+  float nrm[4];
+};
+
+struct OutputVertex {
+  float pos[4];
+  float t0[4];
+  float t1[4];
+};
+
+const D3DVERTEXELEMENT9 g_inputElements[] = {
+  { 0,  0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 },
+  { 0, 16, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_NORMAL,   0 },
+  D3DDECL_END()
+};
+
+const D3DVERTEXELEMENT9 g_outputElements[] = {
+  { 0,  0, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITIONT, 0 },
+  { 0, 16, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD,  0 },
+  { 0, 32, D3DDECLTYPE_FLOAT4, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD,  1 },
+  D3DDECL_END()
+};
+
+constexpr uint32_t MaxVertexCount = 4096;
+
+
+class SwvpRunner {
+
+public:
+
+  SwvpRunner(HWND window, bool cpu) {
+    // Force one path or the other for every batch size
+    m_device = d3d9test::createDevice(window, D3DCREATE_SOFTWARE_VERTEXPROCESSING, cpu
+      ? "d3d9.swvpCpuVertexLimit = 1000000"
+      : "d3d9.swvpCpuVertexLimit = 0");
+
+    if (m_device == nullptr)
+      return;
+
+    m_shader = d3d9test::compileVertexShader(m_device.ptr(), g_vsCode);
+
+    if (m_shader == nullptr
+     || FAILED(m_device->CreateVertexDeclaration(g_inputElements, &m_inputDecl))
+     || FAILED(m_device->CreateVertexDeclaration(g_outputElements, &m_outputDecl))
+     || FAILED(m_device->CreateVertexBuffer(MaxVertexCount * sizeof(InputVertex),
+          D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, &m_srcBuffer, nullptr))
+     || FAILED(m_device->CreateVertexBuffer(MaxVertexCount * sizeof(OutputVertex),
+          0, 0, D3DPOOL_SYSTEMMEM, &m_dstBuffer, nullptr))) {
+      m_device = nullptr;
+      return;
+    }
+
+    void* data = nullptr;
+    m_srcBuffer->Lock(0, 0, &data, 0);
+
+    auto vertices = reinterpret_cast<InputVertex*>(data);
+
+    // Deterministic input, including zeroes and
+    // values that stress normalization and rsq
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < MaxVertexCount; i++) {
+      for (uint32_t j = 0; j < 4; j++) {
+        seed = seed * 1103515245u + 12345u;
+        vertices[i].pos[j] = (i % 7 == j) ? 0.0f : float(int32_t(seed >> 16) % 2001 - 1000) / 100.0f;
+
+        seed = seed * 1103515245u + 12345u;
+        vertices[i].nrm[j] = (i % 5 == j) ? 0.0f : float(int32_t(seed >> 16) % 2001 - 1000) / 1000.0f;
+      }
+    }
+
+    m_srcBuffer->Unlock();
+
+    const float constants[5][4] = {
+      { 1.0f, 0.1f, 0.0f, 0.0f },
+      { 0.2f, 0.9f, 0.0f, 0.0f },
+      { 0.0f, 0.0f, 1.0f, 1.0f },
+      { 0.5f, 0.5f, 2.0f, 3.0f },
+      { 0.5f, 0.25f, 1.5f, 0.0f },
+    };
+
+    m_device->SetVertexShader(m_shader.ptr());
+    m_device->SetVertexShaderConstantF(0, &constants[0][0], 5);
+    m_device->SetVertexDeclaration(m_inputDecl.ptr());
+    m_device->SetStreamSource(0, m_srcBuffer.ptr(), 0, sizeof(InputVertex));
+  }
+
+  bool isValid() const {
+    return m_device != nullptr;
+  }
+
+  bool process(uint32_t vertexCount, std::vector<OutputVertex>* result) {
+    if (FAILED(m_device->ProcessVertices(0, 0, vertexCount,
+        m_dstBuffer.ptr(), m_outputDecl.ptr(), 0)))
+      return false;
+
+    // Locking waits for the GPU path to finish
+    void* data = nullptr;
+
+    if (FAILED(m_dstBuffer->Lock(0, vertexCount * sizeof(OutputVertex), &data, D3DLOCK_READONLY)))
+      return false;
+
+    if (result) {
+      auto vertices = reinterpret_cast<const OutputVertex*>(data);
+      result->assign(vertices, vertices + vertexCount);
+    }
+
+    m_dstBuffer->Unlock();
+    return true;
+  }
+
+private:
+
+  Com<IDirect3DDevice9>             m_device;
+  Com<IDirect3DVertexShader9>       m_shader;
+  Com<IDirect3DVertexDeclaration9>  m_inputDecl;
+  Com<IDirect3DVertexDeclaration9>  m_outputDecl;
+  Com<IDirect3DVertexBuffer9>       m_srcBuffer;
+  Com<IDirect3DVertexBuffer9>       m_dstBuffer;
+
+};
+
+
+bool compareFloat(float a, float b) {
+  if (std::isnan(a) || std::isnan(b))
+    return std::isnan(a) && std::isnan(b);
+
+  if (std::isinf(a) || std::isinf(b))
+    return a == b;
+
+  float scale = std::max(1.0f, std::max(std::abs(a), std::abs(b)));
+  return std::abs(a - b) <= 1.0e-4f * scale;
+}
+
+
+int runTest(SwvpRunner& cpu, SwvpRunner& gpu) {
+  std::vector<OutputVertex> cpuResult;
+  std::vector<OutputVertex> gpuResult;
+
+  if (!cpu.process(MaxVertexCount, &cpuResult)
+   || !gpu.process(MaxVertexCount, &gpuResult)) {
+    std::fprintf(stderr, "ProcessVertices failed\n");
+    return 1;
+  }
+
+  uint32_t mismatches = 0;
+
+  for (uint32_t i = 0; i < MaxVertexCount; i++) {
+    auto a = reinterpret_cast<const float*>(&cpuResult[i]);
+    auto b = reinterpret_cast<const float*>(&gpuResult[i]);
+
+    for (uint32_t j = 0; j < sizeof(OutputVertex) / sizeof(float); j++) {
+      if (!compareFloat(a[j], b[j]) && mismatches++ < 16) {
+        std::fprintf(stderr, "Vertex %u, component %u: CPU %g, GPU %g\n",
+          i, j, double(a[j]), double(b[j]));
+      }
+    }
+  }
+
+  std::printf("%u mismatches in %u vertices\n", mismatches, MaxVertexCount);
+  return mismatches ? 1 : 0;
+}
+
+
+int runBenchmark(SwvpRunner& cpu, SwvpRunner& gpu) {
+  std::printf("%8s %14s %14s\n", "Vertices", "CPU (us)", "GPU (us)");
+
+  for (uint32_t count = 4; count <= MaxVertexCount; count *= 4) {
+    uint32_t iterations = std::max(16u, 65536u / count);
+    double times[2] = { };
+
+    for (uint32_t i = 0; i < 2; i++) {
+      SwvpRunner& runner = i ? gpu : cpu;
+
+      // Warm up shader and pipeline caches
+      runner.process(count, nullptr);
+
+      d3d9test::Timer timer;
+
+      for (uint32_t j = 0; j < iterations; j++)
+        runner.process(count, nullptr);
+
+      times[i] = timer.elapsedUs() / double(iterations);
+    }
+
+    std::printf("%8u %14.2f %14.2f\n", count, times[0], times[1]);
+  }
+
+  return 0;
+}
+
+
+int main(int argc, char** argv) {
+  HWND window = d3d9test::createWindow("d3d9-swvp");
+
+  SwvpRunner cpu(window, true);
+  SwvpRunner gpu(window, false);
+
+  // Skip if the device or the GPU path are not supported
+  if (!cpu.isValid() || !gpu.isValid()) {
+    std::fprintf(stderr, "Failed to create devices\n");
+    return 77;
+  }
+
+  bool bench = argc > 1 && !std::strcmp(argv[1], "--bench");
+
+  int status = bench
+    ? runBenchmark(cpu, gpu)
+    : runTest(cpu, gpu);
+
+  DestroyWindow(window);
+  return status;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <d3d9.h>
+#include <d3dcompiler.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "../../src/util/com/com_pointer.h"
+
+using namespace dxvk;
+
+/**
+ * \brief D3D9 test helpers
+ *
+ * Creates a hidden window and a device on it. The DXVK
+ * configuration can be overridden per device, since the
+ * config is read whenever a new D3D9 object is created.
+ */
+namespace d3d9test {
+
+  inline HWND createWindow(const char* name) {
+    WNDCLASSEXA wc = { };
+    wc.cbSize         = sizeof(wc);
+    wc.lpfnWndProc    = DefWindowProcA;
+    wc.hInstance      = GetModuleHandleA(nullptr);
+    wc.lpszClassName  = name;
+    RegisterClassExA(&wc);
+
+    return CreateWindowExA(0, name, name, WS_OVERLAPPEDWINDOW,
+      0, 0, 256, 256, nullptr, nullptr, wc.hInstance, nullptr);
+  }
+
+
+  inline Com<IDirect3DDevice9> createDevice(
+          HWND                  window,
+          DWORD                 flags,
+    const char*                 config) {
+    SetEnvironmentVariableA("DXVK_CONFIG", config);
+
+    Com<IDirect3D9> d3d;
+    *(&d3d) = Direct3DCreate9(D3D_SDK_VERSION);
+
+    if (d3d == nullptr)
+      return nullptr;
+
+    D3DPRESENT_PARAMETERS pp = { };
+    pp.BackBufferWidth  = 256;
+    pp.BackBufferHeight = 256;
+    pp.BackBufferFormat = D3DFMT_X8R8G8B8;
+    pp.BackBufferCount  = 1;
+    pp.SwapEffect       = D3DSWAPEFFECT_DISCARD;
+    pp.hDeviceWindow    = window;
+    pp.Windowed         = TRUE;
+
+    Com<IDirect3DDevice9> device;
+
+    if (FAILED(d3d->CreateDevice(D3DADAPTER_DEFAULT, D3DDEVTYPE_HAL,
+        window, flags, &pp, &device)))
+      return nullptr;
+
+    return device;
+  }
+
+
+  inline Com<IDirect3DVertexShader9> compileVertexShader(
+          IDirect3DDevice9*     device,
+    const char*                 code) {
+    Com<ID3DBlob> binary;
+    Com<ID3DBlob> errors;
+
+    if (FAILED(D3DCompile(code, std::strlen(code), "vs", nullptr, nullptr,
+        "main", "vs_3_0", 0, 0, &binary, &errors))) {
+      if (errors != nullptr)
+        std::fprintf(stderr, "%s\n", reinterpret_cast<const char*>(errors->GetBufferPointer()));
+      return nullptr;
+    }
+
+    Com<IDirect3DVertexShader9> shader;
+
+    if (FAILED(device->CreateVertexShader(
+        reinterpret_cast<const DWORD*>(binary->GetBufferPointer()), &shader)))
+      return nullptr;
+
+    return shader;
+  }
+
+
+  /**
+   * \brief Simple wall clock timer
+   */
+  class Timer {
+
+  public:
+
+    Timer()
+    : m_start(std::chrono::high_resolution_clock::now()) { }
+
+    double elapsedUs() const {
+      return std::chrono::duration<double, std::micro>(
+        std::chrono::high_resolution_clock::now() - m_start).count();
+    }
+
+  private:
+
+    std::chrono::high_resolution_clock::time_point m_start;
+
+  };
+
+}
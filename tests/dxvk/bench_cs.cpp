@@ -0,0 +1,161 @@
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+
+#include "../../src/dxvk/dxvk_cs.h"
+
+#include "../../src/util/util_time.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("bench_cs.log");
+}
+
+using namespace dxvk;
+
+/**
+ * \brief CS chunk benchmark
+ *
+ * Records commands with different payloads into CS chunks and
+ * executes them without a context, and reports the time spent
+ * per command for recording and for execution. This measures
+ * the overhead of the command stream itself, not the cost of
+ * the context operations that the commands would normally do.
+ *
+ * Usage: bench-cs [commands per run]
+ */
+
+class DummyObject : public RcObject { };
+
+volatile uint32_t g_sink = 0;
+
+
+/**
+ * \brief Small trivially destructible command
+ *
+ * Similar to state changes that only carry a few values.
+ */
+auto makeSmallCommand(uint32_t i) {
+  return [cValue = i] (DxvkContext*) {
+    g_sink = g_sink + cValue;
+  };
+}
+
+
+/**
+ * \brief Large trivially destructible command
+ *
+ * Similar to commands that carry a state object,
+ * e.g. blend or rasterizer state.
+ */
+auto makeLargeCommand(uint32_t i) {
+  std::array<uint32_t, 32> values;
+  values.fill(i);
+
+  return [cValues = values] (DxvkContext*) {
+    g_sink = g_sink + cValues[0] + cValues[31];
+  };
+}
+
+
+/**
+ * \brief Command that holds a reference
+ *
+ * Similar to resource binding commands, which need
+ * to be destroyed in order to release the reference.
+ */
+auto makeRefCommand(const Rc<DummyObject>& object) {
+  return [cObject = object] (DxvkContext*) {
+    g_sink = g_sink + uint32_t(cObject != nullptr);
+  };
+}
+
+
+struct BenchResult {
+  double recordNs;
+  double executeNs;
+};
+
+
+template<typename Fn>
+BenchResult runBenchmark(DxvkCsChunkPool& pool, DxvkCsChunkFlags flags, uint32_t count, const Fn& makeCommand) {
+  using clock = dxvk::high_resolution_clock;
+
+  std::vector<DxvkCsChunkRef> chunks;
+
+  // Record all commands first so that execution
+  // does not interleave with recording
+  auto t0 = clock::now();
+
+  DxvkCsChunkRef chunk(pool.allocChunk(flags), &pool);
+
+  for (uint32_t i = 0; i < count; i++) {
+    auto command = makeCommand(i);
+
+    if (!chunk->push(command)) {
+      chunks.push_back(std::move(chunk));
+      chunk = DxvkCsChunkRef(pool.allocChunk(flags), &pool);
+      chunk->push(command);
+    }
+  }
+
+  chunks.push_back(std::move(chunk));
+
+  auto t1 = clock::now();
+
+  for (const auto& c : chunks)
+    c->executeAll(nullptr);
+
+  auto t2 = clock::now();
+
+  // Return chunks to the pool, which resets them. This
+  // is where non-single-use chunks destroy commands.
+  chunks.clear();
+
+  auto t3 = clock::now();
+
+  BenchResult result;
+  result.recordNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count()) / double(count);
+  result.executeNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>((t2 - t1) + (t3 - t2)).count()) / double(count);
+  return result;
+}
+
+
+template<typename Fn>
+void runCase(DxvkCsChunkPool& pool, const char* name, uint32_t count, const Fn& makeCommand) {
+  constexpr uint32_t Iterations = 8;
+
+  for (uint32_t singleUse = 0; singleUse < 2; singleUse++) {
+    DxvkCsChunkFlags flags = singleUse
+      ? DxvkCsChunkFlags(DxvkCsChunkFlag::SingleUse)
+      : DxvkCsChunkFlags();
+
+    BenchResult total = { };
+
+    // Warm up the chunk pool before measuring
+    runBenchmark(pool, flags, count, makeCommand);
+
+    for (uint32_t i = 0; i < Iterations; i++) {
+      BenchResult result = runBenchmark(pool, flags, count, makeCommand);
+      total.recordNs += result.recordNs;
+      total.executeNs += result.executeNs;
+    }
+
+    std::printf("%-8s %-10s %12.2f %12.2f\n", name, singleUse ? "single-use" : "reusable",
+      total.recordNs / double(Iterations), total.executeNs / double(Iterations));
+  }
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t count = argc > 1 ? uint32_t(std::atoi(argv[1])) : 1000000u;
+
+  DxvkCsChunkPool pool;
+  Rc<DummyObject> object = new DummyObject();
+
+  std::printf("%-8s %-10s %12s %12s\n", "Command", "Mode", "Record (ns)", "Execute (ns)");
+
+  runCase(pool, "small", count, [] (uint32_t i) { return makeSmallCommand(i); });
+  runCase(pool, "large", count, [] (uint32_t i) { return makeLargeCommand(i); });
+  runCase(pool, "ref",   count, [&object] (uint32_t) { return makeRefCommand(object); });
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../../src/util/log/log.h"
+#include "../../src/util/util_env.h"
+#include "../../src/util/util_sleep.h"
+#include "../../src/util/util_string.h"
+#include "../../src/util/util_time.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("bench_log.log");
+}
+
+using namespace dxvk;
+
+/**
+ * \brief Logging benchmark
+ *
+ * Logs messages from multiple threads at the same time and reports
+ * the time spent inside the logging call, which is what matters for
+ * the threads that emit messages. Run once with DXVK_LOG_ASYNC=0 and
+ * once with DXVK_LOG_ASYNC=1 to compare both modes. Output should be
+ * redirected, e.g. with DXVK_LOG_PATH=none and 2>/dev/null.
+ *
+ * In async mode, messages are dropped if the log thread cannot keep
+ * up, so the number of dropped messages is reported as well. If a
+ * message rate is given, each thread paces its messages to that rate
+ * in order to measure a load that the log thread can sustain.
+ *
+ * Usage: bench-log [threads] [messages per thread] [messages per second per thread]
+ */
+int main(int argc, char** argv) {
+  uint32_t threadCount  = argc > 1 ? uint32_t(std::atoi(argv[1])) : 8u;
+  uint32_t messageCount = argc > 2 ? uint32_t(std::atoi(argv[2])) : 100000u;
+  uint32_t messageRate  = argc > 3 ? uint32_t(std::atoi(argv[3])) : 0u;
+
+  using clock = dxvk::high_resolution_clock;
+
+  std::vector<std::vector<uint64_t>> timings(threadCount);
+  std::vector<dxvk::thread> threads;
+
+  auto t0 = clock::now();
+
+  for (uint32_t i = 0; i < threadCount; i++) {
+    threads.emplace_back([i, messageCount, messageRate, t0, &timings] {
+      auto& results = timings[i];
+      results.reserve(messageCount);
+
+      for (uint32_t j = 0; j < messageCount; j++) {
+        // Pace against absolute times so that sleep
+        // inaccuracies do not lower the overall rate
+        if (messageRate) {
+          auto target = t0 + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<double>(double(j) / double(messageRate)));
+          auto now = clock::now();
+
+          if (now < target)
+            Sleep::sleepUntil(now, target);
+        }
+
+        std::string message = str::format("Thread ", i, ": Message ", j);
+
+        auto t = clock::now();
+        Logger::info(message);
+
+        results.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+          clock::now() - t).count());
+      }
+    });
+  }
+
+  for (auto& thread : threads)
+    thread.join();
+
+  auto t1 = clock::now();
+
+  std::vector<uint64_t> all;
+
+  for (const auto& results : timings)
+    all.insert(all.end(), results.begin(), results.end());
+
+  std::sort(all.begin(), all.end());
+
+  auto percentile = [&all] (uint32_t p) {
+    return all.empty() ? 0u : all[(all.size() - 1) * p / 100];
+  };
+
+  std::cout << "Mode:     " << (env::getEnvVar("DXVK_LOG_ASYNC") == "1" ? "async" : "sync") << std::endl
+            << "Threads:  " << threadCount << std::endl
+            << "Rate:     " << (messageRate ? std::to_string(messageRate) + " msg/s per thread" : "unlimited") << std::endl
+            << "Messages: " << all.size() << std::endl
+            << "Dropped:  " << Logger::dropCount() << std::endl
+            << "Total:    " << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << " ms" << std::endl
+            << "P50:      " << percentile(50) << " ns" << std::endl
+            << "P99:      " << percentile(99) << " ns" << std::endl
+            << "Max:      " << percentile(100) << " ns" << std::endl;
+  return 0;
+}
@@ -0,0 +1,152 @@
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/util/log/log.h"
+#include "../../src/util/util_fps_limiter.h"
+#include "../../src/util/util_time.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("bench_fps_limiter.log");
+}
+
+using namespace dxvk;
+
+/**
+ * \brief Frame pacing harness
+ *
+ * Runs the frame rate limiter against synthetic workloads that
+ * busy-wait for a given fraction of the target frame time, and
+ * reports the pacing error histogram, the share of frames that
+ * were already late, and the mean and standard deviation of the
+ * resulting frame times.
+ *
+ * Usage: bench-fps-limiter [frame rate] [frames per workload]
+ */
+
+using Clock = dxvk::high_resolution_clock;
+
+struct Workload {
+  const char* name;
+  double      minLoad;
+  double      maxLoad;
+  uint32_t    spikeInterval;
+  double      spikeLoad;
+};
+
+
+void busyWait(Clock::duration duration) {
+  auto end = Clock::now() + duration;
+
+  while (Clock::now() < end)
+    continue;
+}
+
+
+void runWorkload(const Workload& workload, double frameRate, uint32_t frameCount) {
+  FpsLimiter limiter;
+  limiter.setTargetFrameRate(frameRate);
+
+  if (!limiter.isEnabled()) {
+    std::printf("Frame rate limiter disabled, is DXVK_FRAME_RATE set?\n");
+    return;
+  }
+
+  auto interval = std::chrono::duration_cast<Clock::duration>(
+    std::chrono::duration<double>(1.0 / frameRate));
+
+  std::mt19937 random(1);
+  std::uniform_real_distribution<double> distribution(workload.minLoad, workload.maxLoad);
+
+  std::array<uint32_t, FpsLimiter::ErrorBinCount> bins = { };
+  uint32_t lateCount = 0;
+  double lateUs = 0.0;
+
+  std::vector<double> frameTimes;
+  frameTimes.reserve(frameCount);
+
+  // Let the limiter settle on its cadence first
+  limiter.delay(false);
+
+  auto last = Clock::now();
+
+  for (uint32_t i = 0; i < frameCount; i++) {
+    double load = workload.spikeInterval && !((i + 1) % workload.spikeInterval)
+      ? workload.spikeLoad
+      : distribution(random);
+
+    busyWait(std::chrono::duration_cast<Clock::duration>(interval * load));
+
+    auto result = limiter.delay(false);
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(result.error).count();
+
+    if (result.late) {
+      lateCount += 1;
+      lateUs += double(us);
+    } else {
+      bins[FpsLimiter::getErrorBin(result.error)] += 1;
+    }
+
+    auto now = Clock::now();
+    frameTimes.push_back(std::chrono::duration<double, std::micro>(now - last).count());
+    last = now;
+  }
+
+  double mean = 0.0;
+
+  for (double t : frameTimes)
+    mean += t;
+
+  mean /= double(frameCount);
+
+  double variance = 0.0;
+
+  for (double t : frameTimes)
+    variance += (t - mean) * (t - mean);
+
+  double stddev = std::sqrt(variance / double(frameCount));
+
+  std::printf("%-10s", workload.name);
+
+  for (uint32_t bin : bins)
+    std::printf(" %6.1f", 100.0 * double(bin) / double(frameCount));
+
+  std::printf(" %6.1f %9.1f %10.1f %9.1f\n",
+    100.0 * double(lateCount) / double(frameCount),
+    lateCount ? lateUs / double(lateCount) : 0.0,
+    mean, stddev);
+}
+
+
+int main(int argc, char** argv) {
+  double frameRate = argc > 1 ? std::atof(argv[1]) : 144.0;
+  uint32_t frameCount = argc > 2 ? uint32_t(std::atoi(argv[2])) : 600u;
+
+  const Workload workloads[] = {
+    { "idle",       0.00, 0.00,  0, 0.0 },
+    { "steady",     0.50, 0.50,  0, 0.0 },
+    { "jitter",     0.30, 0.95,  0, 0.0 },
+    { "spikes",     0.40, 0.60, 10, 1.5 },
+    { "borderline", 0.90, 1.05,  0, 0.0 },
+    { "overload",   1.10, 1.20,  0, 0.0 },
+  };
+
+  std::printf("Target: %.1f fps, %.1f us per frame\n", frameRate, 1000000.0 / frameRate);
+  std::printf("%-10s", "Workload");
+
+  for (uint32_t limit : FpsLimiter::ErrorBinLimits)
+    std::printf(" %6s", ("<" + std::to_string(limit)).c_str());
+
+  std::printf(" %6s %6s %9s %10s %9s\n",
+    (">=" + std::to_string(FpsLimiter::ErrorBinLimits.back())).c_str(),
+    "late", "late (us)", "mean (us)", "sd (us)");
+
+  for (const auto& workload : workloads)
+    runWorkload(workload, frameRate, frameCount);
+
+  return 0;
+}